@@ -25,6 +25,10 @@
  *
  *  pi@raspberrypi $ sudo ./SkyView
  *
+ *  Aircraft database lookup rate:
+ *
+ *  pi@raspberrypi $ sudo ./SkyView -B
+ *
  */
 
 #if defined(RASPBERRY_PI)
@@ -262,6 +266,227 @@ static int RPi_WiFi_clients_count()
   return 0;
 }
 
+/*
+ * Aircraft ID lookups: one prepared statement per database and ID preference,
+ * made once in RPi_DB_init(), with the recent results - found or not - kept
+ * in a small LRU cache so that a display refresh does not go to the SD card.
+ */
+#define DB_CACHE_SIZE     256
+#define DB_CACHE_BUCKETS  128       /* power of 2 */
+#define DB_CACHE_TEXT     32
+#define DB_CACHE_NONE     0xFFFF
+
+#define DB_PRELOAD_FILE   "Aircrafts/local.txt" /* optional: <db> <hex id> per line */
+
+typedef struct db_cache_struct {
+  uint32_t id;
+  uint8_t  type;
+  int8_t   rval;                    /* what the query returned */
+  uint16_t hnext;                   /* hash chain */
+  uint16_t prev, next;              /* LRU list, head is the most recent */
+  char     text[DB_CACHE_TEXT];
+} db_cache_t;
+
+static sqlite3_stmt *DB_stmt[DB_ICAO + 1][ID_MAM + 1];
+
+static db_cache_t DB_cache[DB_CACHE_SIZE];
+static uint16_t   DB_bucket[DB_CACHE_BUCKETS];
+static uint16_t   DB_lru_head, DB_lru_tail;
+static uint16_t   DB_cache_cnt;
+static uint8_t    DB_cache_idpref;
+static bool       DB_cache_off = false;   /* for the benchmark */
+
+static const char *RPi_DB_column(uint8_t type, uint8_t idpref)
+{
+  switch (type)
+  {
+  case DB_OGN:
+    return idpref == ID_TAIL ? "accn" : idpref == ID_MAM ? "acmodel" : "acreg";
+  case DB_ICAO:
+    return idpref == ID_TAIL ? "owner" : idpref == ID_MAM ? "type" : "registration";
+  case DB_FLN:
+  default:
+    return idpref == ID_TAIL ? "tail" : idpref == ID_MAM ? "type" : "registration";
+  }
+}
+
+static void RPi_DB_prepare(uint8_t type, sqlite3 *db, const char *table)
+{
+  char query[64];
+
+  for (int pref = ID_REG; pref <= ID_MAM; pref++) {
+    snprintf(query, sizeof(query), "select %s from %s where id = ?",
+             RPi_DB_column(type, pref), table);
+    if (sqlite3_prepare_v2(db, query, -1, &DB_stmt[type][pref], NULL) != SQLITE_OK) {
+      printf("Unable to prepare \"%s\": %s\n", query, sqlite3_errmsg(db));
+      DB_stmt[type][pref] = NULL;
+    }
+  }
+}
+
+static void RPi_DB_cache_clear()
+{
+  memset(DB_bucket, 0xFF, sizeof(DB_bucket));
+  DB_lru_head = DB_lru_tail = DB_CACHE_NONE;
+  DB_cache_cnt = 0;
+  DB_cache_idpref = settings->idpref;
+}
+
+static inline uint16_t RPi_DB_hash(uint8_t type, uint32_t id)
+{
+  return ((id ^ (id >> 11) ^ ((uint32_t) type << 5)) * 2654435761U) >> 25 & (DB_CACHE_BUCKETS - 1);
+}
+
+static void RPi_DB_lru_unlink(uint16_t i)
+{
+  db_cache_t *e = &DB_cache[i];
+
+  if (e->prev != DB_CACHE_NONE) DB_cache[e->prev].next = e->next; else DB_lru_head = e->next;
+  if (e->next != DB_CACHE_NONE) DB_cache[e->next].prev = e->prev; else DB_lru_tail = e->prev;
+}
+
+static void RPi_DB_lru_push(uint16_t i)
+{
+  db_cache_t *e = &DB_cache[i];
+
+  e->prev = DB_CACHE_NONE;
+  e->next = DB_lru_head;
+  if (DB_lru_head != DB_CACHE_NONE) DB_cache[DB_lru_head].prev = i; else DB_lru_tail = i;
+  DB_lru_head = i;
+}
+
+static db_cache_t *RPi_DB_cache_find(uint8_t type, uint32_t id)
+{
+  for (uint16_t i = DB_bucket[RPi_DB_hash(type, id)]; i != DB_CACHE_NONE; i = DB_cache[i].hnext) {
+    if (DB_cache[i].id == id && DB_cache[i].type == type) {
+      if (i != DB_lru_head) {
+        RPi_DB_lru_unlink(i);
+        RPi_DB_lru_push(i);
+      }
+      return &DB_cache[i];
+    }
+  }
+  return NULL;
+}
+
+static void RPi_DB_cache_add(uint8_t type, uint32_t id, int rval, const char *text)
+{
+  uint16_t i;
+
+  if (DB_cache_cnt < DB_CACHE_SIZE) {
+    i = DB_cache_cnt++;
+  } else {
+    /* evict the least recently used, off its hash chain first */
+    i = DB_lru_tail;
+    RPi_DB_lru_unlink(i);
+    uint16_t *p = &DB_bucket[RPi_DB_hash(DB_cache[i].type, DB_cache[i].id)];
+    while (*p != i)
+      p = &DB_cache[*p].hnext;
+    *p = DB_cache[i].hnext;
+  }
+
+  db_cache_t *e = &DB_cache[i];
+  e->id   = id;
+  e->type = type;
+  e->rval = rval;
+  strncpy(e->text, text, sizeof(e->text) - 1);
+  e->text[sizeof(e->text) - 1] = '\0';
+
+  uint16_t h = RPi_DB_hash(type, id);
+  e->hnext = DB_bucket[h];
+  DB_bucket[h] = i;
+  RPi_DB_lru_push(i);
+}
+
+/* look an ID up in the database, returns 1 with the text, 0 if not there */
+static int RPi_DB_lookup(uint8_t type, uint32_t id, char *text, size_t size)
+{
+  sqlite3_stmt *stmt = DB_stmt[type][settings->idpref <= ID_MAM ? settings->idpref : ID_REG];
+  int rval = 0;
+
+  text[0] = '\0';
+  if (stmt == NULL)
+    return 0;
+
+  sqlite3_bind_int(stmt, 1, id);
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    if (sqlite3_column_type(stmt, 0) == SQLITE3_TEXT) {
+      const char *s = (const char *) sqlite3_column_text(stmt, 0);
+      if (s[0] != '\0') {
+        strncpy(text, s, size - 1);
+        text[size - 1] = '\0';
+        rval = 1;
+      }
+    }
+  }
+  sqlite3_reset(stmt);
+
+  return rval;
+}
+
+static int RPi_DB_query(uint8_t type, uint32_t id, char *buf, size_t size,
+                            char *buf2=NULL, size_t size2=0)
+{
+  char text[DB_CACHE_TEXT];
+  int rval;
+
+  if (buf2)  buf2[0] = '\0';
+
+  if (type > DB_ICAO)
+    type = DB_FLN;
+
+  if (fln_db == NULL || ogn_db == NULL || icao_db == NULL) {
+    return -1;
+  }
+
+  if (DB_cache_idpref != settings->idpref)
+    RPi_DB_cache_clear();
+
+  db_cache_t *e = DB_cache_off ? NULL : RPi_DB_cache_find(type, id);
+  if (e != NULL) {
+    rval = e->rval;
+    strcpy(text, e->text);
+  } else {
+    rval = RPi_DB_lookup(type, id, text, sizeof(text));
+    if (!DB_cache_off)
+      RPi_DB_cache_add(type, id, rval, text);
+  }
+
+  if (rval == 1 && size > 0) {
+    strncpy(buf, text, size - 1);
+    buf[size - 1] = '\0';
+  }
+
+  return rval;
+}
+
+/* warm the cache with the IDs that are usually around here */
+static void RPi_DB_preload()
+{
+  FILE *f = fopen(DB_PRELOAD_FILE, "r");
+  char line[64], db[8], text[DB_CACHE_TEXT];
+  unsigned int id;
+  int cnt = 0;
+
+  if (f == NULL)
+    return;
+
+  while (fgets(line, sizeof(line), f) != NULL && cnt < DB_CACHE_SIZE) {
+    uint8_t type;
+    if (sscanf(line, "%7s %x", db, &id) != 2)
+      continue;
+    if      (!strcasecmp(db, "ogn"))  type = DB_OGN;
+    else if (!strcasecmp(db, "icao")) type = DB_ICAO;
+    else if (!strcasecmp(db, "fln"))  type = DB_FLN;
+    else continue;
+    RPi_DB_query(type, id, text, sizeof(text));
+    cnt++;
+  }
+  fclose(f);
+
+  printf("%d aircraft IDs preloaded from " DB_PRELOAD_FILE "\n", cnt);
+}
+
 static bool RPi_DB_init()
 {
   sqlite3_open("Aircrafts/fln.db", &fln_db);
@@ -291,115 +516,25 @@ static bool RPi_DB_init()
     return false;
   }
 
+  RPi_DB_prepare(DB_FLN,  fln_db,  "aircrafts");
+  RPi_DB_prepare(DB_OGN,  ogn_db,  "devices");
+  RPi_DB_prepare(DB_ICAO, icao_db, "aircrafts");
+
+  RPi_DB_cache_clear();
+  RPi_DB_preload();
+
   return true;
 }
 
-static int RPi_DB_query(uint8_t type, uint32_t id, char *buf, size_t size,
-                            char *buf2=NULL, size_t size2=0)
+static void RPi_DB_fini()
 {
-  sqlite3_stmt *stmt;
-  char *query = NULL;
-  int error;
-  int rval = 0;
-  const char *reg_key, *db_key;
-  sqlite3 *db;
-
-  if (buf2)  buf2[0] = '\0';
-
-  switch (type)
-  {
-  case DB_OGN:
-    switch (settings->idpref)
-    {
-    case ID_TAIL:
-      reg_key = "accn";
-      break;
-    case ID_MAM:
-      reg_key = "acmodel";
-      break;
-    case ID_REG:
-    default:
-      reg_key = "acreg";
-      break;
-    }
-    db_key  = "devices";
-    db      = ogn_db;
-    break;
-  case DB_ICAO:
-    switch (settings->idpref)
-    {
-    case ID_TAIL:
-      reg_key = "owner";
-      break;
-    case ID_MAM:
-      reg_key = "type";
-      break;
-    case ID_REG:
-    default:
-      reg_key = "registration";
-      break;
-    }
-    db_key  = "aircrafts";
-    db      = icao_db;
-    break;
-  case DB_FLN:
-  default:
-    switch (settings->idpref)
-    {
-    case ID_TAIL:
-      reg_key = "tail";
-      break;
-    case ID_MAM:
-      reg_key = "type";
-      break;
-    case ID_REG:
-    default:
-      reg_key = "registration";
-      break;
-    }
-    db_key  = "aircrafts";
-    db      = fln_db;
-    break;
-  }
-
-  if (db == NULL) {
-    return -1;
-  }
-
-  error = asprintf(&query, "select %s from %s where id = %d",reg_key, db_key, id);
-
-  if (error == -1) {
-    return 0;
-  }
-
-  sqlite3_prepare_v2(db, query, strlen(query), &stmt, NULL);
-
-  while (sqlite3_step(stmt) != SQLITE_DONE) {
-    if (sqlite3_column_type(stmt, 0) == SQLITE3_TEXT) {
-
-      size_t len = strlen((char *) sqlite3_column_text(stmt, 0));
-
-      if (len > 0) {
-        len = len > size ? size : len;
-        strncpy(buf, (char *) sqlite3_column_text(stmt, 0), len);
-        if (len < size) {
-          buf[len] = 0;
-        } else if (len == size) {
-          buf[len-1] = 0;
-        }
-        rval = 1;
-      }
+  for (int type = 0; type <= DB_ICAO; type++) {
+    for (int pref = 0; pref <= ID_MAM; pref++) {
+      sqlite3_finalize(DB_stmt[type][pref]);
+      DB_stmt[type][pref] = NULL;
     }
   }
 
-  sqlite3_finalize(stmt);
-  free(query);
-
-  return rval;
-}
-
-static void RPi_DB_fini()
-{
   if (fln_db != NULL) {
     sqlite3_close(fln_db);
   }
@@ -413,6 +548,45 @@ static void RPi_DB_fini()
   }
 }
 
+/* lookups per second, straight from sqlite and from the cache */
+static void RPi_DB_bench()
+{
+  static const char *name[] = { "FLN", "OGN", "ICAO" };
+  sqlite3 *db[] = { fln_db, ogn_db, icao_db };
+  const char *table[] = { "aircrafts", "devices", "aircrafts" };
+  uint32_t ids[64];
+  char text[DB_CACHE_TEXT];
+
+  for (int type = DB_FLN; type <= DB_ICAO; type++) {
+    sqlite3_stmt *stmt;
+    char query[64];
+    int n = 0;
+
+    snprintf(query, sizeof(query), "select id from %s limit 64", table[type]);
+    if (sqlite3_prepare_v2(db[type], query, -1, &stmt, NULL) != SQLITE_OK)
+      continue;
+    while (n < 64 && sqlite3_step(stmt) == SQLITE_ROW)
+      ids[n++] = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    if (n == 0)
+      continue;
+
+    for (int cached = 0; cached <= 1; cached++) {
+      const int rounds = cached ? 100000 : 10000;
+      DB_cache_off = !cached;
+      RPi_DB_cache_clear();
+      unsigned long start = micros();
+      for (int i = 0; i < rounds; i++)
+        RPi_DB_query(type, ids[i % n], text, sizeof(text));
+      unsigned long us = micros() - start;
+      printf("%-4s %-8s %10.0f lookups/s\n", name[type], cached ? "cached" : "sqlite",
+             us ? rounds * 1e6 / us : 0.0);
+    }
+  }
+  DB_cache_off = false;
+  RPi_DB_cache_clear();
+}
+
 static void play_file(snd_pcm_t *pcm_handle, char *filename, short int* buf, snd_pcm_uframes_t frames)
 {
     int pcmrc;
@@ -715,11 +889,13 @@ void Input_loop() {
 int main(int argc, char *argv[])
 {
   bool isSysVinit = false;
+  bool DB_bench = false;
   int opt;
 
-  while ((opt = getopt(argc, argv, "b")) != -1) {
+  while ((opt = getopt(argc, argv, "bB")) != -1) {
       switch (opt) {
       case 'b': isSysVinit = true; break;
+      case 'B': DB_bench = true; break;
       default: break;
       }
   }
@@ -795,6 +971,12 @@ int main(int argc, char *argv[])
       exit(EXIT_FAILURE);
   }
 
+  if (DB_bench) {
+      RPi_DB_bench();
+      SoC->DB_fini();
+      exit(EXIT_SUCCESS);
+  }
+
   char sentence[] = "POST";
   SoC->TTS(sentence);
 
@@ -123,43 +123,38 @@
 
 typedef struct UFO {
 
-#if defined(RASPBERRY_PI) || defined(ARDUINO_ARCH_NRF52)
-    uint8_t   raw[34];
-#endif
-
+    /* read or written for every packet and by Traffic_loop() */
+    uint32_t  addr;
     uint8_t   protocol;
     uint8_t   addr_type;
     int8_t    alarm_level;
-    int8_t    alert_level;
+    uint8_t   airborne;
 
     time_t    timestamp;      // seconds (unix epoch)
-    time_t    timerelayed;
-    uint32_t  addr;
+    uint32_t  gnsstime_ms;    /* hopefully a more precise timestamp */
+    uint32_t  projtime_ms;    /* timestamp of last course projection */
     float     latitude;      // signed decimal-degrees
     float     longitude;
     float     altitude;      // meters
-    float     geoid_separation; /* meters */
-    float     pressure_altitude;
-    float     baro_alt_diff;    // only from ADS-B <<< check units & sign
     float     course;     /* CoG */   // degrees
     float     heading;    /* where the nose points = course - wind drift */
     float     speed;      /* ground speed in knots */
     float     vs;         /* feet per minute vertical speed */
-
-    /* to be able to compute turn & climb rates */
-    uint32_t  gnsstime_ms;    /* hopefully a more precise timestamp */
-    uint32_t  prevtime_ms;    /* preceding timestamp */
-    uint32_t  projtime_ms;    /* timestamp of last course projection */
-    float     prevcourse;     /* previous course */
-    float     prevheading;    /* previous heading */
-/*  float     prevspeed;  */  /* previous speed */
-    float     prevaltitude;   /* previous altitude */
     float     distance;       // meters
     float     bearing;
-    float     turnrate;       // ground reference
     float     alt_diff;
     float     adj_alt_diff;
     float     adj_distance;
+    int32_t   dx;        // EW distance to this other aircraft, in quarter-meters
+    int32_t   dy;        // NS distance
+    int16_t   RelativeBearing;    // for voice and strobe
+    int8_t    circling;   // 1=right, -1=left
+    int8_t    rssi; /* SX1276 only */
+    bool      stealth;
+    bool      no_track;
+    bool      relayed;    // has already been relayed one hop
+    uint8_t   aircraft_type;
+    time_t    timerelayed;
 
     // projections in air reference frame for "Legacy" collision prediction
     int16_t   air_ns[6];
@@ -168,30 +163,49 @@ typedef struct UFO {
     /* 'legacy' specific data */
     int16_t   fla_ns[4];     // quarter-meters per second
     int16_t   fla_ew[4];
-    int32_t   dx;        // EW distance to this other aircraft, in meters
-    int32_t   dy;        // NS distance
 //  uint8_t   msg_type;  // 2 = new 2024 protocol
-    bool      stealth;
-    bool      no_track;
-    bool      relayed;    // has already been relayed one hop
-    uint8_t   aircraft_type;
-    uint8_t   airborne;
-    int8_t    circling;   // 1=right, -1=left
-
-    uint8_t   next;       // for linking into a list
-    uint8_t   alert;      /* bitmap of issued voice/tone/ble/... alerts */
-
-    int16_t   RelativeBearing;    // for voice and strobe
 
+    /* identity and source details, rarely read */
+    float     geoid_separation; /* meters */
+    float     pressure_altitude;
+    float     baro_alt_diff;    // only from ADS-B <<< check units & sign
     uint16_t  hdop; /* cm */
     uint16_t  last_crc;
-    int8_t    rssi; /* SX1276 only */
+    uint8_t   next;       // for linking into a list
 
     /* ADS-B (ES, UAT, GDL90) specific data */
     uint8_t   callsign[10];    /* size of mdb.callsign + 1 */
 
+#if defined(RASPBERRY_PI) || defined(ARDUINO_ARCH_NRF52)
+    uint8_t   raw[34];
+#endif
+
+    /* history, kept by AddTraffic() when a new packet replaces the rest */
+    uint32_t  prevtime_ms;    /* preceding timestamp */
+    float     prevcourse;     /* previous course */
+    float     prevheading;    /* previous heading */
+/*  float     prevspeed;  */  /* previous speed */
+    float     prevaltitude;   /* previous altitude */
+    float     turnrate;       // ground reference
+
+    /* dead reckoning between packets, see track_advance() */
+    uint32_t  track_ms;       /* time the position above refers to, 0 = none */
+    float     fix_lat;        /* last received position, at gnsstime_ms */
+    float     fix_lon;
+    float     fix_alt;
+    float     fix_course;     /* course and heading of that fix, not dead-reckoned */
+    float     fix_heading;
+    float     bias_ns;        /* filtered velocity correction, m/s */
+    float     bias_ew;
+
+    uint8_t   alert;      /* bitmap of issued voice/tone/ble/... alerts */
+    int8_t    alert_level;
+
 } ufo_t;
 
+/* the leading part of ufo_t that a packet from a tracked aircraft replaces */
+#define UFO_PACKET_SIZE   offsetof(ufo_t, prevtime_ms)
+
 typedef struct hardware_info {
     byte  model;
     byte  revision;
@@ -215,6 +229,7 @@ typedef struct IODev_ops_struct {
   int (*available)(void);
   int (*read)(void);
   size_t (*write)(const uint8_t *buffer, size_t size);
+  size_t (*room)(void);   /* bytes write() takes in one piece now, NULL = no limit */
 } IODev_ops_t;
 
 typedef struct DB_ops_struct {
@@ -73,6 +73,7 @@
 
 #include "src/system/OTA.h"
 #include "src/system/Time.h"
+#include "src/system/Profile.h"
 #include "src/driver/LED.h"
 #include "src/driver/GNSS.h"
 #include "src/driver/RF.h"
@@ -424,7 +425,7 @@ void normal()
   AHRS_loop();
 #endif /* ENABLE_AHRS */
 
-  GNSS_loop();
+  PROFILE(PROFILE_GNSS, GNSS_loop());
 
   Time_loop();   /* this is where GNSS time data is processed for Legacy protocol */
 
@@ -587,7 +588,7 @@ void normal()
     // check for newly received data, usually returns false
     // >>> do this here too to ensure no incoming packets are missed
     rx_tried = true;
-    rx_success = RF_Receive();
+    PROFILE(PROFILE_RX, rx_success = RF_Receive());
     // if received a packet, postpone transmission until next time around the loop().
 
       if (!rx_success && RF_Transmit_Ready() && (RF_current_slot != 0 || !relay_waiting)) {
@@ -622,7 +623,7 @@ void normal()
 
   // ensure receiver is re-activated
   if (!rx_tried || tx_success)
-    rx_success = RF_Receive();
+    PROFILE(PROFILE_RX, rx_success = RF_Receive());
 
 //if (rx_success)
 //Serial.println("received packet...");
@@ -640,7 +641,7 @@ void normal()
 
   if (validfix) {
     /* handle the known traffic - only if we know where we are */
-    Traffic_loop();
+    PROFILE(PROFILE_ALARM, Traffic_loop());
   }
 
   if (isTimeToDisplay()) {
@@ -663,12 +664,14 @@ void normal()
 #endif
 
   if (isTimeToExport()) {
-    NMEA_Export();
-    GDL90_Export();
+    PROFILE(PROFILE_EXPORT,
+      NMEA_Export();
+      GDL90_Export();
 
-    if (validfix) {
-      D1090_Export();
-    }
+      if (validfix) {
+        D1090_Export();
+      }
+    );
     ExportTimeMarker = millis();
   }
 
@@ -949,6 +952,8 @@ void txrx_test()
 
 void loop()
 {
+  Profile_loop();
+
   // Do common RF stuff first
   RF_loop();
 
@@ -983,7 +988,7 @@ void loop()
   }
 
   // Show status info on tiny OLED display
-  SoC->Display_loop();
+  PROFILE(PROFILE_DISPLAY, SoC->Display_loop());
 
   // battery status LED
   LED_loop();
@@ -1019,6 +1024,9 @@ void loop()
 
   SoC->Button_loop();
 
+  // Send out whatever NMEA was queued during this pass
+  NMEA_Flush();
+
 #if defined(TAKE_CARE_OF_MILLIS_ROLLOVER)
   /* restart the device when uptime is more than 47 days */
   if (millis() > (47 * 24 * 3600 * 1000UL)) {
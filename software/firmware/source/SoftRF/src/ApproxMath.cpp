@@ -257,3 +257,48 @@ float CosLat(float latitude)
 }
 
 float InvCosLat() { return inv_cos_lat; }
+
+/* Local tangent-plane frame for all the traffic geometry: targets get     */
+/* integer east/north offsets from ThisAircraft, in the quarter-meters the */
+/* Legacy collision prediction works in, and distance and bearing come     */
+/* from the integer approximations above.  The scale factors are only      */
+/* worked out again when our own position changes, i.e. once per fix.     */
+
+#define FRAME_QM_PER_DEG  (4 * 111300.0)
+
+static float frame_lat = 0;
+static float frame_lon = 0;
+static float frame_xscale = FRAME_QM_PER_DEG;
+static float frame_xscale_lat = 0;
+
+void LocalFrame_anchor(float latitude, float longitude)
+{
+  if (latitude == frame_lat && longitude == frame_lon)
+    return;
+  if (fabs(latitude - frame_xscale_lat) > 0.01) {    /* about 1 km */
+    frame_xscale = FRAME_QM_PER_DEG * cos_approx(latitude);
+    frame_xscale_lat = latitude;
+  }
+  frame_lat = latitude;
+  frame_lon = longitude;
+}
+
+void LocalFrame_xy(float latitude, float longitude, int32_t *x, int32_t *y)
+{
+  *y = (int32_t) (FRAME_QM_PER_DEG * (latitude  - frame_lat));
+  *x = (int32_t) (frame_xscale     * (longitude - frame_lon));
+}
+
+/* meters */
+uint32_t LocalFrame_distance(int32_t x, int32_t y)
+{
+  /* iapproxHypotenuse1() returns a lone coordinate as is, sign and all */
+  return (iapproxHypotenuse1(x < 0 ? -x : x, y < 0 ? -y : y) + 2) >> 2;
+}
+
+/* degrees, 0 to 359, from ThisAircraft towards x,y */
+int32_t LocalFrame_bearing(int32_t x, int32_t y)
+{
+  int32_t bearing = iatan2_approx(y, x);
+  return (bearing >= 360 ? bearing - 360 : bearing);
+}
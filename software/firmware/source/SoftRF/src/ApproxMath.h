@@ -30,4 +30,10 @@ int32_t iatan2_approx( int32_t ns, int32_t ew );
 uint32_t iapproxHypotenuse0( int32_t x, int32_t y );
 uint32_t iapproxHypotenuse1( int32_t x, int32_t y );
 
+/* local east/north frame anchored at ThisAircraft, in quarter-meters */
+void     LocalFrame_anchor(float, float);
+void     LocalFrame_xy(float, float, int32_t *, int32_t *);
+uint32_t LocalFrame_distance(int32_t, int32_t);
+int32_t  LocalFrame_bearing(int32_t, int32_t);
+
 #endif /* APPROXMATH_H */
@@ -31,6 +31,7 @@
 #include "protocol/data/NMEA.h"
 #include "ApproxMath.h"
 #include "Wind.h"
+#include "system/Profile.h"
 
 #if !defined(EXCLUDE_VOICE)
 #if defined(ESP32)
@@ -38,6 +39,15 @@
 #endif
 #endif
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#endif
+
 #if defined(ESP32)
 #include "SPIFFS.h"
 // #include <FS.h>
@@ -261,6 +271,142 @@ static int8_t Alarm_Vector(ufo_t *this_aircraft, ufo_t *fop)
 }
 
 
+/*
+ * Alarm_Legacy() projection data for a batch of targets.
+ * Relative velocities are stored time-major, so one time step of all
+ * lanes is contiguous and the minimum distance search below can run
+ * over several targets at once.
+ */
+#define LEGACY_STEPS          18
+#define LEGACY_LANES          8      /* multiple of 4 */
+#define LEGACY_PENDING        (-1)   /* lane filled, needs legacy_min_distance() */
+#define LEGACY_SKIP           (-2)   /* no alarm evaluated for this target */
+
+typedef struct {
+  int32_t  vx[LEGACY_STEPS][LEGACY_LANES];   /* quarter-meters per second */
+  int32_t  vy[LEGACY_STEPS][LEGACY_LANES];
+  int32_t  dx[LEGACY_LANES];                 /* quarter-meters */
+  int32_t  dy[LEGACY_LANES];
+  int32_t  sqdz[LEGACY_LANES];
+  uint32_t minsqdist[LEGACY_LANES];          /* results */
+  int32_t  mintime[LEGACY_LANES];
+  int32_t  vxmin[LEGACY_LANES];
+  int32_t  vymin[LEGACY_LANES];
+} legacy_batch_t;
+
+static legacy_batch_t legacy_batch;
+
+#if defined(__SSE2__) && !defined(__ARM_NEON)
+static inline __m128i sq_epi32(__m128i a)
+{
+#if defined(__SSE4_1__)
+  return _mm_mullo_epi32(a, a);
+#else
+  __m128i even = _mm_mul_epu32(a, a);
+  __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(a, 4));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+                            _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0,0,2,0)));
+#endif
+}
+#endif
+
+/*
+ * Project the relative paths of the first 'lanes' targets second by second
+ * and find the minimum 3D distance, when it happens and the relative
+ * velocity at that point.  All variants give the same (integer) results.
+ */
+static void legacy_min_distance(legacy_batch_t *b, int lanes)
+{
+  int k = 0;
+
+#if defined(__ARM_NEON)
+  for (; k < lanes; k += 4) {
+    int32x4_t  dx   = vld1q_s32(&b->dx[k]);
+    int32x4_t  dy   = vld1q_s32(&b->dy[k]);
+    int32x4_t  sqdz = vld1q_s32(&b->sqdz[k]);
+    uint32x4_t minsq = vdupq_n_u32(200*200*4*4);
+    int32x4_t  mint  = vdupq_n_s32(ALARM_TIME_CLOSE);
+    int32x4_t  vxmin = vdupq_n_s32(0);
+    int32x4_t  vymin = vdupq_n_s32(0);
+
+    for (int t=0; t<LEGACY_STEPS; t++) {
+      int32x4_t vx = vld1q_s32(&b->vx[t][k]);
+      int32x4_t vy = vld1q_s32(&b->vy[t][k]);
+      dx = vaddq_s32(dx, vx);
+      dy = vaddq_s32(dy, vy);
+      uint32x4_t sq = vreinterpretq_u32_s32(vmlaq_s32(vmlaq_s32(sqdz, dx, dx), dy, dy));
+      uint32x4_t lt = vcltq_u32(sq, minsq);
+      minsq = vbslq_u32(lt, sq, minsq);
+      mint  = vbslq_s32(lt, vdupq_n_s32(t), mint);
+      vxmin = vbslq_s32(lt, vx, vxmin);
+      vymin = vbslq_s32(lt, vy, vymin);
+    }
+    vst1q_u32(&b->minsqdist[k], minsq);
+    vst1q_s32(&b->mintime[k], mint);
+    vst1q_s32(&b->vxmin[k], vxmin);
+    vst1q_s32(&b->vymin[k], vymin);
+  }
+#elif defined(__SSE2__)
+  const __m128i neg = _mm_set1_epi32(-1);
+  for (; k < lanes; k += 4) {
+    __m128i dx    = _mm_loadu_si128((const __m128i *) &b->dx[k]);
+    __m128i dy    = _mm_loadu_si128((const __m128i *) &b->dy[k]);
+    __m128i sqdz  = _mm_loadu_si128((const __m128i *) &b->sqdz[k]);
+    __m128i minsq = _mm_set1_epi32(200*200*4*4);
+    __m128i mint  = _mm_set1_epi32(ALARM_TIME_CLOSE);
+    __m128i vxmin = _mm_setzero_si128();
+    __m128i vymin = _mm_setzero_si128();
+
+    for (int t=0; t<LEGACY_STEPS; t++) {
+      __m128i vx = _mm_loadu_si128((const __m128i *) &b->vx[t][k]);
+      __m128i vy = _mm_loadu_si128((const __m128i *) &b->vy[t][k]);
+      dx = _mm_add_epi32(dx, vx);
+      dy = _mm_add_epi32(dy, vy);
+      __m128i sq = _mm_add_epi32(_mm_add_epi32(sq_epi32(dx), sq_epi32(dy)), sqdz);
+      /* unsigned sq < minsq, minsq always fits in 31 bits */
+      __m128i lt = _mm_and_si128(_mm_cmplt_epi32(sq, minsq), _mm_cmpgt_epi32(sq, neg));
+      minsq = _mm_or_si128(_mm_and_si128(lt, sq), _mm_andnot_si128(lt, minsq));
+      mint  = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi32(t)), _mm_andnot_si128(lt, mint));
+      vxmin = _mm_or_si128(_mm_and_si128(lt, vx), _mm_andnot_si128(lt, vxmin));
+      vymin = _mm_or_si128(_mm_and_si128(lt, vy), _mm_andnot_si128(lt, vymin));
+    }
+    _mm_storeu_si128((__m128i *) &b->minsqdist[k], minsq);
+    _mm_storeu_si128((__m128i *) &b->mintime[k], mint);
+    _mm_storeu_si128((__m128i *) &b->vxmin[k], vxmin);
+    _mm_storeu_si128((__m128i *) &b->vymin[k], vymin);
+  }
+#endif /* __ARM_NEON || __SSE2__ */
+
+  /* scalar fallback (ESP32, nRF52, ...) */
+  for (; k < lanes; k++) {
+    int32_t dx = b->dx[k];
+    int32_t dy = b->dy[k];
+    int32_t sqdz = b->sqdz[k];
+    uint32_t minsqdist = 200*200*4*4;
+    int mintime = ALARM_TIME_CLOSE;
+    int vxmin = 0;
+    int vymin = 0;
+
+    for (int t=0; t<LEGACY_STEPS; t++) {
+      int32_t vx = b->vx[t][k];
+      int32_t vy = b->vy[t][k];
+      dx += vx;   /* change in relative position over this second */
+      dy += vy;
+      uint32_t sqdist = dx*dx + dy*dy + sqdz;
+      if (sqdist < minsqdist) {
+        minsqdist = sqdist;
+        vxmin = vx;
+        vymin = vy;
+        mintime = t;
+      }
+    }
+    b->minsqdist[k] = minsqdist;
+    b->mintime[k]   = mintime;
+    b->vxmin[k]     = vxmin;
+    b->vymin[k]     = vymin;
+  }
+}
+
 /*
  * VERY EXPERIMENTAL
  *
@@ -273,7 +419,7 @@ static int8_t Alarm_Vector(ufo_t *this_aircraft, ufo_t *fop)
  * Either way, this algorithm assumes that circling aircraft will keep circling
  * for the relevant time period (the next 19 seconds).
  */
-static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
+static int8_t Alarm_Legacy_prepare(ufo_t *this_aircraft, ufo_t *fop, int lane)
 {
   if (fop->distance > 2*ALARM_ZONE_CLOSE
       || fabs(fop->alt_diff) > 2*VERTICAL_SEPARATION) {
@@ -419,16 +565,10 @@ static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
   *py = vy;    
 
   /* 2D position of fop relative to this aircraft */
-  /* - computed in Traffic_Update() */
-  /* convert to quarter-meters */
-  int dx = fop->dx << 2;
-  int dy = fop->dy << 2;
-
-  /* project paths over time and find minimum 3D distance */
-  uint32_t minsqdist = 200*200*4*4;
-  int mintime = ALARM_TIME_CLOSE;
-  int vxmin = 0;
-  int vymin = 0;
+  /* - computed in Traffic_Update(), already in quarter-meters */
+  int dx = fop->dx;
+  int dy = fop->dy;
+
   /* if projections are from different times, offset the arrays */
   if (fop->projtime_ms > this_aircraft->projtime_ms + 500) {
     /* this_aircraft projection is older, shift by 1 second */
@@ -446,24 +586,30 @@ static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
     i = 0;
     j = 0;
   }
-  int t;
-  int sqdz = (adjdz*adjdz) << 4;
-  for (t=0; t<18; t++) {  /* loop over the 1-second time points prepared */
-    vx = thatvx[i] - thisvx[j];   /* relative velocity */
-    vy = thatvy[i] - thisvy[j];
-    dx += vx;   /* change in relative position over this second */
-    dy += vy;
-    /* dz += vz; */
-    uint32_t sqdist = dx*dx + dy*dy + sqdz;
-    if (sqdist < minsqdist) {
-      minsqdist = sqdist;
-      vxmin = vx;
-      vymin = vy;
-      mintime = t;
-    }
-    ++i;
-    ++j;
+
+  /* relative velocity over each of the 1-second time points prepared */
+  legacy_batch_t *b = &legacy_batch;
+  for (int t=0; t<LEGACY_STEPS; t++) {
+    b->vx[t][lane] = thatvx[i+t] - thisvx[j+t];
+    b->vy[t][lane] = thatvy[i+t] - thisvy[j+t];
   }
+  b->dx[lane] = dx;
+  b->dy[lane] = dy;
+  b->sqdz[lane] = (adjdz*adjdz) << 4;
+
+  return LEGACY_PENDING;
+}
+
+/*
+ * Turn the minimum distance found by legacy_min_distance() into an alarm level.
+ */
+static int8_t Alarm_Legacy_finish(ufo_t *this_aircraft, ufo_t *fop, int lane)
+{
+  legacy_batch_t *b = &legacy_batch;
+  uint32_t minsqdist = b->minsqdist[lane];
+  int mintime = b->mintime[lane];
+  int vxmin = b->vxmin[lane];
+  int vymin = b->vymin[lane];
 
   int8_t rval = ALARM_LEVEL_NONE;
 
@@ -521,7 +667,7 @@ static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
         PSTR("$PSALL,%06X,%ld,%ld,%d,%d,%d,%d,%.1f,%.1f,%.1f,%ld,%ld,%.1f,%.1f,%.1f,%.1f\r\n"),
           fop->addr, fop->projtime_ms, this_aircraft->projtime_ms, rval, mintime, minsqdist, sqspeed,
           this_aircraft->speed, this_aircraft->heading, this_aircraft->turnrate,
-          fop->dy, fop->dx, fop->alt_diff, fop->speed, fop->heading, fop->turnrate);
+          fop->dy / 4, fop->dx / 4, fop->alt_diff, fop->speed, fop->heading, fop->turnrate);
       NMEA_Outs(settings->nmea_d, settings->nmea2_d, NMEABuffer, strlen(NMEABuffer), false);
     }
   }
@@ -529,17 +675,53 @@ static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
   return rval;
 }
 
-void Traffic_Update(ufo_t *fop)
+static int8_t Alarm_Legacy(ufo_t *this_aircraft, ufo_t *fop)
+{
+  int8_t rval = Alarm_Legacy_prepare(this_aircraft, fop, 0);
+
+  if (rval != LEGACY_PENDING)
+    return rval;
+
+  legacy_min_distance(&legacy_batch, 1);
+
+  return Alarm_Legacy_finish(this_aircraft, fop, 0);
+}
+
+static void heap_fix(int);
+
+/*
+ * None of the alarm methods raises anything beyond 2*ALARM_ZONE_CLOSE
+ * horizontally or 2*VERTICAL_SEPARATION vertically (Adj_alt_diff() takes
+ * at most 50 + VERTICAL_SLACK meters off), so targets outside that box
+ * are given ALARM_LEVEL_NONE without calling Alarm_Level.  The box side
+ * allows for the error of LocalFrame_distance().  In quarter-meters.
+ */
+#define ALARM_BOX_QM    (4 * (2*ALARM_ZONE_CLOSE + ALARM_ZONE_CLOSE/16))
+#define ALARM_BOX_ALT   (2*VERTICAL_SEPARATION)
+
+uint32_t Traffic_alarm_evaluated = 0;
+uint32_t Traffic_alarm_boxed     = 0;
+
+static bool traffic_in_box(const ufo_t *fop)
+{
+  /* |dx| <= ALARM_BOX_QM etc. as one unsigned compare each */
+  return (uint32_t) (fop->dx + ALARM_BOX_QM) <= 2 * ALARM_BOX_QM &&
+         (uint32_t) (fop->dy + ALARM_BOX_QM) <= 2 * ALARM_BOX_QM &&
+         fabs(fop->alt_diff) <= ALARM_BOX_ALT;
+}
+
+/*
+ * Distance, bearing and altitude difference to ThisAircraft.
+ * Returns false if no alarm is to be evaluated for this target.
+ */
+static bool traffic_geometry(ufo_t *fop)
 {
-  /* use an approximation for distance & bearing between 2 points */
-  float x, y;
+  /* distance & bearing in the local frame around ThisAircraft */
   if (fop->protocol != RF_PROTOCOL_ADSB_1090) {
-    y = 111300.0 * (fop->latitude  - ThisAircraft.latitude);         /* meters */
-    x = 111300.0 * (fop->longitude - ThisAircraft.longitude) * CosLat(ThisAircraft.latitude);
-    fop->distance = approxHypotenuse(x, y);      /* meters  */
-    fop->bearing = atan2_approx(y, x);           /* degrees from ThisAircraft to fop */
-    fop->dx = (int32_t) x;
-    fop->dy = (int32_t) y;
+    LocalFrame_anchor(ThisAircraft.latitude, ThisAircraft.longitude);
+    LocalFrame_xy(fop->latitude, fop->longitude, &fop->dx, &fop->dy);
+    fop->distance = LocalFrame_distance(fop->dx, fop->dy);   /* meters  */
+    fop->bearing  = LocalFrame_bearing(fop->dx, fop->dy);    /* degrees from ThisAircraft to fop */
   }
 
   int rel_bearing = (int) (fop->bearing - ThisAircraft.course);
@@ -558,11 +740,15 @@ void Traffic_Update(ufo_t *fop)
   if ((fop->airborne == 0 || ThisAircraft.airborne == 0)
             && (millis() - SetupTimeMarker > 60000)) {
     fop->alarm_level = ALARM_LEVEL_NONE;
-    return;
+    return false;
   }
 
-  if (Alarm_Level) {
-      fop->alarm_level = (*Alarm_Level)(&ThisAircraft, fop);
+  return (Alarm_Level != NULL);
+}
+
+static void traffic_set_alarm(ufo_t *fop, int8_t alarm_level)
+{
+      fop->alarm_level = alarm_level;
 
       /* Sound an alarm if new alert, or got closer than previous alert,     */
       /* or (hysteresis) got two levels farther, and then closer.            */
@@ -579,6 +765,77 @@ void Traffic_Update(ufo_t *fop)
           --fop->alert_level;
           Alarm_timer = 0;
       }
+}
+
+static void Traffic_Update_Alarm(ufo_t *fop)
+{
+  if (!traffic_geometry(fop))
+    return;
+
+  if (traffic_in_box(fop)) {
+    Traffic_alarm_evaluated++;
+    traffic_set_alarm(fop, (*Alarm_Level)(&ThisAircraft, fop));
+  } else {
+    Traffic_alarm_boxed++;
+    traffic_set_alarm(fop, ALARM_LEVEL_NONE);
+  }
+}
+
+void Traffic_Update(ufo_t *fop)
+{
+  Traffic_Update_Alarm(fop);
+
+  /* alarm level and distance changed, keep the eviction order current */
+  if (fop >= &Container[0] && fop < &Container[MAX_TRACKING_OBJECTS])
+    heap_fix(fop - Container);
+}
+
+/*
+ * Same as Traffic_Update() for a list of targets.  With the "legacy"
+ * alarm method the projections of up to LEGACY_LANES targets are
+ * evaluated together.  Alarm levels are applied in list order.
+ * Eviction order is left to the caller (heap_rebuild()).
+ */
+void Traffic_Update_Batch(ufo_t **fops, int count)
+{
+  if (Alarm_Level != &Alarm_Legacy) {
+    for (int n = 0; n < count; n++)
+      Traffic_Update_Alarm(fops[n]);
+    return;
+  }
+
+  int8_t level[LEGACY_LANES];
+
+  for (int base = 0; base < count; base += LEGACY_LANES) {
+    int lanes = count - base;
+    if (lanes > LEGACY_LANES)
+      lanes = LEGACY_LANES;
+
+    bool pending = false;
+    for (int k = 0; k < lanes; k++) {
+      ufo_t *fop = fops[base + k];
+      if (!traffic_geometry(fop)) {
+        level[k] = LEGACY_SKIP;
+      } else if (traffic_in_box(fop)) {
+        Traffic_alarm_evaluated++;
+        level[k] = Alarm_Legacy_prepare(&ThisAircraft, fop, k);
+        pending |= (level[k] == LEGACY_PENDING);
+      } else {
+        Traffic_alarm_boxed++;
+        level[k] = ALARM_LEVEL_NONE;
+      }
+    }
+
+    if (pending)
+      legacy_min_distance(&legacy_batch, lanes);
+
+    for (int k = 0; k < lanes; k++) {
+      ufo_t *fop = fops[base + k];
+      if (level[k] == LEGACY_PENDING)
+        level[k] = Alarm_Legacy_finish(&ThisAircraft, fop, k);
+      if (level[k] >= ALARM_LEVEL_NONE)
+        traffic_set_alarm(fop, level[k]);
+    }
   }
 }
 
@@ -648,6 +905,401 @@ bool air_relay(ufo_t *fop)
     return true;
 }
 
+/*
+ * Traffic table bookkeeping.
+ *
+ * The Container[] slots in use are kept packed at the front of
+ * traffic_slots[], the free ones follow.  An open-addressed hash
+ * maps addr to slot, and a binary heap keeps the least important
+ * object (the first to be replaced when the table is full) on top,
+ * so that a received packet never needs a scan of the whole table.
+ */
+
+uint8_t traffic_slots[MAX_TRACKING_OBJECTS];
+static uint8_t slot_pos[MAX_TRACKING_OBJECTS];    /* index into traffic_slots[] */
+static int traffic_count = 0;
+
+static uint8_t traffic_hash[TRAFFIC_HASH_SIZE];   /* slot + 1, 0 = empty */
+
+static uint8_t evict_heap[MAX_TRACKING_OBJECTS];
+static uint8_t heap_pos[MAX_TRACKING_OBJECTS];    /* index into evict_heap[] */
+
+#define TRAFFIC_HASH_MASK (TRAFFIC_HASH_SIZE - 1)
+
+static inline int traffic_hash_of(uint32_t addr)
+{
+  return (int) (((uint32_t) (addr * 0x9E3779B1UL)) >> (32 - TRAFFIC_HASH_BITS));
+}
+
+static inline bool slot_is_live(int i)
+{
+  return (slot_pos[i] < traffic_count);
+}
+
+int Traffic_Find(uint32_t addr)
+{
+  if (addr == 0)
+    return -1;
+
+  int h = traffic_hash_of(addr);
+  uint8_t e;
+  while ((e = traffic_hash[h]) != 0) {
+    if (Container[e-1].addr == addr)
+      return e-1;
+    h = (h + 1) & TRAFFIC_HASH_MASK;
+  }
+  return -1;
+}
+
+static void hash_insert(int i)
+{
+  int h = traffic_hash_of(Container[i].addr);
+  while (traffic_hash[h] != 0)
+    h = (h + 1) & TRAFFIC_HASH_MASK;
+  traffic_hash[h] = i + 1;
+}
+
+/* linear probing: shift the rest of the cluster back, no tombstones */
+static void hash_delete(int i)
+{
+  int h = traffic_hash_of(Container[i].addr);
+  while (traffic_hash[h] != i + 1) {
+    if (traffic_hash[h] == 0)
+      return;      /* not indexed */
+    h = (h + 1) & TRAFFIC_HASH_MASK;
+  }
+
+  int j = h;
+  for (;;) {
+    j = (j + 1) & TRAFFIC_HASH_MASK;
+    uint8_t e = traffic_hash[j];
+    if (e == 0)
+      break;
+    int k = traffic_hash_of(Container[e-1].addr);
+    /* leave the entry in place if its home bucket is cyclically in (h, j] */
+    if (h <= j ? (h < k && k <= j) : (h < k || k <= j))
+      continue;
+    traffic_hash[h] = e;
+    h = j;
+  }
+  traffic_hash[h] = 0;
+}
+
+/* distance adjusted for altitude difference, as used to pick the farthest */
+static inline float eviction_distance(const ufo_t *fop)
+{
+  return (fop->adj_distance > fop->distance ? fop->adj_distance : fop->distance);
+}
+
+/* true if a is to be replaced before b */
+static bool less_important(const ufo_t *a, const ufo_t *b)
+{
+  if (a->alarm_level != b->alarm_level)
+    return (a->alarm_level < b->alarm_level);
+
+  uint32_t follow_id = settings->follow_id;
+  bool a_followed = (a->addr == follow_id);
+  bool b_followed = (b->addr == follow_id);
+  if (a_followed != b_followed)
+    return b_followed;
+
+  return (eviction_distance(a) > eviction_distance(b));
+}
+
+static inline void heap_swap(int m, int n)
+{
+  uint8_t t = evict_heap[m];
+  evict_heap[m] = evict_heap[n];
+  evict_heap[n] = t;
+  heap_pos[evict_heap[m]] = m;
+  heap_pos[evict_heap[n]] = n;
+}
+
+static void heap_up(int n)
+{
+  while (n > 0) {
+    int parent = (n - 1) >> 1;
+    if (! less_important(&Container[evict_heap[n]], &Container[evict_heap[parent]]))
+      break;
+    heap_swap(n, parent);
+    n = parent;
+  }
+}
+
+static void heap_down(int n)
+{
+  for (;;) {
+    int child = 2 * n + 1;
+    if (child >= traffic_count)
+      break;
+    if (child + 1 < traffic_count &&
+        less_important(&Container[evict_heap[child+1]], &Container[evict_heap[child]]))
+      child++;
+    if (! less_important(&Container[evict_heap[child]], &Container[evict_heap[n]]))
+      break;
+    heap_swap(n, child);
+    n = child;
+  }
+}
+
+static void heap_fix(int i)
+{
+  if (! slot_is_live(i))
+    return;
+  heap_up(heap_pos[i]);
+  heap_down(heap_pos[i]);
+}
+
+static void heap_rebuild()
+{
+  for (int n = traffic_count/2 - 1; n >= 0; n--)
+    heap_down(n);
+}
+
+/* move a free slot into the live part of the tables */
+static void link_slot(int i)
+{
+  int p = slot_pos[i];
+  uint8_t other = traffic_slots[traffic_count];
+  traffic_slots[p] = other;
+  slot_pos[other] = p;
+  traffic_slots[traffic_count] = i;
+  slot_pos[i] = traffic_count;
+
+  evict_heap[traffic_count] = i;
+  heap_pos[i] = traffic_count;
+  ++traffic_count;
+  heap_up(traffic_count - 1);
+
+  if (Container[i].addr)
+    hash_insert(i);
+}
+
+static void unlink_slot(int i)
+{
+  if (Container[i].addr)
+    hash_delete(i);
+
+  --traffic_count;
+  int p = slot_pos[i];
+  uint8_t last = traffic_slots[traffic_count];
+  traffic_slots[p] = last;
+  slot_pos[last] = p;
+  traffic_slots[traffic_count] = i;
+  slot_pos[i] = traffic_count;
+
+  int n = heap_pos[i];
+  last = evict_heap[traffic_count];
+  evict_heap[n] = last;
+  heap_pos[last] = n;
+  if (n < traffic_count)
+    heap_fix(last);
+}
+
+/* (re)build the tables from whatever is in Container[] */
+static void Traffic_Reindex()
+{
+  traffic_count = 0;
+  memset(traffic_hash, 0, sizeof(traffic_hash));
+  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    traffic_slots[i] = i;
+    slot_pos[i] = i;
+  }
+  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    if (Container[i].addr == 0)
+      continue;
+    if (Traffic_Find(Container[i].addr) >= 0)
+      Container[i].addr = 0;       /* duplicate */
+    else
+      link_slot(i);
+  }
+}
+
+/* store a copy of *fop in slot i, replacing whatever was there */
+void Traffic_Store(int i, ufo_t *fop)
+{
+  bool live = slot_is_live(i);
+  if (live && Container[i].addr != fop->addr) {
+    unlink_slot(i);
+    live = false;
+  }
+  Container[i] = *fop;
+  if (live)
+    heap_fix(i);
+  else
+    link_slot(i);
+}
+
+void Traffic_Remove(int i)
+{
+  if (slot_is_live(i))
+    unlink_slot(i);
+  Container[i].addr = 0;
+}
+
+/* an empty slot, purging expired objects if the table is full, or -1 */
+int Traffic_Free_Slot()
+{
+  if (traffic_count >= MAX_TRACKING_OBJECTS)
+    ClearExpired();
+  if (traffic_count < MAX_TRACKING_OBJECTS)
+    return traffic_slots[traffic_count];
+  return -1;
+}
+
+/*
+ * The slot of a current object less important than *fop, or -1.
+ * 'force' allows replacing the farthest object even if fop is farther.
+ */
+int Traffic_Evict_Slot(ufo_t *fop, bool force)
+{
+  if (traffic_count == 0)
+    return -1;
+
+  int i = evict_heap[0];
+  ufo_t *cip = &Container[i];
+
+  /* replace an object of lower alarm level if found */
+  if (cip->alarm_level < fop->alarm_level)
+    return i;
+
+  /* replace the farthest-away non-"followed" object,              */
+  /* but only if the new object is closer (or "followed", or forced) */
+  uint32_t follow_id = settings->follow_id;
+  if (cip->alarm_level == ALARM_LEVEL_NONE && cip->addr != follow_id) {
+    float max_adj_dist = eviction_distance(cip);
+    if (max_adj_dist > 0
+        && (eviction_distance(fop) < max_adj_dist
+            || fop->addr == follow_id
+            || force))
+      return i;
+  }
+
+  return -1;
+}
+
+/*
+ * Dead reckoning of targets between packets.
+ *
+ * A new fix is taken as it is (alpha = 1: these are GNSS positions, good
+ * to a few meters), and its position at the previous fix is carried
+ * forward along the reported course, speed and turn rate plus a velocity
+ * correction.  Where the next fix lands relative to that prediction
+ * updates the correction (beta), which soaks up what the reported ground
+ * velocity misses - e.g. the lag of the FLARM velocity vectors.
+ */
+#define TRACK_BETA          0.25
+#define TRACK_MAX_BIAS      5.0     /* m/s */
+#define TRACK_MAX_TURN      30.0    /* deg/s */
+#define TRACK_MAX_COAST_MS  6000    /* no extrapolation beyond this after a fix */
+#define TRACK_M_PER_DEG     111300.0
+
+uint32_t Traffic_track_fixes = 0;
+float    Traffic_track_error = 0;   /* sum of fix - prediction, meters */
+float    Traffic_track_stale = 0;   /* sum of fix - previous fix, meters */
+
+static inline bool track_enabled(const ufo_t *fop)
+{
+  /* GNS5892 (1090ES) targets are positioned by their own driver */
+  return (fop->track_ms != 0 && fop->protocol != RF_PROTOCOL_ADSB_1090);
+}
+
+static void track_start(ufo_t *fop)
+{
+  fop->track_ms = fop->gnsstime_ms;
+  fop->fix_lat  = fop->latitude;
+  fop->fix_lon  = fop->longitude;
+  fop->fix_alt  = fop->altitude;
+  fop->fix_course  = fop->course;
+  fop->fix_heading = fop->heading;
+  fop->bias_ns  = 0;
+  fop->bias_ew  = 0;
+}
+
+/*
+ * Move the position, course and projection time of fop forward to ms.
+ * They are a working copy: always dead-reckoned from the last received
+ * fix (fix_* at gnsstime_ms), which is what the history is built from.
+ */
+static void track_advance(ufo_t *fop, uint32_t ms)
+{
+  if (! track_enabled(fop))
+    return;
+
+  if ((int32_t) (ms - fop->gnsstime_ms) > TRACK_MAX_COAST_MS)
+    ms = fop->gnsstime_ms + TRACK_MAX_COAST_MS;
+  int32_t dt_ms = (int32_t) (ms - fop->track_ms);
+  if (dt_ms <= 0)
+    return;
+  float dt = 0.001 * (float) (int32_t) (ms - fop->gnsstime_ms);
+
+  float speed = fop->speed * _GPS_MPS_PER_KNOT;
+  float v_ns = speed * cos_approx(fop->fix_course) + fop->bias_ns;
+  float v_ew = speed * sin_approx(fop->fix_course) + fop->bias_ew;
+
+  float turn = (fop->airborne ? fop->turnrate : 0);
+  if (turn >  TRACK_MAX_TURN)  turn =  TRACK_MAX_TURN;
+  if (turn < -TRACK_MAX_TURN)  turn = -TRACK_MAX_TURN;
+  float angle = turn * dt;               /* degrees turned meanwhile */
+
+  float d_ns, d_ew;
+  if (fabs(angle) < 2.0) {
+    d_ns = v_ns * dt;
+    d_ew = v_ew * dt;
+  } else {
+    /* along the arc of a constant rate turn */
+    float s = sin_approx(angle);
+    float c = 1.0 - cos_approx(angle);
+    float r = dt / (angle * (PI / 180.0));   /* 1 / turn rate in rad/s */
+    d_ns = (v_ns * s - v_ew * c) * r;
+    d_ew = (v_ew * s + v_ns * c) * r;
+  }
+
+  fop->latitude  = fop->fix_lat + d_ns * (1.0 / TRACK_M_PER_DEG);
+  fop->longitude = fop->fix_lon + d_ew / (TRACK_M_PER_DEG * cos_approx(fop->fix_lat));
+  fop->altitude  = fop->fix_alt + fop->vs * dt * (1.0 / (60.0 * _GPS_FEET_PER_METER));
+
+  fop->course = fop->fix_course + angle;
+  if (fop->course <    0.0)  fop->course += 360.0;
+  if (fop->course >= 360.0)  fop->course -= 360.0;
+  fop->heading = fop->fix_heading + angle;
+  if (fop->heading <    0.0)  fop->heading += 360.0;
+  if (fop->heading >= 360.0)  fop->heading -= 360.0;
+
+  /* keeps the Legacy alarm's time alignment with ThisAircraft right */
+  fop->projtime_ms += dt_ms;
+  fop->track_ms = ms;
+}
+
+/* a new fix fop for the tracked target cip, before it replaces cip */
+static void track_measure(ufo_t *cip, const ufo_t *fop)
+{
+  uint32_t dt_ms = fop->gnsstime_ms - cip->gnsstime_ms;
+  if (! track_enabled(cip) || dt_ms < 500 || dt_ms > TRACK_MAX_COAST_MS) {
+    cip->bias_ns = 0;
+    cip->bias_ew = 0;
+    return;
+  }
+
+  track_advance(cip, fop->gnsstime_ms);
+
+  float m_per_deg_ew = TRACK_M_PER_DEG * cos_approx(fop->latitude);
+  float r_ns = (fop->latitude  - cip->latitude)  * TRACK_M_PER_DEG;
+  float r_ew = (fop->longitude - cip->longitude) * m_per_deg_ew;
+
+  Traffic_track_fixes++;
+  Traffic_track_error += approxHypotenuse(r_ns, r_ew);
+  Traffic_track_stale += approxHypotenuse(
+                           (fop->latitude  - cip->fix_lat) * TRACK_M_PER_DEG,
+                           (fop->longitude - cip->fix_lon) * m_per_deg_ew);
+
+  float k = TRACK_BETA * 1000.0 / (float) dt_ms;
+  float b_ns = cip->bias_ns + k * r_ns;
+  float b_ew = cip->bias_ew + k * r_ew;
+  cip->bias_ns = constrain(b_ns, -TRACK_MAX_BIAS, TRACK_MAX_BIAS);
+  cip->bias_ew = constrain(b_ew, -TRACK_MAX_BIAS, TRACK_MAX_BIAS);
+}
+
 void AddTraffic(ufo_t *fop)
 {
     ufo_t *cip;
@@ -668,86 +1320,89 @@ void AddTraffic(ufo_t *fop)
     }
 
     /* first check whether we are already tracking this object */
-    int i;
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    int i = Traffic_Find(fop->addr);
+    if (i >= 0) {
 
       cip = &Container[i];
 
-      if (cip->addr == fop->addr) {
-
-        bool fop_adsb = fop->protocol == RF_PROTOCOL_GDL90 || fop->protocol == RF_PROTOCOL_ADSB_1090;
-        bool cip_adsb = cip->protocol == RF_PROTOCOL_GDL90 || cip->protocol == RF_PROTOCOL_ADSB_1090;
+      bool fop_adsb = fop->protocol == RF_PROTOCOL_GDL90 || fop->protocol == RF_PROTOCOL_ADSB_1090;
+      bool cip_adsb = cip->protocol == RF_PROTOCOL_GDL90 || cip->protocol == RF_PROTOCOL_ADSB_1090;
+
+      // ignore external (ADS-B) data about aircraft we also receive from directly
+      if (fop_adsb && ! cip_adsb) {
+          if (timenow - cip->timestamp <= ENTRY_EXPIRATION_TIME)
+              return;
+          // was tracked via other means, but expired - take over this slot
+          *cip = *fop;
+          track_start(cip);
+          Traffic_Update(cip);
+          return;
+      }
 
-        // ignore external (ADS-B) data about aircraft we also receive from directly
-        if (fop_adsb && ! cip_adsb) {
-            if (timenow - cip->timestamp <= ENTRY_EXPIRATION_TIME)
-                return;
-            // was tracked via other means, but expired - take over this slot
-            *cip = *fop;
-            Traffic_Update(cip);
-            return;
-        }
+      // overwrite external (ADS-B) data about aircraft that also has FLARM
+      if (cip_adsb && ! fop_adsb) {
+          *cip = *fop;
+          track_start(cip);
+          Traffic_Update(cip);
+          return;
+      }
 
-        // overwrite external (ADS-B) data about aircraft that also has FLARM
-        if (cip_adsb && ! fop_adsb) {
-            *cip = *fop;
-            Traffic_Update(cip);
-            return;
-        }
+      if (fop->protocol != RF_PROTOCOL_ADSB_1090)   // imports come with their own
+        fop->distance = cip->distance;    // - data from previous packet or update
+      fop->alt_diff = cip->alt_diff;
+      fop->timerelayed = cip->timerelayed;
+      if (do_relay)  do_relay = air_relay(fop);
+      // this updates fop->timerelayed, to be copied later into container[]
+
+      /* ignore "new" GPS fixes that are exactly the same as before */
+      /*   - cip may have been moved on by track_advance() since */
+      if (fop->altitude == cip->fix_alt &&
+          fop->latitude == cip->fix_lat &&
+          fop->longitude == cip->fix_lon) {
+              cip->timerelayed = fop->timerelayed;
+              return;
+      }
 
-        fop->distance = cip->distance;      // - data from previous packet or update
-        fop->alt_diff = cip->alt_diff;
-        fop->timerelayed = cip->timerelayed;
-        if (do_relay)  do_relay = air_relay(fop);
-        // this updates fop->timerelayed, to be copied later into container[]
-
-        /* ignore "new" GPS fixes that are exactly the same as before */
-        if (fop->altitude == cip->altitude &&
-            fop->latitude == cip->latitude &&
-            fop->longitude == cip->longitude) {
-                cip->timerelayed = fop->timerelayed;
-                return;
-        }
+      /* overwrite old entry, but preserve fields that store history */
+      /*   - they sit at the end of ufo_t and are updated in place */
+
+      if ((fop->gnsstime_ms - cip->gnsstime_ms > 1200)
+        /* packets spaced far enough apart, store new history */
+      || (fop->gnsstime_ms - cip->prevtime_ms > 2600)) {
+        /* previous history getting too old, drop it */
+        /* this means using the past data from < 1200 ms ago */
+        /* to avoid that would need to store data from yet another time point */
+        /* the last received fix, not the dead-reckoned values */
+        cip->prevtime_ms  = cip->gnsstime_ms;
+        cip->prevcourse   = cip->fix_course;
+        cip->prevheading  = cip->fix_heading;
+        /* cip->prevspeed = cip->speed; */
+        cip->prevaltitude = cip->fix_alt;
+      }
+      /* else retain the older history for now */
+      /* >>> may want to also retain info needed to compute velocity vector at t=0 */
 
-        /* overwrite old entry, but preserve fields that store history */
-        /*   - they are copied into fo and then back into Container[i] */
-
-        if ((fop->gnsstime_ms - cip->gnsstime_ms > 1200)
-          /* packets spaced far enough apart, store new history */
-        || (fop->gnsstime_ms - cip->prevtime_ms > 2600)) {
-          /* previous history getting too old, drop it */
-          /* this means using the past data from < 1200 ms ago */
-          /* to avoid that would need to store data from yet another time point */
-          fop->prevtime_ms  = cip->gnsstime_ms;
-          fop->prevcourse   = cip->course;
-          fop->prevheading  = cip->heading;
-          /* fop->prevspeed = Container[i].speed; */
-          fop->prevaltitude = cip->altitude;
-        } else {
-          /* retain the older history for now */
-          fop->prevtime_ms  = cip->prevtime_ms;
-          fop->prevcourse   = cip->prevcourse;
-          fop->prevheading  = cip->prevheading;
-          /* fop->prevspeed = cip->prevspeed; */
-          fop->prevaltitude = cip->prevaltitude;
-          /* >>> may want to also retain info needed to compute velocity vector at t=0 */
-        }
-        fop->turnrate    = cip->turnrate;   /* keep the old turn rate */
-        fop->alert       = cip->alert;
-        fop->alert_level = cip->alert_level;
-     /* fop->callsign    = cip->callsign; */
+      track_measure(cip, fop);
 
-        *cip = *fop;   /* copies the whole object/structure */
+      /* the old turn rate, track, alert and alert_level are kept as well */
+      memcpy(cip, fop, UFO_PACKET_SIZE);
+      cip->track_ms = cip->gnsstime_ms;
+      cip->fix_lat  = cip->latitude;
+      cip->fix_lon  = cip->longitude;
+      cip->fix_alt  = cip->altitude;
+      cip->fix_course  = cip->course;
+      cip->fix_heading = cip->heading;   /* project_that() may refine it */
 
-        /* Now old alert_level is in same structure, can update alarm_level:  */
-        Traffic_Update(cip);    // also updates distance, alt_diff
+      /* Now old alert_level is in same structure, can update alarm_level:  */
+      Traffic_Update(cip);    // also updates distance, alt_diff
 
-        return;
-      }
+      return;
     }
 
     /* new object, try and find a slot for it */
 
+    track_start(fop);
+
     /* get distance, alt_diff, and alarm_level, to be copied later into container[] */
     Traffic_Update(fop);
 
@@ -755,74 +1410,14 @@ void AddTraffic(ufo_t *fop)
     if (do_relay)  do_relay = air_relay(fop);
     // this updates fop->timerelayed, to be copied later into container[]
 
-    /* replace an empty object if found */
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr == 0) {
-        Container[i] = *fop;
-        return;
-      }
-    }
-    /* replace an expired object if found */
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (timenow - Container[i].timestamp > ENTRY_EXPIRATION_TIME) {
-        Container[i] = *fop;
-        return;
-      }
-    }
-
-    /* may need to replace a non-expired object:   */
-    /* identify the least important current object */
-
-    uint32_t follow_id = settings->follow_id;
-
-    /* replace an object of lower alarm level if found */
-
-    if (fop->alarm_level > ALARM_LEVEL_NONE) {
-      int min_level_ndx = 0;
-      int min_level = fop->alarm_level;
-      for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-        if (Container[i].alarm_level < min_level) {
-          min_level_ndx = i;
-          min_level = Container[i].alarm_level;
-        } else if (Container[min_level_ndx].addr == follow_id
-                     && min_level < fop->alarm_level
-                     && Container[i].alarm_level == min_level) {
-          min_level_ndx = i;
-        }
-      }
-      if (min_level < fop->alarm_level) {
-          Container[min_level_ndx] = *fop;
-          return;
-      }
-    }
-
-    /* identify the farthest-away non-"followed" object */
-    /*    (distance adjusted for altitude difference)   */
-
-    int max_dist_ndx = MAX_TRACKING_OBJECTS;
-    float max_adj_dist = 0;
-    float adj_distance;
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].alarm_level == ALARM_LEVEL_NONE
-          && Container[i].addr != follow_id) {
-        adj_distance = Container[i].distance;
-        if (Container[i].adj_distance > adj_distance)
-              adj_distance = Container[i].adj_distance;
-        if (adj_distance > max_adj_dist)  {
-          max_dist_ndx = i;
-          max_adj_dist = adj_distance;
-        }
-      }
-    }
-
-    /* replace the farthest currently-tracked object, */
-    /* but only if the new object is closer (or "followed", or relayed) */
-    adj_distance = fop->adj_distance;
-    if (max_dist_ndx < MAX_TRACKING_OBJECTS
-      && (adj_distance < max_adj_dist
-          || fop->addr == follow_id
-          || (do_relay && fop->timerelayed > 0))) {
-      Container[max_dist_ndx] = *fop;
+    /* replace an empty (or expired) object if found, else may need   */
+    /* to replace a non-expired object: the least important current */
+    /* one, if it has a lower alarm level or is farther away         */
+    i = Traffic_Free_Slot();
+    if (i < 0)
+      i = Traffic_Evict_Slot(fop, (do_relay && fop->timerelayed > 0));
+    if (i >= 0) {
+      Traffic_Store(i, fop);
       return;
     }
 
@@ -850,21 +1445,26 @@ void ParseData(void)
       StdOut.println(RF_last_rssi);
     }
 
-    fo = EmptyFO;  /* to ensure no data from past packets remains in any field */
+    memset(&fo, 0, sizeof(fo));  /* to ensure no data from past packets remains in any field */
 
     if (protocol_decode == NULL)
         return;
 
-    if (((*protocol_decode)((void *) fo_raw, &ThisAircraft, &fo)) == false)
+    bool decoded;
+    PROFILE(PROFILE_DECODE,
+            decoded = (*protocol_decode)((void *) fo_raw, &ThisAircraft, &fo));
+    if (! decoded)
         return;
 
     fo.rssi = RF_last_rssi;
 
-    AddTraffic(&fo);
+    PROFILE(PROFILE_TRAFFIC, AddTraffic(&fo));
 }
 
 void Traffic_setup()
 {
+  Traffic_Reindex();
+
   switch (settings->alarm)
   {
   case TRAFFIC_ALARM_NONE:
@@ -895,42 +1495,33 @@ void Traffic_loop()
     int sound_alarm_level = ALARM_LEVEL_NONE;    /* local, used for sound alerts */
     int alarmcount = 0;
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    static ufo_t *live[MAX_TRACKING_OBJECTS];
+    static ufo_t *stale[MAX_TRACKING_OBJECTS];
+    int live_count = 0;
+    int stale_count = 0;
 
+    /* walk backwards so that removals do not skip any live slot */
+    for (int n = traffic_count - 1; n >= 0; n--) {
+
+      int i = traffic_slots[n];
       ufo_t *fop = &Container[i];
 
       if (fop->addr) {  /* non-empty ufo */
       
         if (ThisAircraft.timestamp - fop->timestamp <= ENTRY_EXPIRATION_TIME) {
 
-          if ((ThisAircraft.timestamp - fop->timestamp) >= TRAFFIC_VECTOR_UPDATE_INTERVAL)
-              Traffic_Update(fop);
-          /* else Traffic_Update(fop) was called last time a radio packet came in */
-
-          /* determine the highest alarm level seen at the moment */
-          if (fop->alarm_level > max_alarm_level)
-              max_alarm_level = fop->alarm_level;
-
-          /* determine if any traffic with alarm level low+ is "ahead" */
-          /* - this is for the strobe, increase flashing if "ahead" */
-          if (fop->alarm_level >= ALARM_LEVEL_LOW) {
-              if (abs(fop->RelativeBearing) < 45)
-                  alarm_ahead = true;
-          }
+          live[live_count++] = fop;
 
-          /* figure out what is the highest alarm level needing a sound alert */
-          if (fop->alarm_level > fop->alert_level
-                   && fop->alarm_level > ALARM_LEVEL_CLOSE) {
-              ++alarmcount;
-              if (fop->alarm_level > sound_alarm_level) {
-                  sound_alarm_level = fop->alarm_level;
-                  mfop = fop;
-              }
+          if ((ThisAircraft.timestamp - fop->timestamp) >= TRAFFIC_VECTOR_UPDATE_INTERVAL) {
+              /* bring it up to the time of our own position fix */
+              track_advance(fop, ThisAircraft.gnsstime_ms);
+              stale[stale_count++] = fop;
           }
+          /* else Traffic_Update(fop) was called last time a radio packet came in */
 
         } else {   /* expired ufo */
 
-          fop->addr = 0;
+          Traffic_Remove(i);
 
           //*fop = EmptyFO;
 
@@ -945,6 +1536,34 @@ void Traffic_loop()
       }
     }
 
+    Traffic_Update_Batch(stale, stale_count);
+
+    for (int n = 0; n < live_count; n++) {
+
+      ufo_t *fop = live[n];
+
+      /* determine the highest alarm level seen at the moment */
+      if (fop->alarm_level > max_alarm_level)
+          max_alarm_level = fop->alarm_level;
+
+      /* determine if any traffic with alarm level low+ is "ahead" */
+      /* - this is for the strobe, increase flashing if "ahead" */
+      if (fop->alarm_level >= ALARM_LEVEL_LOW) {
+          if (abs(fop->RelativeBearing) < 45)
+              alarm_ahead = true;
+      }
+
+      /* figure out what is the highest alarm level needing a sound alert */
+      if (fop->alarm_level > fop->alert_level
+               && fop->alarm_level > ALARM_LEVEL_CLOSE) {
+          ++alarmcount;
+          if (fop->alarm_level > sound_alarm_level) {
+              sound_alarm_level = fop->alarm_level;
+              mfop = fop;
+          }
+      }
+    }
+
     /* Sound an alarm if new alert, or got closer than previous alert,     */
     /* or (hysteresis) got two levels farther, and then closer.            */
     /* E.g., if alarm was for LOW, alert_level was set to LOW.             */
@@ -1013,33 +1632,27 @@ Serial.println(NMEABuffer);
       }
     }
 
+    /* pick up follow_id changes and fields edited outside Traffic_Update() */
+    heap_rebuild();
+
     UpdateTrafficTimeMarker = millis();
 }
 
-// currently this function is not called from anywhere (in "normal" mode)
-//   - instead expired entries are purged in Traffic_loop()
+// in "normal" mode expired entries are purged in Traffic_loop(),
+//   this is also called when a new object finds the table full
 void ClearExpired()
 {
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].addr &&
-         (ThisAircraft.timestamp - Container[i].timestamp) > ENTRY_EXPIRATION_TIME) {
-      //Container[i] = EmptyFO;
-      Container[i].addr = 0;
+  for (int n = traffic_count - 1; n >= 0; n--) {
+    int i = traffic_slots[n];
+    if ((ThisAircraft.timestamp - Container[i].timestamp) > ENTRY_EXPIRATION_TIME) {
+      Traffic_Remove(i);
     }
   }
 }
 
 int Traffic_Count()
 {
-  int count = 0;
-
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].addr) {
-      count++;
-    }
-  }
-
-  return count;
+  return traffic_count;
 }
 
 /* this is used in Text_EPD.cpp for 'radar' display, */
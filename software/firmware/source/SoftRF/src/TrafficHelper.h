@@ -52,6 +52,27 @@
 #define isTimeToUpdateTraffic() (millis() - UpdateTrafficTimeMarker > \
                                   TRAFFIC_UPDATE_INTERVAL_MS)
 
+/* ufo_t.next and the slot tables below link Container[] slots as uint8_t */
+#if MAX_TRACKING_OBJECTS > 255
+#error "MAX_TRACKING_OBJECTS must not exceed 255"
+#endif
+
+/* open-addressed addr -> slot index, kept at most half full */
+#if   MAX_TRACKING_OBJECTS <= 8
+#define TRAFFIC_HASH_BITS     4
+#elif MAX_TRACKING_OBJECTS <= 16
+#define TRAFFIC_HASH_BITS     5
+#elif MAX_TRACKING_OBJECTS <= 32
+#define TRAFFIC_HASH_BITS     6
+#elif MAX_TRACKING_OBJECTS <= 64
+#define TRAFFIC_HASH_BITS     7
+#elif MAX_TRACKING_OBJECTS <= 128
+#define TRAFFIC_HASH_BITS     8
+#else
+#define TRAFFIC_HASH_BITS     9
+#endif
+#define TRAFFIC_HASH_SIZE     (1 << TRAFFIC_HASH_BITS)
+
 typedef struct traffic_by_dist_struct {
   ufo_t *fop;
   float distance;
@@ -74,7 +95,13 @@ void Traffic_setup(void);
 void Traffic_loop(void);
 void ClearExpired(void);
 void Traffic_Update(ufo_t *);
+void Traffic_Update_Batch(ufo_t **, int);
 int  Traffic_Count(void);
+int  Traffic_Find(uint32_t);
+int  Traffic_Free_Slot(void);
+int  Traffic_Evict_Slot(ufo_t *, bool);
+void Traffic_Store(int, ufo_t *);
+void Traffic_Remove(int);
 
 int  traffic_cmp_by_distance(const void *, const void *);
 float Adj_alt_diff(ufo_t *, ufo_t *);
@@ -83,10 +110,18 @@ void generate_random_id(void);
 extern ufo_t fo, Container[MAX_TRACKING_OBJECTS], EmptyFO;
 extern uint8_t fo_raw[34];
 extern traffic_by_dist_t traffic_by_dist[MAX_TRACKING_OBJECTS];
+/* Container[] slots in use are traffic_slots[0 .. Traffic_Count()-1] */
+extern uint8_t traffic_slots[MAX_TRACKING_OBJECTS];
 extern int max_alarm_level;
 extern bool alarm_ahead;
 extern bool relay_waiting;
 extern float average_baro_alt_diff;
+/* targets given to Alarm_Level, and those ruled out by the integer box */
+extern uint32_t Traffic_alarm_evaluated, Traffic_alarm_boxed;
+/* fixes of tracked targets, and how far they landed from the dead reckoned
+   and from the previous position, summed in meters */
+extern uint32_t Traffic_track_fixes;
+extern float Traffic_track_error, Traffic_track_stale;
 
 #if defined(ESP32)
 extern File AlarmLog;
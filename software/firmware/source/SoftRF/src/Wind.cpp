@@ -419,7 +419,7 @@ void this_airborne()
         initial_latitude = 0;
       }
 
-    } else if (airborne < 0) {    /* not airborne but moving with speed > 1 knot */
+    } else if (airborne <= 0) {   /* not airborne but moving with speed > 1 knot */
 
       if (GNSSTimeMarker > 0 && ThisAircraft.prevtime_ms > 0) {  /* had fix for a while */
 
@@ -1019,19 +1019,33 @@ To compute the correct air-reference circling path:
     heading = atan2_approx(as_ns, as_ew);
     if (heading >  360.0) heading -= 360.0;
     if (heading < -360.0) heading += 360.0;
-    fop->heading = heading;                      /* will be carried over into prevheading */
+    fop->heading = heading;
     aspeed = approxHypotenuse(as_ns, as_ew);     /* air speed */
 
+    /* course and heading above may be dead-reckoned to track_ms, */
+    /* the turn rate is measured between received fixes only      */
+    uint32_t ref_ms = fop->gnsstime_ms;
+    float fix_heading = heading;
+    if (fop->track_ms != 0 && (int32_t) (fop->track_ms - fop->gnsstime_ms) > 0) {
+      ref_ms = fop->track_ms;
+      fix_heading = atan2_approx(gspeed * cos_approx(fop->fix_course) - wind_best_ns,
+                                 gspeed * sin_approx(fop->fix_course) - wind_best_ew);
+      if (fix_heading >  360.0) fix_heading -= 360.0;
+      if (fix_heading < -360.0) fix_heading += 360.0;
+    }
+    fop->fix_heading = fix_heading;              /* will be carried over into prevheading */
+
     /* turn rate in the air reference frame (drifting with the wind) */
-    float heading_change = heading - prevheading;
+    float heading_change = fix_heading - prevheading;
 
     if (fabs(heading_change) > 270.0) {
       /* roll-over through 360 */
-      if (heading > 270.0)  heading_change -= 360.0;
+      if (fix_heading > 270.0)  heading_change -= 360.0;
       else heading_change += 360.0;
     }
     uint32_t interval = fop->gnsstime_ms - fop->prevtime_ms;
-    fop->projtime_ms = fop->gnsstime_ms - (interval >> 1);  /* midway between the 2 time points */
+    /* midway between the 2 time points, moved along with any dead reckoning */
+    fop->projtime_ms = ref_ms - (interval >> 1);
     aturnrate = heading_change / (0.001 * (float) interval);
     if (fabs(aturnrate) > 50.0)  aturnrate = 0.0;        /* ignore implausible data */
     if (fabs(aturnrate) <  2.0)  aturnrate = 0.0;        /* ignore inaccurate data */
@@ -1071,10 +1085,10 @@ To compute the correct air-reference circling path:
 
     /* else, if turning */
 
-    if (fop->projtime_ms > fop->gnsstime_ms)
-      heading += aturnrate * (float) (fop->projtime_ms - fop->gnsstime_ms);
+    if (fop->projtime_ms > ref_ms)
+      heading += aturnrate * (float) (fop->projtime_ms - ref_ms);
     else
-      heading -= aturnrate * (float) (fop->gnsstime_ms - fop->projtime_ms);
+      heading -= aturnrate * (float) (ref_ms - fop->projtime_ms);
 
     if (fabs(aturnrate) > 6.0) {
       /* since the projection is in straight segments rather than a circle, */
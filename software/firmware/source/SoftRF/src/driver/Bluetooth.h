@@ -60,7 +60,7 @@ extern bool BTactive;
 #define GPS2_CHARACTERISTIC_UUID        "aba27100-143b-4b81-a444-edcd0000f024"
 #define SYSTEM_CHARACTERISTIC_UUID      "aba27100-143b-4b81-a444-edcd0000f025"
 
-/* (FLAA x MAX_TRACKING_OBJECTS + GNGGA + GNRMC + FLAU) x 80 symbols */
+/* (FLAA x MAX_NMEA_OBJECTS + GNGGA + GNRMC + FLAU) x 80 symbols */
 #define BLE_FIFO_TX_SIZE          1024
 #define BLE_FIFO_RX_SIZE          256
 
@@ -49,6 +49,7 @@
 #endif
 
 bool is_prime_mk2 = false;
+bool GNSS_pvt_mode = false;   /* own-ship fixes come as UBX-NAV-PVT, no GGA/RMC */
 
 unsigned long GNSSTimeSyncMarker = 0;
 volatile unsigned long PPS_TimeMarker = 0;
@@ -197,6 +198,11 @@ const uint8_t setVTG[] PROGMEM = {0xF0, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
 #if !defined(NMEA_TCP_SERVICE)
 const uint8_t setGSA[] PROGMEM = {0xF0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
 #endif
+#if defined(USE_UBX_PVT)
+const uint8_t setPVT[] PROGMEM = {0x01, 0x07, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00};
+const uint8_t setGGA[] PROGMEM = {0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+const uint8_t setRMC[] PROGMEM = {0xF0, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+#endif /* USE_UBX_PVT */
  /* CFG-PRT */
 uint8_t setBR[] = {0x01, 0x00, 0x00, 0x00, 0xD0, 0x08, 0x00, 0x00, 0x00, 0x96,
                    0x00, 0x00, 0x07, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00};
@@ -314,6 +320,10 @@ static boolean getUBX_ACK(uint8_t cl, uint8_t id) {
   }
 }
 
+#if defined(USE_UBX_PVT)
+static gnss_id_t ublox_id = GNSS_MODULE_NONE;
+#endif /* USE_UBX_PVT */
+
 static void setup_UBX()
 {
   uint8_t msglen;
@@ -396,6 +406,37 @@ static void setup_UBX()
   }
 
 #endif
+
+#if defined(USE_UBX_PVT)
+  /* NAV-PVT came with protocol version 14, the u-blox 7 */
+  if (ublox_id < GNSS_MODULE_U7 || ublox_id > GNSS_MODULE_U10)
+    return;
+
+  GNSS_DEBUG_PRINTLN(F("Switching on UBX NAV-PVT: "));
+
+  msglen = makeUBXCFG(0x06, 0x01, sizeof(setPVT), setPVT);
+  sendUBX(GNSSbuf, msglen);
+  GNSS_pvt_mode = getUBX_ACK(0x06, 0x01);
+
+  if (!GNSS_pvt_mode) {
+    GNSS_DEBUG_PRINTLN(F("WARNING: Unable to enable UBX NAV-PVT."));
+    return;
+  }
+
+  /* GGA and RMC are made from the fix when an output wants them */
+  GNSS_DEBUG_PRINTLN(F("Switching off NMEA GGA and RMC: "));
+
+  msglen = makeUBXCFG(0x06, 0x01, sizeof(setGGA), setGGA);
+  sendUBX(GNSSbuf, msglen);
+  gnss_set_sucess = getUBX_ACK(0x06, 0x01);
+  msglen = makeUBXCFG(0x06, 0x01, sizeof(setRMC), setRMC);
+  sendUBX(GNSSbuf, msglen);
+  gnss_set_sucess = getUBX_ACK(0x06, 0x01) && gnss_set_sucess;
+
+  if (!gnss_set_sucess) {
+    GNSS_DEBUG_PRINTLN(F("WARNING: Unable to disable NMEA GGA and RMC."));
+  }
+#endif /* USE_UBX_PVT */
 }
 
 /* ------ BEGIN -----------  https://github.com/Black-Thunder/FPV-Tracker */
@@ -565,8 +606,12 @@ static gnss_id_t ublox_probe()
    * ESP8266 NodeMCU and ESP32 DevKit (with NodeMCU adapter)
    * have no any spare GPIO pin to provide GNSS Tx feedback
    */
-  return(hw_info.model == SOFTRF_MODEL_STANDALONE && hw_info.revision == 0 ?
-         GNSS_MODULE_NMEA : (gnss_id_t) ublox_version());
+  gnss_id_t id = (hw_info.model == SOFTRF_MODEL_STANDALONE && hw_info.revision == 0 ?
+                  GNSS_MODULE_NMEA : (gnss_id_t) ublox_version());
+#if defined(USE_UBX_PVT)
+  ublox_id = id;
+#endif /* USE_UBX_PVT */
+  return id;
 }
 
 static bool ublox_setup()
@@ -1201,243 +1246,388 @@ void GNSSTimeSync()
   }
 }
 
-bool Try_GNSS_sentence() {
-    int ndx;
-    bool isValidSentence = gnss.encode(GNSSbuf[GNSS_cnt]);
-    if (GNSSbuf[GNSS_cnt] == '\r' && isValidSentence) {
-      NMEA_Source = DEST_NONE;
-      if (settings->nmea_g || settings->nmea2_g) {
-        for (ndx = GNSS_cnt - 4; ndx >= 0; ndx--) { // jump over CS and *
-          if ((GNSSbuf[ndx] == '$') && (GNSSbuf[ndx+1] == 'G')) {
-            size_t write_size = GNSS_cnt - ndx + 1;   // includes * and CS
-#if 0
-          if (!strncmp((char *) &GNSSbuf[ndx+3], "GGA,", strlen("GGA,"))) {
-            GGA_Stop_Time_Marker = millis();
+/*
+ * The GNSS input is read in blocks: whatever a port has waiting is appended
+ * to GNSSbuf in one go and only the new bytes are searched for line ends.
+ * Every complete line is then handled once, as a whole.
+ */
 
-            Serial.print("GGA Start: ");
-            Serial.print(GGA_Start_Time_Marker);
-            Serial.print(" Stop: ");
-            Serial.print(GGA_Stop_Time_Marker);
-            Serial.print(" gnss.time.age: ");
-            Serial.println(gnss.time.age());
+/* the sentences TinyGPS++ takes fields from: $GPGGA, $GNGGA, $GPRMC, $GNRMC */
+static bool GNSS_parsed_type(const char *s)
+{
+  return s[1] == 'G' && (s[2] == 'P' || s[2] == 'N') &&
+         ((s[3] == 'G' && s[4] == 'G' && s[5] == 'A') ||
+          (s[3] == 'R' && s[4] == 'M' && s[5] == 'C'));
+}
 
-          }
-#endif
-            /*
-             * Work around issue with "always 0.0,M" GGA geoid separation value
-             * given by some Chinese GNSS chipsets
-             */
-            bool is_gga = (write_size>7 && !strncmp((char *) &GNSSbuf[ndx+3], "GGA,", 4));
+static bool GNSS_checksum_ok(const char *s, size_t len)
+{
+  unsigned char cs = 0;
+  size_t i;
+
+  for (i = 1; i < len && s[i] != '*'; i++)
+    cs ^= s[i];
+  if (i + 2 >= len)
+    return false;
+
+  char hex[3] = { s[i+1], s[i+2], '\0' };
+  char *end;
+  return (strtoul(hex, &end, 16) == cs && end == hex + 2);
+}
+
+/* one sentence from '$' up to and including its '\n' */
+static void GNSS_sentence(char *s, size_t len)
+{
+  bool forward = (s[1] == 'G' && (settings->nmea_g || settings->nmea2_g));
+  bool parsed  = (len > 7 && GNSS_parsed_type(s));
+  bool valid   = false;
+
+#if defined(ENABLE_GNSS_STATS)
+  if (parsed) {
+    if (s[3] == 'G') {
+      gnss_stats.gga_time_ms = millis();
+      gnss_stats.gga_count++;
+    } else {
+      gnss_stats.rmc_time_ms = millis();
+      gnss_stats.rmc_count++;
+    }
+  }
+#endif /* ENABLE_GNSS_STATS */
+
+  if (parsed) {
+    for (size_t i = 0; i < len; i++) {
+      if (gnss.encode(s[i]))
+        valid = true;
+    }
+  } else if (forward) {
+    valid = GNSS_checksum_ok(s, len);
+  }
+
+#if defined(USE_NMEA_CFG)
+  if (s[1] == 'P' && s[2] == 'S') {
+    NMEA_Process_SRF_SKV_Sentences(s, len);
+    return;
+  }
+#endif /* USE_NMEA_CFG */
+
+  if (!valid)
+    return;
+
+  NMEA_Source = DEST_NONE;
+  if (!forward)
+    return;
+
+  size_t write_size = len - 1;         /* includes * and CS, not the '\n' */
+  /*
+   * Work around issue with "always 0.0,M" GGA geoid separation value
+   * given by some Chinese GNSS chipsets
+   */
+  bool is_gga = (parsed && s[3] == 'G');
 #if defined(USE_NMEALIB)
-            if (hw_info.model == SOFTRF_MODEL_PRIME_MK2 && is_gga
-                  && gnss.separation.meters() == 0.0) {
-              NMEA_GGA();
-              // GGA is output either directly (below) or indirectly (via NMEA_GGA()) but not both.
-              // Observed on a T-Beam: NMEA_GGA() while no fix, then direct.
-            }
-            else
+  if (hw_info.model == SOFTRF_MODEL_PRIME_MK2 && is_gga
+        && gnss.separation.meters() == 0.0) {
+    NMEA_GGA();
+    // GGA is output either directly (below) or indirectly (via NMEA_GGA()) but not both.
+    // Observed on a T-Beam: NMEA_GGA() while no fix, then direct.
+  }
+  else
 #endif
-            {
-              if (is_gga) {
-                strncpy(GPGGA_Copy, (char*) &GNSSbuf[ndx], write_size);  // for traffic alarm logging
-              }
-              NMEA_Outs(settings->nmea_g, settings->nmea2_g, (char *) &GNSSbuf[ndx], write_size, true);
-            }
-            return true;
-          }
-        }
-      }
+  {
+    if (is_gga) {
+      strncpy(GPGGA_Copy, s, write_size);  // for traffic alarm logging
     }
-    return false;
+    NMEA_Outs(settings->nmea_g, settings->nmea2_g, s, write_size, true);
+  }
 }
 
-void PickGNSSFix()
+/* one line of input, up to and including its '\n' */
+static void GNSS_line(char *line, size_t len)
 {
-  int c = -1;
+  /* start at the last '$', anything before it is a broken sentence */
+  char *s = (char *) memchr(line, '$', len);
+  if (s != NULL) {
+    char *next;
+    while ((next = (char *) memchr(s + 1, '$', line + len - (s + 1))) != NULL)
+      s = next;
+    GNSS_sentence(s, line + len - s);
+    return;
+  }
 
-  if (is_prime_mk2) {
+#if defined(ENABLE_D1090_INPUT)
+  size_t e = len - 1;    /* the '\n' */
+  if (e > 1 && line[e-1] == '\r' && line[e-2] == ';') {
+    int i=0;
 
-    // only use the internal GNSS, leave other ports alone for data bridging
-    while (true) {
-      if (Serial_GNSS_In.available() > 0) {
-       c = Serial_GNSS_In.read();
-      } else {
-        /* return back if no input data */
-        return;
+    if (e > 16 && line[e-17] == '*') {
+      for (i=0; i<14; i++) {
+        if (!isxdigit(line[e-16+i])) break;
       }
-      if (c == -1) {
-        /* retry */
-        continue;
+      if (i>=14) {
+        D1090_Import((uint8_t *) &line[e-17]);
       }
-      if (isPrintable(c) || c == '\r' || c == '\n') {
-        GNSSbuf[GNSS_cnt] = c;
-      } else {
-        /* ignore */
-        continue;
+    } else if (e > 30 && line[e-31] == '*') {
+      for (i=0; i<28; i++) {
+        if (!isxdigit(line[e-30+i])) break;
       }
-      (void) Try_GNSS_sentence();
-      if (GNSSbuf[GNSS_cnt] == '\n' || GNSS_cnt == sizeof(GNSSbuf)-1) {
-        GNSS_cnt = 0;
-      } else {
-        GNSS_cnt++;
-        yield();
+      if (i>=28) {
+        D1090_Import((uint8_t *) &line[e-31]);
       }
-    }        // infinite loop unless !Serial_GNSS_In.available() above
+    }
+  }
+#endif /* ENABLE_D1090_INPUT */
+}
 
+#if defined(USE_UBX_PVT)
+static uint16_t ubx_u2(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t ubx_u4(const uint8_t *p) { return ubx_u2(p) | ((uint32_t) ubx_u2(p+2) << 16); }
+static int32_t ubx_i4(const uint8_t *p) { return (int32_t) ubx_u4(p); }
+
+/* a UBX-NAV-PVT payload, committed as if a GGA and an RMC had come in */
+static void GNSS_ubx_pvt(const uint8_t *p)
+{
+  static uint32_t last_iTOW = 0xFFFFFFFF;
+
+  uint32_t iTOW = ubx_u4(p);
+  if (iTOW == last_iTOW)
     return;
-  }
+  last_iTOW = iTOW;
 
-  // other models:
+  TinyGPSFix fix;
 
   /*
-   * Check SW/HW UARTs, USB and BT for data
-   * WARNING! Make use only one input source at a time.
+   * The time of the epoch is hour, minute, second plus nano. nano may be
+   * a little < 0 when the epoch is rounded to the top of the second; keep
+   * that second rather than borrow one, which at midnight would need the
+   * date stepped back as well.
    */
-   // - note there is nothing here to stop interleaving sentences from different sources!
-  while (true) {
-#if !defined(USE_NMEA_CFG)
-    if (Serial_GNSS_In.available() > 0) {
-      c = Serial_GNSS_In.read();
-    } else if (Serial.available() > 0) {
-      c = Serial.read();
-    } else if (SoC->Bluetooth_ops && SoC->Bluetooth_ops->available() > 0) {
-      c = SoC->Bluetooth_ops->read();
-    } else {
-      /* return back if no input data */
-      break;
-    }
-      /*
-       * Don't forget to disable echo:
-       *
-       * stty raw -echo -F /dev/rfcomm0
-       *
-       * GNSS input becomes garbled otherwise
-       */
+  int32_t nano = ubx_i4(p + 16);
+  uint32_t sec = p[8] * 3600UL + p[9] * 60 + p[10];
+  int32_t cs = nano / 10000000;
+  if (cs < 0)
+    cs = 0;
+  fix.time = ((sec / 3600) * 10000 + (sec / 60 % 60) * 100 + sec % 60) * 100 + cs;
+  fix.date = (p[7] * 100 + p[6]) * 100 + ubx_u2(p + 4) % 100;
+  fix.dateValid = (p[11] & 0x01);
+  fix.timeValid = (p[11] & 0x02);
+
+  uint8_t fixType = p[20];
+  fix.hasFix     = (p[21] & 0x01) && fixType >= 2 && fixType <= 4;
+  fix.quality    = (p[21] & 0x02) ? DGPS : GPS;
+  fix.satellites = p[23];
+  fix.lng        = ubx_i4(p + 24);
+  fix.lat        = ubx_i4(p + 28);
+  fix.altitude   = ubx_i4(p + 36) / 10;
+  fix.separation = (ubx_i4(p + 32) - ubx_i4(p + 36)) / 10;
+  fix.speed      = (int32_t) (((int64_t) ubx_i4(p + 60) * 100000 + 257222) / 514444);
+  fix.course     = ubx_i4(p + 64) / 1000;
+  fix.hdop       = ubx_u2(p + 76);     /* PDOP, NAV-PVT has no HDOP */
+
+  gnss.commit(fix);
 
-      // Serial.write((char) c);
-      /* Ignore Bluetooth input for a while */
-      // break;
-#else
-    /*
-     * Give priority to control channels over default GNSS input source on
-     * 'Dongle', 'Retro', 'Uni', 'Mini', 'Badge', 'Academy' and 'Lego' Editions
-     */
+#if defined(ENABLE_GNSS_STATS)
+  gnss_stats.gga_time_ms = gnss_stats.rmc_time_ms = millis();
+  gnss_stats.gga_count++;
+  gnss_stats.rmc_count++;
+#endif /* ENABLE_GNSS_STATS */
 
-    /* Bluetooth input is first */
-    if (SoC->Bluetooth_ops && SoC->Bluetooth_ops->available() > 0) {
-      c = SoC->Bluetooth_ops->read();
+#if defined(USE_NMEALIB)
+  if (settings->nmea_g || settings->nmea2_g) {
+    NMEA_GGA();
+    NMEA_RMC();
+  }
+#endif /* USE_NMEALIB */
+}
 
-      NMEA_Source = DEST_BLUETOOTH;
+/* length of the UBX frame at p, 0 if it is not all in yet, -1 if not a frame */
+static int GNSS_ubx_frame(const uint8_t *p, size_t n)
+{
+  if (n < 2)
+    return 0;
+  if (p[1] != 0x62)
+    return -1;
+  if (n < 6)
+    return 0;
 
-    /* USB input is second */
-    } else if (SoC->USB_ops && SoC->USB_ops->available() > 0) {
-      c = SoC->USB_ops->read();
+  size_t len = ubx_u2(p + 4);
+  if (len + 8 > sizeof(GNSSbuf))
+    return -1;
+  if (n < len + 8)
+    return 0;
 
-      NMEA_Source = DEST_USB;
+  uint8_t ck_a = 0, ck_b = 0;
+  for (size_t i = 2; i < len + 6; i++) {
+    ck_a += p[i];
+    ck_b += ck_a;
+  }
+  if (ck_a != p[len + 6] || ck_b != p[len + 7])
+    return -1;
 
-#if defined(ARDUINO_NUCLEO_L073RZ)
-      /* This makes possible to configure S76x's built-in SONY GNSS from aside */
-      if (hw_info.model == SOFTRF_MODEL_DONGLE) {
-        Serial_GNSS_Out.write(c);
+  /* 84 bytes from a u-blox 7 (protocol 14), 92 from M8 on */
+  if (p[2] == 0x01 && p[3] == 0x07 && len >= 84)
+    GNSS_ubx_pvt(p + 6);
+  return len + 8;
+}
+#endif /* USE_UBX_PVT */
+
+/* handle the complete lines in GNSSbuf, the bytes from 'from' on are new */
+static void GNSS_lines(size_t from)
+{
+  uint8_t *start = GNSSbuf;
+  uint8_t *end   = GNSSbuf + GNSS_cnt;
+  uint8_t *eol;
+#if defined(USE_UBX_PVT)
+  uint8_t *ubx   = start;             /* where to look for the next UBX sync */
+#endif /* USE_UBX_PVT */
+
+  for (;;) {
+    eol = (uint8_t *) memchr(GNSSbuf + from, '\n', end - (GNSSbuf + from));
+
+#if defined(USE_UBX_PVT)
+    /* binary frames come between the lines and may hold '\n' bytes */
+    uint8_t *sync = NULL;
+    if (GNSS_pvt_mode)
+      sync = (uint8_t *) memchr(ubx, 0xB5, (eol ? eol : end) - ubx);
+    if (sync != NULL) {
+      int n = GNSS_ubx_frame(sync, end - sync);
+      if (n == 0) {
+        start = sync;
+        break;
       }
-#endif
+      if (n < 0) {
+        ubx = sync + 1;
+        continue;
+      }
+      start = ubx = sync + n;
+      if (from < (size_t) (start - GNSSbuf))
+        from = start - GNSSbuf;
+      continue;
+    }
+#endif /* USE_UBX_PVT */
 
-    /* Serial input is third */
-    } else if (SerialOutput.available() > 0) {
-      c = SerialOutput.read();
+    if (eol == NULL)
+      break;
+    GNSS_line((char *) start, eol + 1 - start);
+    start = eol + 1;
+    from  = start - GNSSbuf;
+#if defined(USE_UBX_PVT)
+    ubx   = start;
+#endif /* USE_UBX_PVT */
+  }
 
-      NMEA_Source = DEST_UART;
+  GNSS_cnt = end - start;
+  if (GNSS_cnt == (int) sizeof(GNSSbuf)) {
+    GNSS_cnt = 0;                      /* no line end in a full buffer */
+  } else if (start != GNSSbuf && GNSS_cnt > 0) {
+    memmove(GNSSbuf, start, GNSS_cnt);
+  }
+}
 
-#if 0
-      /* This makes possible to configure HTCC-AB02S built-in GOKE GNSS from aside */
-      if (hw_info.model == SOFTRF_MODEL_MINI) {
-        Serial_GNSS_Out.write(c);
-      }
-#endif
+static size_t GNSS_room()
+{
+  if (GNSS_cnt < 0 || GNSS_cnt >= (int) sizeof(GNSSbuf))
+    GNSS_cnt = 0;
+  return sizeof(GNSSbuf) - GNSS_cnt;
+}
 
-    /* Built-in GNSS input */
-    } else if (Serial_GNSS_In.available() > 0) {
-      c = Serial_GNSS_In.read();
-      NMEA_Source = DEST_NONE;
-    } else {
-      /* return back if no input data */
+/* append what a port has waiting, returns the number of bytes */
+static size_t GNSS_read(Stream &port)
+{
+  int avail = port.available();
+  if (avail <= 0)
+    return 0;
+
+  size_t n = GNSS_room();
+  if ((size_t) avail < n)
+    n = avail;
+  n = port.readBytes((char *) &GNSSbuf[GNSS_cnt], n);
+  GNSS_cnt += n;
+  return n;
+}
+
+static size_t GNSS_read(IODev_ops_t *ops)
+{
+  size_t room = GNSS_room();
+  size_t n = 0;
+
+  while (n < room && ops->available() > 0) {
+    int c = ops->read();
+    if (c == -1)
       break;
-    }
-#endif /* USE_NMEA_CFG */
+    GNSSbuf[GNSS_cnt + n++] = c;
+  }
+  GNSS_cnt += n;
+  return n;
+}
 
-    if (c == -1) {
-      /* retry */
-      continue;
-    }
+void PickGNSSFix()
+{
+  size_t n;
 
-    if (isPrintable(c) || c == '\r' || c == '\n') {
-      GNSSbuf[GNSS_cnt] = c;
-    } else {
-      /* ignore */
-      continue;
-    }
+  while (true) {
 
-#if defined(ENABLE_GNSS_STATS)
-    if ( (GNSS_cnt >= 5) &&
-         (GNSSbuf[GNSS_cnt-5] == '$') &&
-         (GNSSbuf[GNSS_cnt-4] == 'G') &&
-        ((GNSSbuf[GNSS_cnt-3] == 'P') || (GNSSbuf[GNSS_cnt-3] == 'N'))) {
-      if ( (GNSSbuf[GNSS_cnt-2] == 'G') &&
-           (GNSSbuf[GNSS_cnt-1] == 'G') &&
-           (GNSSbuf[GNSS_cnt-0] == 'A')) {
-        gnss_stats.gga_time_ms = millis();
-        gnss_stats.gga_count++;
-      } else if ( (GNSSbuf[GNSS_cnt-2] == 'R') &&
-                  (GNSSbuf[GNSS_cnt-1] == 'M') &&
-                  (GNSSbuf[GNSS_cnt-0] == 'C')) {
-        gnss_stats.rmc_time_ms = millis();
-        gnss_stats.rmc_count++;
-      }
-    }
-#endif /* ENABLE_GNSS_STATS */
+    if (is_prime_mk2) {
+      // only use the internal GNSS, leave other ports alone for data bridging
+      n = GNSS_read(Serial_GNSS_In);
+    } else {
+      /*
+       * Check SW/HW UARTs, USB and BT for data
+       * WARNING! Make use only one input source at a time.
+       */
+      // - note there is nothing here to stop interleaving sentences from different sources!
+#if !defined(USE_NMEA_CFG)
+      n = GNSS_read(Serial_GNSS_In);
+      if (n == 0)
+        n = GNSS_read(Serial);
+      /*
+       * Don't forget to disable echo:
+       *
+       * stty raw -echo -F /dev/rfcomm0
+       *
+       * GNSS input becomes garbled otherwise
+       */
+      if (n == 0 && SoC->Bluetooth_ops)
+        n = GNSS_read(SoC->Bluetooth_ops);
+#else
+      /*
+       * Give priority to control channels over default GNSS input source on
+       * 'Dongle', 'Retro', 'Uni', 'Mini', 'Badge', 'Academy' and 'Lego' Editions
+       */
+      n = 0;
 
-    if (Try_GNSS_sentence()) {
-#if defined(USE_NMEA_CFG)
-      NMEA_Process_SRF_SKV_Sentences();
-#endif /* USE_NMEA_CFG */
-    }
+      /* Bluetooth input is first */
+      if (SoC->Bluetooth_ops && (n = GNSS_read(SoC->Bluetooth_ops)) > 0) {
+        NMEA_Source = DEST_BLUETOOTH;
 
-#if defined(ENABLE_D1090_INPUT)
-    if (GNSSbuf[GNSS_cnt]   == '\n' &&
-        GNSS_cnt             >  1   &&
-        GNSSbuf[GNSS_cnt-1] == '\r' &&
-        GNSSbuf[GNSS_cnt-2] == ';')
-    {
-      int i=0;
+      /* USB input is second */
+      } else if (SoC->USB_ops && (n = GNSS_read(SoC->USB_ops)) > 0) {
+        NMEA_Source = DEST_USB;
 
-      if (GNSS_cnt > 16 && GNSSbuf[GNSS_cnt-17] == '*') {
-        for (i=0; i<14; i++) {
-          if (!isxdigit(GNSSbuf[GNSS_cnt-16+i])) break;
-        }
-        if (i>=14) {
-          D1090_Import(&GNSSbuf[GNSS_cnt-17]);
-          GNSS_cnt -= 18;
-        }
-      } else if (GNSS_cnt > 30 && GNSSbuf[GNSS_cnt-31] == '*') {
-        for (i=0; i<28; i++) {
-          if (!isxdigit(GNSSbuf[GNSS_cnt-30+i])) break;
-        }
-        if (i>=28) {
-          D1090_Import(&GNSSbuf[GNSS_cnt-31]);
-          GNSS_cnt -= 32;
+#if defined(ARDUINO_NUCLEO_L073RZ)
+        /* This makes possible to configure S76x's built-in SONY GNSS from aside */
+        if (hw_info.model == SOFTRF_MODEL_DONGLE) {
+          Serial_GNSS_Out.write(&GNSSbuf[GNSS_cnt - n], n);
         }
+#endif
+
+      /* Serial input is third */
+      } else if ((n = GNSS_read(SerialOutput)) > 0) {
+        NMEA_Source = DEST_UART;
+
+      /* Built-in GNSS input */
+      } else if ((n = GNSS_read(Serial_GNSS_In)) > 0) {
+        NMEA_Source = DEST_NONE;
       }
+#endif /* USE_NMEA_CFG */
     }
-#endif /* ENABLE_D1090_INPUT */
 
-    if (GNSSbuf[GNSS_cnt] == '\n' || GNSS_cnt == sizeof(GNSSbuf)-1) {
-      GNSS_cnt = 0;
-    } else {
-      GNSS_cnt++;
-      yield();
+    if (n == 0) {
+      /* return back if no input data */
+      return;
     }
-  }    // end of while()
 
+    GNSS_lines(GNSS_cnt - n);
+    yield();
+  }
 }
 
 #if !defined(EXCLUDE_EGM96)
@@ -60,6 +60,9 @@ typedef struct gnss_stat_struct {
 
 #define NMEA_EXP_TIME  3500 /* 3.5 seconds */
 
+/* from the navigation epoch to the end of a UBX-NAV-PVT frame at 9600 baud */
+#define UBX_PVT_MS     100
+
 bool isValidGNSSFix  (void);
 byte GNSS_setup      (void);
 void GNSS_loop       (void);
@@ -72,5 +75,6 @@ extern const gnss_chip_ops_t *gnss_chip;  // added
 extern TinyGPSPlus gnss;
 extern volatile unsigned long PPS_TimeMarker;
 extern const char *GNSS_name[];
+extern bool GNSS_pvt_mode;
 
 #endif /* GNSSHELPER_H */
@@ -161,8 +161,9 @@ void LED_DisplayTraffic() {
   if (SOC_GPIO_PIN_LED != SOC_UNUSED_PIN && settings->pointer != LED_OFF) {
     LED_Clear_noflush();
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    for (int n=0; n < Traffic_Count(); n++) {
 
+      int i = traffic_slots[n];
       if (Container[i].addr && (now() - Container[i].timestamp) <= LED_EXPIRATION_TIME) {
 
         bearing  = (int) Container[i].bearing;
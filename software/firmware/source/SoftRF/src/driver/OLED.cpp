@@ -594,7 +594,9 @@ static void OLED_acft()
   static int prev_i = -1;
   static int prev_j = -1;
   if (OLED_display_titles == false)
-      prev_i = -1;                   // inspect Container[0] first
+      prev_i = -1;                   // inspect traffic_slots[0] first
+  if (prev_i >= Traffic_Count())
+      prev_i = -1;                   // table shrank since last time
   if (prev_i < 0)
       OLED_display_titles = false;  // for transition from no-traffic to traffic
 
@@ -603,7 +605,7 @@ static void OLED_acft()
   int i = prev_i + 1;
   int j = 0;
   while (i != prev_i) {
-    if (i >= MAX_TRACKING_OBJECTS) {
+    if (i >= Traffic_Count()) {
         if (prev_i < 0) {
             u8x8->clear();
             u8x8->drawString( 2, 4, "NO TRAFFIC");
@@ -611,12 +613,13 @@ static void OLED_acft()
             OLED_display_titles = true;   // wait until next_ms
             return;
         }
-        i = 0;   // wrap around to the beginning of Container[]
+        i = 0;   // wrap around to the beginning of traffic_slots[]
         j = 0;
     }
     if (i == prev_i)         // only one aircraft to show
         break;
-    if (Container[i].addr && OurTime - Container[i].timestamp < ENTRY_EXPIRATION_TIME) {
+    ufo_t *fop = &Container[traffic_slots[i]];
+    if (fop->addr && OurTime - fop->timestamp < ENTRY_EXPIRATION_TIME) {
         ++j;
         break;              // another aircraft to show
     }
@@ -625,10 +628,11 @@ static void OLED_acft()
 
   int dist;
   char buf[16];
+  ufo_t *fop = &Container[traffic_slots[i]];
 
   if (OLED_display_titles) {
       if (i == prev_i) {
-          dist = (int) (Container[i].distance * 0.001);
+          dist = (int) (fop->distance * 0.001);
           if (dist != prev_dist) {
               snprintf (buf, sizeof(buf), "%d", dist);
               u8x8->drawString(7, 5, "   ");
@@ -659,7 +663,7 @@ static void OLED_acft()
       prev_j = j;
   }
 
-  dist = (int) (Container[i].distance * 0.001);
+  dist = (int) (fop->distance * 0.001);
   if (dist != prev_dist) {
       snprintf (buf, sizeof(buf), "%d", dist);
       u8x8->drawString(7, 5, "   ");
@@ -667,10 +671,10 @@ static void OLED_acft()
       prev_dist = dist;
   }
 
-  snprintf (buf, sizeof(buf), "%06X", Container[i].addr);
+  snprintf (buf, sizeof(buf), "%06X", fop->addr);
   u8x8->drawString(7, 1, buf);
-  u8x8->drawString(7, 3, aircraft_type_lbl[Container[i].aircraft_type]);
-  u8x8->drawString(7, 7, Protocol_ID[Container[i].protocol]);
+  u8x8->drawString(7, 3, aircraft_type_lbl[fop->aircraft_type]);
+  u8x8->drawString(7, 7, Protocol_ID[fop->protocol]);
 }
 #endif /* EXCLUDE_OLED_ACFT_PAGE */
 
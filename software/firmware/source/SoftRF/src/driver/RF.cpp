@@ -52,6 +52,7 @@ uint16_t RF_last_crc = 0;
 
 FreqPlan RF_FreqPlan;
 static bool RF_ready = false;
+static uint32_t RF_OK_until = 0;  /* end of the current Legacy time slot */
 
 static size_t RF_tx_size = 0;
 
@@ -367,6 +368,8 @@ void RF_SetChannel(void)
     } else {
       uint32_t last_RMC_Commit = now_ms - gnss.date.age();
       time_corr_neg = gnss_chip ? gnss_chip->rmc_ms : 100;
+      if (GNSS_pvt_mode)
+        time_corr_neg = UBX_PVT_MS + gnss.time.centisecond() * 10;
       ref_time_ms = last_RMC_Commit - time_corr_neg;
     }
 
@@ -424,6 +427,84 @@ void RF_SetChannel(void)
   }
 }
 
+/*
+ * Slot spans, channels and TX instants of the next few seconds, worked out
+ * from the PPS reference ahead of time. RF_loop() only pops the next entry
+ * at a slot boundary, and RF_Time_To_Event() lets hosted platforms sleep
+ * until then.
+ */
+static Hop_slot_t RF_calendar[RF_CALENDAR_SLOTS];
+static uint8_t    RF_calendar_head  = 0;
+static uint8_t    RF_calendar_count = 0;
+static uint32_t   RF_calendar_epoch = 0;  /* ref_time_ms - 1000 * OurTime planned for */
+static uint8_t    RF_calendar_plan  = RF_BAND_AUTO;
+static time_t     RF_calendar_time;       /* UTC second, */
+static uint32_t   RF_calendar_base;       /* its PPS millis() */
+static uint8_t    RF_calendar_slot;       /* and slot of the next entry */
+
+static void RF_Calendar_fill()
+{
+  uint8_t OGN = (settings->rf_protocol == RF_PROTOCOL_OGNTP ? 1 : 0);
+
+  while (RF_calendar_count < RF_CALENDAR_SLOTS) {
+    Hop_slot_t *hs = &RF_calendar[(RF_calendar_head + RF_calendar_count) %
+                                  RF_CALENDAR_SLOTS];
+
+    /* slot 0 is PPS+300...800 ms, slot 1 is PPS+800...1300 ms */
+    hs->time      = RF_calendar_time;
+    hs->slot      = RF_calendar_slot;
+    hs->chan      = RF_FreqPlan.getChannel(RF_calendar_time, RF_calendar_slot, OGN);
+    if (RF_calendar_slot == 0) {
+      hs->begin_ms  = RF_calendar_base + 300;
+      hs->tx_ms     = RF_calendar_base + 400 + SoC->random(0, 395);
+      hs->tx_end_ms = RF_calendar_base + 795;
+    } else {
+      hs->begin_ms  = RF_calendar_base + 800;
+      hs->tx_ms     = RF_calendar_base + 800 + SoC->random(0, 395);
+      hs->tx_end_ms = RF_calendar_base + 1195;
+    }
+    hs->end_ms    = hs->begin_ms + 500;
+    RF_calendar_count++;
+
+    if (RF_calendar_slot) {
+      RF_calendar_time++;
+      RF_calendar_base += 1000;
+    }
+    RF_calendar_slot ^= 1;
+  }
+}
+
+/* start the calendar with the slot which contains at_ms */
+static void RF_Calendar_plan(uint32_t at_ms)
+{
+  int32_t ms_since_pps = at_ms - ref_time_ms;
+  int32_t seconds      = 0;
+
+  /* the reference may be a second or so stale */
+  while (ms_since_pps >= 1300) {
+    ms_since_pps -= 1000;
+    seconds++;
+  }
+
+  RF_calendar_time = OurTime + seconds;
+  RF_calendar_base = ref_time_ms + 1000 * seconds;
+  RF_calendar_slot = ms_since_pps >= 800 ? 1 : 0;
+
+  if (ms_since_pps < 300) {
+    /* channel does _NOT_ change at PPS rollover in middle of slot 1 */
+    /* - therefore it belongs to the previous second */
+    RF_calendar_time--;
+    RF_calendar_base -= 1000;
+    RF_calendar_slot = 1;
+  }
+
+  RF_calendar_epoch = ref_time_ms - 1000 * (uint32_t) OurTime;
+  RF_calendar_plan  = RF_FreqPlan.Plan;
+  RF_calendar_head  = 0;
+  RF_calendar_count = 0;
+  RF_Calendar_fill();
+}
+
 void RF_loop()
 {
   if (!RF_ready) {
@@ -453,74 +534,96 @@ void RF_loop()
   if (ref_time_ms == 0)   /* no GNSS time yet */
     return;
 
-  /* internal state variables to save CPU cycles */
-  static uint32_t RF_OK_until = 0;
-  //static uint8_t RF_current_slot = 0;  - now an external variable
-  static uint8_t current_chan = 0;
-
   uint32_t now_ms = millis();
-  if (now_ms < RF_OK_until) {   /* channel already computed */
-    if (rf_chip)
-      rf_chip->channel(current_chan);
-    return;
+  int32_t  drift  = (ref_time_ms - 1000 * (uint32_t) OurTime) - RF_calendar_epoch;
+
+  if (RF_calendar_count == 0 || RF_calendar_plan != RF_FreqPlan.Plan ||
+      drift > RF_CALENDAR_SLACK_MS || drift < -RF_CALENDAR_SLACK_MS) {
+    /* new PPS reference - keep the slot under way, replan from the next one */
+    RF_Calendar_plan((int32_t) (RF_OK_until - now_ms) > 0 ?
+                     RF_OK_until + 250 : now_ms);
   }
 
-  RF_time = OurTime;    // can use now()?
+  if ((int32_t) (now_ms - RF_OK_until) < 0) {
+    return;   /* channel already set for this slot */
+  }
 
-  int ms_since_pps = now_ms - ref_time_ms;
-  if (ms_since_pps < 0) {   /* should not happen */
-    --OurTime;
-    ref_time_ms -= 1000;
-    return;
+  while (RF_calendar_count > 0 &&
+         (int32_t) (now_ms - RF_calendar[RF_calendar_head].end_ms) >= 0) {
+    RF_calendar_head = (RF_calendar_head + 1) % RF_CALENDAR_SLOTS;
+    RF_calendar_count--;
   }
-  if (ms_since_pps >= 1300) {   /* should not happen */
-    ++OurTime;
-    ref_time_ms += 1000;
-    return;
+  if (RF_calendar_count == 0) {   /* loop was stalled for seconds */
+    RF_Calendar_plan(now_ms);
   }
 
-  uint32_t slot_base_ms = ref_time_ms;
-  if (ms_since_pps < 300) {  /* does not happen often, since normally RF_OK_until 300 */
-    /* channel does _NOT_ change at PPS rollover in middle of slot 1 */
-    /* - therefore change reference second to the previous one: */
-    --RF_time;
-    slot_base_ms -= 1000;
-    ms_since_pps += 1000;
+  Hop_slot_t *hs = &RF_calendar[RF_calendar_head];
+
+  if ((int32_t) (now_ms - hs->begin_ms) < 0) {  /* between slots after a replan */
+    RF_OK_until  = hs->begin_ms;
+    TxTimeMarker = RF_OK_until;  /* do not transmit for now */
+    TxEndMarker  = RF_OK_until;
+    return;
   }
 
-  if (ms_since_pps >= 300 && ms_since_pps < 800) {
+  RF_time         = hs->time;
+  RF_current_slot = hs->slot;
+  RF_OK_until     = hs->end_ms;
+  TxTimeMarker    = hs->tx_ms;
+  TxEndMarker     = hs->tx_end_ms;
 
-    RF_current_slot = 0;
-    RF_OK_until = slot_base_ms + 800;
-    TxTimeMarker = slot_base_ms + 400 + SoC->random(0, 395);
-    TxEndMarker  = slot_base_ms + 795;
+  uint8_t chan = hs->chan;
 
-  } else if (ms_since_pps >= 800 && ms_since_pps < 1300) {
+  RF_calendar_head = (RF_calendar_head + 1) % RF_CALENDAR_SLOTS;
+  RF_calendar_count--;
+  RF_Calendar_fill();
 
-    RF_current_slot = 1;
-    /* channel does _NOT_ change at PPS rollover in middle of slot 1 */
-    RF_OK_until = slot_base_ms + 1300;
-    TxTimeMarker = slot_base_ms + 800 + SoC->random(0, 395);
-    TxEndMarker  = slot_base_ms + 1195;
+  if (rf_chip)
+    rf_chip->channel(chan);
 
-  } else { /* shouldn't happen */
+//Serial.printf("Chan %d, Slot %d at PPS+%d ms, tx ok %d - %d, gd to %d\r\n",
+//chan, RF_current_slot, now_ms - ref_time_ms, TxTimeMarker, TxEndMarker, RF_OK_until);
+}
 
-    RF_current_slot = 0;
-    RF_OK_until = ref_time_ms + 1400;
-    TxTimeMarker = RF_OK_until;  /* do not transmit for now */
-    TxEndMarker  = RF_OK_until;
+/*
+ * Milliseconds until RF_loop() or RF_Transmit() next have work to do
+ * (time slot boundary or TX instant), but no more than max_ms.
+ * Lets hosted platforms sleep between events instead of spinning.
+ */
+uint32_t RF_Time_To_Event(uint32_t max_ms)
+{
+  uint32_t now_ms = millis();
+  uint32_t next_ms = now_ms + max_ms;
 
+  if (!RF_ready) {
+    return max_ms;
   }
 
-  uint8_t OGN = (settings->rf_protocol == RF_PROTOCOL_OGNTP ? 1 : 0);
-
-  current_chan = RF_FreqPlan.getChannel((time_t)RF_time, RF_current_slot, OGN);
-
-  if (rf_chip)
-    rf_chip->channel(current_chan);
+  if (settings->rf_protocol == RF_PROTOCOL_LEGACY ||
+      settings->rf_protocol == RF_PROTOCOL_LATEST ||
+      settings->rf_protocol == RF_PROTOCOL_OGNTP) {
+    if (ref_time_ms == 0) {
+      return max_ms;
+    }
+    if ((int32_t) (RF_OK_until - now_ms) > 0 &&
+        (int32_t) (RF_OK_until - next_ms) < 0) {
+      next_ms = RF_OK_until;
+    }
+    if ((int32_t) (TxTimeMarker - now_ms)  > 0 &&
+        (int32_t) (TxTimeMarker - next_ms) < 0 &&
+        (int32_t) (TxTimeMarker - TxEndMarker) < 0) {
+      next_ms = TxTimeMarker;
+    }
+  } else {
+    /* RF_Transmit() fires once millis() exceeds the marker */
+    uint32_t tx_ms = TxTimeMarker + 1;
+    if ((int32_t) (tx_ms - now_ms)  > 0 &&
+        (int32_t) (tx_ms - next_ms) < 0) {
+      next_ms = tx_ms;
+    }
+  }
 
-//Serial.printf("Chan %d, Slot %d at PPS+%d ms, tx ok %d - %d, gd to %d\r\n",
-//current_chan, RF_current_slot, ms_since_pps, TxTimeMarker, TxEndMarker, RF_OK_until);
+  return next_ms - now_ms;
 }
 
 size_t RF_Encode(ufo_t *fop)
@@ -1221,11 +1324,29 @@ static void sx12xx_rx(osjobcb_t func) {
   //Serial.println("RX");
 }
 
+/* undo NiceRF whitening in place, a 32-bit word at a time */
+static void sx12xx_dewhiten(u1_t *buf, u1_t size)
+{
+  u1_t i = 0;
+
+  for (; i + 4 <= size; i += 4) {
+    uint32_t w;
+
+    memcpy(&w, buf + i, sizeof(w));
+    w ^= pgm_read_dword(&whitening_pattern[i]);
+    memcpy(buf + i, &w, sizeof(w));
+  }
+
+  for (; i < size; i++) {
+    buf[i] ^= pgm_read_byte(&whitening_pattern[i]);
+  }
+}
+
 static void sx12xx_rx_func (osjob_t* job) {
 
   u1_t crc8, pkt_crc8;
   u2_t crc16, pkt_crc16;
-  u1_t i;
+  u1_t i, size;
 
   // SX1276 is in SLEEP after IRQ handler, Force it to enter RX mode
   sx12xx_receive_active = false;
@@ -1272,41 +1393,39 @@ static void sx12xx_rx_func (osjob_t* job) {
     break;
   }
 
-  for (i = LMIC.protocol->payload_offset;
-       i < (LMIC.dataLen - LMIC.protocol->crc_size);
-       i++)
-  {
+  i    = LMIC.protocol->payload_offset;
+  size = LMIC.dataLen > i + LMIC.protocol->crc_size ?
+         LMIC.dataLen - i - LMIC.protocol->crc_size : 0;
 
-    switch (LMIC.protocol->crc_type)
-    {
-    case RF_CHECKSUM_TYPE_GALLAGER:
-    case RF_CHECKSUM_TYPE_NONE:
-      break;
-    case RF_CHECKSUM_TYPE_CRC8_107:
-      update_crc8(&crc8, (u1_t)(LMIC.frame[i]));
-      break;
-    case RF_CHECKSUM_TYPE_CCITT_FFFF:
-    case RF_CHECKSUM_TYPE_CCITT_0000:
-    default:
-      crc16 = update_crc_ccitt(crc16, (u1_t)(LMIC.frame[i]));
-      break;
+  /* CRC is taken over the payload as it was on air, before de-whitening */
+  switch (LMIC.protocol->crc_type)
+  {
+  case RF_CHECKSUM_TYPE_GALLAGER:
+  case RF_CHECKSUM_TYPE_NONE:
+    break;
+  case RF_CHECKSUM_TYPE_CRC8_107:
+    for (u1_t j = 0; j < size; j++) {
+      update_crc8(&crc8, (u1_t)(LMIC.frame[i + j]));
     }
+    break;
+  case RF_CHECKSUM_TYPE_CCITT_FFFF:
+  case RF_CHECKSUM_TYPE_CCITT_0000:
+  default:
+    crc16 = crc_ccitt_block(crc16, &LMIC.frame[i], size);
+    break;
+  }
 
-    switch (LMIC.protocol->whitening)
-    {
-    case RF_WHITENING_NICERF:
-      LMIC.frame[i] ^= pgm_read_byte(&whitening_pattern[i - LMIC.protocol->payload_offset]);
-      break;
-    case RF_WHITENING_MANCHESTER:
-    case RF_WHITENING_NONE:
-    default:
-      break;
-    }
+  if (LMIC.protocol->whitening == RF_WHITENING_NICERF) {
+    sx12xx_dewhiten(&LMIC.frame[i], size);
+  }
 
 #if DEBUG
-    Serial.printf("%02x", (u1_t)(LMIC.frame[i]));
-#endif
+  for (u1_t j = 0; j < size; j++) {
+    Serial.printf("%02x", (u1_t)(LMIC.frame[i + j]));
   }
+#endif
+
+  i += size;
 
   switch (LMIC.protocol->crc_type)
   {
@@ -1314,7 +1433,12 @@ static void sx12xx_rx_func (osjob_t* job) {
     sx12xx_receive_complete = true;
     break;
   case RF_CHECKSUM_TYPE_GALLAGER:
-    if (LDPC_Check((uint8_t  *) &LMIC.frame[0])) {
+    if (LDPC_Check((uint8_t  *) &LMIC.frame[0])
+#if defined(USE_LDPC_REPAIR)
+        /* weak OGNTP frames: let the soft decoder fix a few bit errors */
+        && ogntp_repair((uint8_t  *) &LMIC.frame[0]) < 0
+#endif /* USE_LDPC_REPAIR */
+       ) {
 #if DEBUG
       Serial.printf(" %02x%02x%02x%02x%02x%02x is wrong FEC",
         LMIC.frame[i], LMIC.frame[i+1], LMIC.frame[i+2],
@@ -2334,6 +2458,10 @@ static bool ognrf_receive()
     TRX.ReadPacket(RxBuffer, Err);
     if (LDPC_Check((uint8_t  *) RxBuffer) == 0) {
       success = true;
+#if defined(USE_LDPC_REPAIR)
+    } else if (ogntp_repair((uint8_t  *) RxBuffer, Err) >= 0) {
+      success = true;
+#endif /* USE_LDPC_REPAIR */
     }
   }
 
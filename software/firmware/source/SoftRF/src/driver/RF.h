@@ -107,12 +107,27 @@ typedef struct Slots_descr_struct {
   uint8_t       current;
 } Slots_descr_t;
 
+/* Legacy/Latest/OGNTP hopping calendar: two 500 ms slots per second */
+#define RF_CALENDAR_SLOTS     8   /* 4 seconds ahead */
+#define RF_CALENDAR_SLACK_MS  3   /* PPS jitter tolerated before a replan */
+
+typedef struct Hop_slot_struct {
+  time_t        time;             /* UTC second the slot belongs to */
+  uint32_t      begin_ms;         /* millis() span of the slot */
+  uint32_t      end_ms;
+  uint32_t      tx_ms;            /* randomized TX window */
+  uint32_t      tx_end_ms;
+  uint8_t       slot;
+  uint8_t       chan;
+} Hop_slot_t;
+
 String Bin2Hex(byte *, size_t);
 uint8_t parity(uint32_t);
 
 byte    RF_setup(void);
 void    RF_SetChannel(void);
 void    RF_loop(void);
+uint32_t RF_Time_To_Event(uint32_t);
 size_t  RF_Encode(ufo_t *);
 bool    RF_Transmit_Ready();
 bool    RF_Transmit(size_t, bool);
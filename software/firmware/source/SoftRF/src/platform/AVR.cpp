@@ -560,6 +560,18 @@ static size_t AVR_USB_write(const uint8_t *buffer, size_t size)
   return rval;
 }
 
+/* how much write() takes now in one piece, it drops a larger block whole */
+static size_t AVR_USB_room()
+{
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+}
+
 IODev_ops_t AVR_USBSerial_ops = {
   "AVR USBSerial",
   AVR_USB_setup,
@@ -567,7 +579,8 @@ IODev_ops_t AVR_USBSerial_ops = {
   AVR_USB_fini,
   AVR_USB_available,
   AVR_USB_read,
-  AVR_USB_write
+  AVR_USB_write,
+  AVR_USB_room
 };
 
 const SoC_ops_t AVR_ops = {
@@ -189,6 +189,7 @@ char UDPpacketBuffer[UDP_PACKET_BUFSIZE];
 #include <Adafruit_SPIFlash.h>
 #include "../driver/EPD.h"
 #include "uCDB.hpp"
+#include "../system/ADB.h"
 
 SPIClass uSD_SPI(HSPI);
 SdFat    uSD(&uSD_SPI);
@@ -248,6 +249,54 @@ ui_settings_t ui_settings = {
 ui_settings_t *ui;
 uCDB<FatFileSystem, File> ucdb(fatfs);
 
+static File  adb_file;
+static adb_t ogn_adb;
+static bool  ADB_is_hashed      = false;   /* ogn.adb rather than ogn.cdb */
+
+static bool ESP32_ADB_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+  File *file = (File *) ctx;
+
+  return file->seek(offset) && file->read((uint8_t *) buf, len) == (int) len;
+}
+
+/* type, registration and CN of an aircraft, false if it is not in the DB */
+static bool ESP32_ADB_record(uint32_t id, adb_record_t *rec)
+{
+  char key[8];
+  char out[64];
+  uint8_t tokens[3] = { 0 };
+  int c, i = 0, token_cnt = 0;
+
+  if (ADB_is_hashed) {
+    return ADB_find(&ogn_adb, id, rec);
+  }
+
+  snprintf(key, sizeof(key),"%06X", id);
+
+  if (ucdb.findKey(key, strlen(key)) != KEY_FOUND) {
+    return false;
+  }
+
+  while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
+    if (c == '|') {
+      if (token_cnt < (sizeof(tokens) - 1)) {
+        token_cnt++;
+        tokens[token_cnt] = i+1;
+      }
+      c = 0;
+    }
+    out[i++] = (char) c;
+  }
+  out[i] = 0;
+
+  snprintf(rec->type, sizeof(rec->type), "%s", out + tokens[0]);
+  snprintf(rec->reg,  sizeof(rec->reg),  "%s", out + tokens[1]);
+  snprintf(rec->cn,   sizeof(rec->cn),   "%s", out + tokens[2]);
+
+  return true;
+}
+
 #if CONFIG_TINYUSB_MSC_ENABLED
 #if defined(USE_ADAFRUIT_MSC)
 // Callback invoked when received READ10 command.
@@ -1162,11 +1211,7 @@ static void ESP32_post_init()
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
     if (hw_info.model == SOFTRF_MODEL_PRIME_MK3)
     {
-      char key[8];
-      char out[64];
-      uint8_t tokens[3] = { 0 };
-      cdbResult rt;
-      int c, i = 0, token_cnt = 0;
+      adb_record_t rec;
 
       int acfts;
       char *reg, *mam, *cn;
@@ -1175,35 +1220,12 @@ static void ESP32_post_init()
       OLED_info2();
 
       if (ADB_is_open) {
-        acfts = ucdb.recordsNumber();
-
-        snprintf(key, sizeof(key),"%06X", ThisAircraft.addr);
-
-        rt = ucdb.findKey(key, strlen(key));
-
-        switch (rt) {
-          case KEY_FOUND:
-            while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
-              if (c == '|') {
-                if (token_cnt < (sizeof(tokens) - 1)) {
-                  token_cnt++;
-                  tokens[token_cnt] = i+1;
-                }
-                c = 0;
-              }
-              out[i++] = (char) c;
-            }
-            out[i] = 0;
+        acfts = ADB_is_hashed ? ogn_adb.hdr.records : ucdb.recordsNumber();
 
-            reg = out + tokens[1];
-            mam = out + tokens[0];
-            cn  = out + tokens[2];
-
-            break;
-
-          case KEY_NOT_FOUND:
-          default:
-            break;
+        if (ESP32_ADB_record(ThisAircraft.addr, &rec)) {
+          reg = rec.reg;
+          mam = rec.type;
+          cn  = rec.cn;
         }
 
         reg = (reg != NULL) && strlen(reg) ? reg : (char *) "REG: N/A";
@@ -2844,7 +2866,8 @@ static void ESP32_Button_fini()
 
 #if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3)
 
-#define USB_TX_FIFO_SIZE (MAX_TRACKING_OBJECTS * 65 + 75 + 75 + 42 + 20)
+/* one NMEA output burst: a PFLAA for each reported object + own-ship sentences */
+#define USB_TX_FIFO_SIZE (MAX_NMEA_OBJECTS * 65 + 75 + 75 + 42 + 20)
 #define USB_RX_FIFO_SIZE (256)
 
 #if defined(USE_USB_HOST)
@@ -2989,6 +3012,11 @@ static size_t ESP32S2_USB_write(const uint8_t *buffer, size_t size)
   return rval;
 }
 
+static size_t ESP32S2_USB_room()
+{
+  return USB_TX_FIFO->room();
+}
+
 #elif ARDUINO_USB_CDC_ON_BOOT
 
 #define USE_ASYNC_USB_OUTPUT
@@ -3080,6 +3108,24 @@ static size_t ESP32S2_USB_write(const uint8_t *buffer, size_t size)
 
   return rval;
 }
+
+/* how much write() takes now in one piece, HWCDC drops a larger block whole */
+static size_t ESP32S2_USB_room()
+{
+#if ARDUINO_USB_MODE
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+#elif defined(USE_ASYNC_USB_OUTPUT)
+  return USB_TX_FIFO->room();
+#else
+  return (size_t) -1;
+#endif /* ARDUINO_USB_MODE */
+}
 #endif /* USE_USB_HOST || ARDUINO_USB_CDC_ON_BOOT */
 
 #if ARDUINO_USB_CDC_ON_BOOT || defined(USE_USB_HOST)
@@ -3090,7 +3136,8 @@ IODev_ops_t ESP32S2_USBSerial_ops = {
   ESP32S2_USB_fini,
   ESP32S2_USB_available,
   ESP32S2_USB_read,
-  ESP32S2_USB_write
+  ESP32S2_USB_write,
+  ESP32S2_USB_room
 };
 #endif /* USE_USB_HOST || ARDUINO_USB_CDC_ON_BOOT */
 #endif /* CONFIG_IDF_TARGET_ESP32S2 */
@@ -3099,6 +3146,21 @@ IODev_ops_t ESP32S2_USBSerial_ops = {
 static bool ESP32_ADB_setup()
 {
   if (FATFS_is_mounted) {
+    const char adbName[] = "/Aircrafts/ogn.adb";
+
+    if (fatfs.exists(adbName)) {
+      adb_file = fatfs.open(adbName);
+      if (adb_file && ADB_open(&ogn_adb, ESP32_ADB_read, &adb_file)) {
+        ADB_is_hashed = ADB_is_open = true;
+        return ADB_is_open;
+      }
+      Serial.print("Invalid ADB: ");
+      Serial.println(adbName);
+      if (adb_file) {
+        adb_file.close();
+      }
+    }
+
     const char fileName[] = "/Aircrafts/ogn.cdb";
 
     if (ucdb.open(fileName) != CDB_OK) {
@@ -3115,7 +3177,12 @@ static bool ESP32_ADB_setup()
 static bool ESP32_ADB_fini()
 {
   if (ADB_is_open) {
-    ucdb.close();
+    if (ADB_is_hashed) {
+      adb_file.close();
+      ADB_is_hashed = false;
+    } else {
+      ucdb.close();
+    }
     ADB_is_open = false;
   }
 
@@ -3123,67 +3190,37 @@ static bool ESP32_ADB_fini()
 }
 
 /*
+ * One aircraft ADB query reads one bucket seed and one record.
  * One aircraft CDB (20000+ records) query takes:
  * 1)     FOUND : xxx milliseconds
  * 2) NOT FOUND : xxx milliseconds
  */
 static bool ESP32_ADB_query(uint8_t type, uint32_t id, char *buf, size_t size)
 {
-  char key[8];
-  char out[64];
-  uint8_t tokens[3] = { 0 };
-  cdbResult rt;
-  int c, i = 0, token_cnt = 0;
-  bool rval = false;
+  adb_record_t rec;
 
-  if (!ADB_is_open) {
-    return rval;
+  if (!ADB_is_open || !ESP32_ADB_record(id, &rec)) {
+    return false;
   }
 
-  snprintf(key, sizeof(key),"%06X", id);
-
-  rt = ucdb.findKey(key, strlen(key));
-
-  switch (rt) {
-    case KEY_FOUND:
-      while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
-        if (c == '|') {
-          if (token_cnt < (sizeof(tokens) - 1)) {
-            token_cnt++;
-            tokens[token_cnt] = i+1;
-          }
-          c = 0;
-        }
-        out[i++] = (char) c;
-      }
-      out[i] = 0;
-
-      switch (ui->idpref)
-      {
-      case ID_TAIL:
-        snprintf(buf, size, "CN: %s",
-          strlen(out + tokens[2]) ? out + tokens[2] : "N/A");
-        break;
-      case ID_MAM:
-        snprintf(buf, size, "%s",
-          strlen(out + tokens[0]) ? out + tokens[0] : "Unknown");
-        break;
-      case ID_REG:
-      default:
-        snprintf(buf, size, "%s",
-          strlen(out + tokens[1]) ? out + tokens[1] : "REG: N/A");
-        break;
-      }
-
-      rval = true;
-      break;
-
-    case KEY_NOT_FOUND:
-    default:
-      break;
+  switch (ui->idpref)
+  {
+  case ID_TAIL:
+    snprintf(buf, size, "CN: %s",
+      strlen(rec.cn) ? rec.cn : "N/A");
+    break;
+  case ID_MAM:
+    snprintf(buf, size, "%s",
+      strlen(rec.type) ? rec.type : "Unknown");
+    break;
+  case ID_REG:
+  default:
+    snprintf(buf, size, "%s",
+      strlen(rec.reg) ? rec.reg : "REG: N/A");
+    break;
   }
 
-  return rval;
+  return true;
 }
 
 DB_ops_t ESP32_ADB_ops = {
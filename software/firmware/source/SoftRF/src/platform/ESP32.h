@@ -30,8 +30,11 @@
 #include <SPIFFS.h>
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
-#define MAX_TRACKING_OBJECTS    8
+#if !defined(MAX_TRACKING_OBJECTS)
+#define MAX_TRACKING_OBJECTS    100
+#endif
 #define MAX_NMEA_OBJECTS        6
+#define NMEA_QUEUE_SIZE         1024    /* per NMEA output */
 
 #define DEFAULT_SOFTRF_MODEL    SOFTRF_MODEL_STANDALONE
 
@@ -448,6 +451,9 @@ struct rst_info {
 #define USE_NMEA_CFG
 #define USE_BASICMAC
 #define USE_TIME_SLOTS
+#define USE_PROFILER
+/* own-ship fixes from UBX-NAV-PVT on u-blox 7 and later, GGA/RMC made only for outputs */
+//#define USE_UBX_PVT
 
 /* Experimental */
 //#define USE_BLE_MIDI
@@ -530,6 +530,18 @@ static size_t LPC43_USB_write(const uint8_t *buffer, size_t size)
   return rval;
 }
 
+/* how much write() takes now in one piece, it drops a larger block whole */
+static size_t LPC43_USB_room()
+{
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+}
+
 IODev_ops_t LPC43_USBSerial_ops = {
   "LPC43 USBSerial",
   LPC43_USB_setup,
@@ -537,7 +549,8 @@ IODev_ops_t LPC43_USBSerial_ops = {
   LPC43_USB_fini,
   LPC43_USB_available,
   LPC43_USB_read,
-  LPC43_USB_write
+  LPC43_USB_write,
+  LPC43_USB_room
 };
 
 const SoC_ops_t LPC43_ops = {
@@ -23,6 +23,7 @@
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
 #define MAX_TRACKING_OBJECTS  8
+#define NMEA_QUEUE_SIZE       1024    /* per NMEA output */
 
 #define DEFAULT_SOFTRF_MODEL  SOFTRF_MODEL_ES
 #define PLAT_LPC43_NAME       "LPC43"
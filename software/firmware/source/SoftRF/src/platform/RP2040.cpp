@@ -1010,6 +1010,22 @@ static size_t RP2040_USB_write(const uint8_t *buffer, size_t size)
 #endif /* USE_TINYUSB */
 }
 
+/* how much write() takes now in one piece, it drops a larger block whole */
+static size_t RP2040_USB_room()
+{
+#if !defined(USE_TINYUSB)
+  return (size_t) -1;     /* write() stores what fits in USB_TX_FIFO */
+#else
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+#endif /* USE_TINYUSB */
+}
+
 #if defined(USE_USB_HOST)
 /*********************************************************************
  Adafruit invests time and resources providing this open source code,
@@ -1188,7 +1204,8 @@ IODev_ops_t RP2040_USBSerial_ops = {
   RP2040_USB_fini,
   RP2040_USB_available,
   RP2040_USB_read,
-  RP2040_USB_write
+  RP2040_USB_write,
+  RP2040_USB_room
 };
 
 const SoC_ops_t RP2040_ops = {
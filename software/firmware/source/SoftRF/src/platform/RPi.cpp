@@ -64,11 +64,14 @@
 #include "../driver/Battery.h"
 #include "../driver/Bluetooth.h"
 #include "../system/Time.h"
+#include "../system/Profile.h"
 
-#include "TCPServer.h"
+#include "IngestServer.h"
 
 #include <stdio.h>
-#include <sys/select.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 
 #include <iostream>
 
@@ -146,7 +149,26 @@ unsigned long ExportTimeMarker = 0;
 
 std::string input_line;
 
-TCPServer Traffic_TCP_Server;
+/*
+ * The radio IRQ flags are read over SPI (no DIO line is wired in the
+ * default pin map), so the main loop still has to look at the radio
+ * this often while it is otherwise idle.
+ */
+#if !defined(RPI_RADIO_POLL_MS)
+#define RPI_RADIO_POLL_MS     4
+#endif
+
+#define RPI_MAX_EVENTS        4
+#define RPI_INPUT_BUF_SIZE    4096
+
+static int RPi_epoll_fd = -1;
+static int RPi_timer_fd = -1;
+
+static bool stdin_ready   = false;
+static bool stdin_pollable = true;  /* false for regular files */
+static bool stdin_eof     = false;
+
+IngestServer Traffic_TCP_Server;
 
 #if defined(USE_EPAPER)
 GxEPD2_BW<GxEPD2_270, GxEPD2_270::HEIGHT> __attribute__ ((common)) epd_waveshare(GxEPD2_270(/*CS=5*/ 8,
@@ -570,16 +592,119 @@ const SoC_ops_t RPi_ops = {
   NULL
 };
 
-static bool inputAvailable()
+static void RPi_Events_setup()
+{
+  struct epoll_event ev;
+
+  RPi_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  RPi_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+  if (RPi_epoll_fd < 0 || RPi_timer_fd < 0) {
+    fprintf( stderr, "epoll/timerfd setup Failed\n\n" );
+    exit(EXIT_FAILURE);
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events  = EPOLLIN;
+  ev.data.fd = RPi_timer_fd;
+  epoll_ctl(RPi_epoll_fd, EPOLL_CTL_ADD, RPi_timer_fd, &ev);
+
+  ev.data.fd = Traffic_TCP_Server.eventFd();
+  epoll_ctl(RPi_epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+
+  ev.data.fd = STDIN_FILENO;
+  if (epoll_ctl(RPi_epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &ev) < 0) {
+    /* stdin redirected from a regular file - it is always readable */
+    stdin_pollable = false;
+  }
+}
+
+/*
+ * Sleep until there is something to do: input on stdin, a frame from
+ * the traffic server, the next RF time slot boundary or TX instant,
+ * or the radio poll interval.
+ */
+static void RPi_Events_wait()
 {
-  struct timeval tv;
-  fd_set fds;
-  tv.tv_sec = 0;
-  tv.tv_usec = 0;
-  FD_ZERO(&fds);
-  FD_SET(STDIN_FILENO, &fds);
-  select(STDIN_FILENO+1, &fds, NULL, NULL, &tv);
-  return (FD_ISSET(0, &fds));
+  struct epoll_event events[RPI_MAX_EVENTS];
+  struct itimerspec its;
+
+  if (!stdin_pollable && !stdin_eof) {
+    stdin_ready = true;
+    return;
+  }
+
+  uint32_t wait_ms = RF_Time_To_Event(RPI_RADIO_POLL_MS);
+  if (wait_ms == 0) {
+    return;
+  }
+
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec  = wait_ms / 1000;
+  its.it_value.tv_nsec = (wait_ms % 1000) * 1000000L;
+  timerfd_settime(RPi_timer_fd, 0, &its, NULL);
+
+  int n = epoll_wait(RPi_epoll_fd, events, RPI_MAX_EVENTS, -1);
+
+  for (int i = 0; i < n; i++) {
+    if (events[i].data.fd == STDIN_FILENO) {
+      stdin_ready = true;
+    } else if (events[i].data.fd == RPi_timer_fd) {
+      uint64_t expirations;
+      if (read(RPi_timer_fd, &expirations, sizeof(expirations)) < 0) {
+        /* EAGAIN - timer was re-armed before it fired */
+      }
+    } else {
+      /* traffic frames are drained by RPi_ReadTraffic() */
+      Traffic_TCP_Server.clearEvent();
+    }
+  }
+}
+
+/*
+ * Take whatever is pending on stdin in one read() and hand back
+ * complete lines one by one, so that a burst of several sentences
+ * is consumed in a single loop pass.
+ */
+static bool RPi_ReadInputLine(std::string &line)
+{
+  static char   buf[RPI_INPUT_BUF_SIZE];
+  static size_t buf_len = 0;
+
+  if (stdin_ready) {
+    stdin_ready = false;
+
+    if (buf_len == sizeof(buf)) {
+      buf_len = 0;  /* line too long - drop it */
+    }
+
+    ssize_t len = read(STDIN_FILENO, buf + buf_len, sizeof(buf) - buf_len);
+    if (len > 0) {
+      buf_len += len;
+    } else if (len == 0) {
+      stdin_eof = true;
+      if (stdin_pollable) {
+        epoll_ctl(RPi_epoll_fd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+      }
+    }
+  }
+
+  char *eol = (char *) memchr(buf, '\n', buf_len);
+  if (eol == NULL) {
+    return false;
+  }
+
+  size_t line_len = eol - buf;
+  if (line_len > 0 && buf[line_len - 1] == '\r') {
+    line.assign(buf, line_len - 1);
+  } else {
+    line.assign(buf, line_len);
+  }
+
+  buf_len -= line_len + 1;
+  memmove(buf, eol + 1, buf_len);
+
+  return true;
 }
 
 static void parseNMEA(const char *str, int len)
@@ -619,8 +744,7 @@ static void parseNMEA(const char *str, int len)
 
 static void RPi_PickGNSSFix()
 {
-  if (inputAvailable()) {
-    std::getline(std::cin, input_line);
+  while (RPi_ReadInputLine(input_line)) {
     const char *str = input_line.c_str();
     int len = input_line.length();
 
@@ -631,6 +755,11 @@ static void RPi_PickGNSSFix()
     } else if (str[0] == '{') {
       // JSON input
 
+      /* 'aircraft.json' from 'dump1090' or uAvionix PingStation */
+      if (parseAircraft(str, len)) {
+        continue;
+      }
+
       deserializeJson(jsonDoc, str);
       JsonObject root = jsonDoc.as<JsonObject>();
 
@@ -649,16 +778,6 @@ static void RPi_PickGNSSFix()
         }
       }
 
-      if (root.containsKey("now") &&
-          root.containsKey("messages") &&
-          root.containsKey("aircraft")) {
-        /* 'aircraft.json' output from 'dump1090' application */
-        parseD1090(root);
-      } else if (root.containsKey("aircraft")) {
-        /* uAvionix PingStation */
-        parsePING(root);
-      }
-
       jsonDoc.clear();
 
       if ((time(NULL) - now()) > 3) {
@@ -668,10 +787,42 @@ static void RPi_PickGNSSFix()
   }
 }
 
+/*
+ * Log the traffic server counters. Unless asked to, at most once a minute
+ * and only when a loss counter has moved since the last look.
+ */
+static void RPi_Traffic_Stats(bool always)
+{
+  static IngestStats last;
+  static unsigned long last_ms = 0;
+  IngestStats stats;
+
+  if (!always && millis() - last_ms < 60000) {
+    return;
+  }
+  last_ms = millis();
+
+  Traffic_TCP_Server.getStats(&stats);
+
+  if (always                               ||
+      stats.oversized != last.oversized    ||
+      stats.truncated != last.truncated    ||
+      stats.refused   != last.refused      ||
+      stats.stalls    != last.stalls) {
+    fprintf( stderr, "Traffic server: %u frames, %u oversized, %u truncated, "
+                     "%u refused, %u stalls\n",
+             stats.frames, stats.oversized, stats.truncated,
+             stats.refused, stats.stalls );
+  }
+
+  last = stats;
+}
+
 static void RPi_ReadTraffic()
 {
-  string traffic_input = Traffic_TCP_Server.getMessage();
-  if (traffic_input != "") {
+  static string traffic_input;
+
+  while (Traffic_TCP_Server.getMessage(traffic_input)) {
     const char *str = traffic_input.c_str();
     int len = traffic_input.length();
 
@@ -680,6 +831,11 @@ static void RPi_ReadTraffic()
 
 //    cout << "Traffic message:" << traffic_input << endl;
 
+      /* 'aircraft.json' from 'dump1090' or uAvionix PingStation */
+      if (parseAircraft(str, len)) {
+        continue;
+      }
+
       deserializeJson(jsonDoc, str);
       JsonObject root = jsonDoc.as<JsonObject>();
 
@@ -696,20 +852,6 @@ static void RPi_ReadTraffic()
         }
       }
 
-      if (root.containsKey("now") &&
-          root.containsKey("messages") &&
-          root.containsKey("aircraft")) {
-        /* 'aircraft.json' output from 'dump1090' application */
-        if (isValidFix()) {
-          parseD1090(root);
-        }
-      } else if (root.containsKey("aircraft")) {
-        /* uAvionix PingStation */
-        if (isValidFix()) {
-          parsePING(root);
-        }
-      }
-
       JsonVariant rawdata = root["rawdata"];
       if (rawdata.success()) {
         parseRAW(root);
@@ -719,20 +861,21 @@ static void RPi_ReadTraffic()
 
     } else if (str[0] == 'q') {
       if (len >= 4 && str[1] == 'u' && str[2] == 'i' && str[3] == 't') {
+        RPi_Traffic_Stats(true);
         Traffic_TCP_Server.detach();
         fprintf( stderr, "Program termination.\n" );
         exit(EXIT_SUCCESS);
       }
     }
-
-    Traffic_TCP_Server.clean();
   }
+
+  RPi_Traffic_Stats(false);
 }
 
 void normal_loop()
 {
     /* Read GNSS data from standard input */
-    RPi_PickGNSSFix();
+    PROFILE(PROFILE_GNSS, RPi_PickGNSSFix());
 
     /* Read NMEA data from GNSS module on GPIO pins */
 //    PickGNSSFix();
@@ -747,29 +890,32 @@ void normal_loop()
       RF_Transmit(RF_Encode(&ThisAircraft), true);
     }
 
-    bool success = RF_Receive();
+    bool success;
+    PROFILE(PROFILE_RX, success = RF_Receive());
 
     if (success && isValidFix()) ParseData();
 
     if (isValidFix()) {
-      Traffic_loop();
+      PROFILE(PROFILE_ALARM, Traffic_loop());
     }
 
     if (isTimeToExport()) {
-      NMEA_Export();
+      PROFILE(PROFILE_EXPORT,
+        NMEA_Export();
 
-      if (isValidFix()) {
-        GDL90_Export();
-        D1090_Export();
-        JSON_Export();
-      }
+        if (isValidFix()) {
+          GDL90_Export();
+          D1090_Export();
+          JSON_Export();
+        }
+      );
       ExportTimeMarker = millis();
     }
 
     // Handle Air Connect
     NMEA_loop();
 
-    SoC->Display_loop();
+    PROFILE(PROFILE_DISPLAY, SoC->Display_loop());
 
     ClearExpired();
 }
@@ -786,7 +932,9 @@ void relay_loop()
 
     RF_loop();
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    /* walk backwards so that removals do not skip any live slot */
+    for (int n = Traffic_Count() - 1; n >= 0; n--) {
+      int i = traffic_slots[n];
       size_t size = RF_Payload_Size(settings->rf_protocol);
       size = size > sizeof(Container[i].raw) ? sizeof(Container[i].raw) : size;
 
@@ -802,6 +950,7 @@ void relay_loop()
             String str = Bin2Hex(TxBuffer, tx_size);
             printf("%s\n", str.c_str());
 #endif
+            Traffic_Remove(i);
             Container[i] = EmptyFO;
           }
         }
@@ -827,6 +976,7 @@ void relay_loop()
               (int) fo.vs,
               fo.aircraft_type);
 #endif
+          Traffic_Remove(i);
           Container[i] = EmptyFO;
         }
       }
@@ -941,12 +1091,6 @@ void txrx_test_loop()
 }
 
 
-void * traffic_tcpserv_loop(void * m)
-{
-  pthread_detach(pthread_self());
-  Traffic_TCP_Server.receive();
-}
-
 int main()
 {
   // Init GPIO bcm
@@ -995,10 +1139,12 @@ int main()
   Traffic_setup();
   NMEA_setup();
 
-  Traffic_TCP_Server.setup(JSON_SRV_TCP_PORT);
+  if (!Traffic_TCP_Server.setup(JSON_SRV_TCP_PORT)) {
+    fprintf( stderr, "Traffic server setup on port %d Failed\n\n", JSON_SRV_TCP_PORT );
+    exit(EXIT_FAILURE);
+  }
 
-  pthread_t traffic_tcpserv_thread;
-  if ( pthread_create(&traffic_tcpserv_thread, NULL, traffic_tcpserv_loop, (void *)0) != 0) {
+  if (!Traffic_TCP_Server.start()) {
     fprintf( stderr, "pthread_create(traffic_tcpserv_thread) Failed\n\n" );
     exit(EXIT_FAILURE);
   }
@@ -1007,7 +1153,11 @@ int main()
 
   SoC->WDT_setup();
 
+  RPi_Events_setup();
+
   while (true) {
+    Profile_loop();
+
     switch (settings->mode)
     {
     case SOFTRF_MODE_TXRX_TEST:
@@ -1022,6 +1172,10 @@ int main()
       break;
     }
 
+    NMEA_Flush();
+
+    RPi_Events_wait();
+
 #if defined(TAKE_CARE_OF_MILLIS_ROLLOVER)
     /* take care of millis() rollover on a long term run */
     if (millis() > (47 * 24 * 3600 * 1000UL)) {
@@ -1057,6 +1211,7 @@ void shutdown(int reason)
     SoC->Display_fini(reason);
   }
 
+  RPi_Traffic_Stats(true);
   Traffic_TCP_Server.detach();
   fprintf( stderr, "Program termination. Reason code: %d.\n", reason );
   exit(EXIT_SUCCESS);
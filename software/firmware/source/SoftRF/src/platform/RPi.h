@@ -22,7 +22,11 @@
 #define PLATFORM_RPI_H
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
-#define MAX_TRACKING_OBJECTS  8
+#if !defined(MAX_TRACKING_OBJECTS)
+#define MAX_TRACKING_OBJECTS  200
+#endif
+#define MAX_NMEA_OBJECTS      6
+#define NMEA_QUEUE_SIZE       1024    /* per NMEA output */
 
 #define DEFAULT_SOFTRF_MODEL    SOFTRF_MODEL_RASPBERRY
 
@@ -125,6 +129,8 @@ extern const char *Hardware_Rev[];
 //#define EXCLUDE_MAVLINK
 
 //#define USE_OGN_ENCRYPTION
+#define USE_LDPC_REPAIR
+#define USE_PROFILER
 
 //#define USE_OGN_RF_DRIVER
 //#define WITH_RFM95
@@ -0,0 +1,1740 @@
+/*
+ * Platform_Replay.cpp
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host-side replay of a recorded flight through the traffic pipeline:
+ *
+ *   ParseData() -> AddTraffic() -> Traffic_Update() -> Alarm_*()
+ *   Traffic_loop() and NMEA_Export()
+ *
+ * No radio, GNSS module or bcm2835 library is involved. The input is a
+ * log of GNSS NMEA sentences interleaved with the $PSRFI raw packet
+ * sentences that SoftRF emits when "nmea_p" is on:
+ *
+ *   $GPRMC,101530.00,A,4807.038,N,01131.000,E,...
+ *   $GPGGA,101530.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47
+ *   $PSRFI,1600000000,<payload hex>,-87
+ *
+ * The log is replayed as fast as possible on a virtual clock that
+ * follows the time stamps of the log (RMC date and time, $PSRFI unix
+ * time). Lines that share the same second are spread evenly over it.
+ *
+ * Usage example:
+ *
+ *  $ make replay
+ *  $ ./SoftRF-replay -a vector flight.log
+ *  $ ./SoftRF-replay -a legacy -v flight.log > flight.nmea
+ *
+ * "-b <name>" runs one of the built-in micro-benchmarks instead:
+ *
+ *  $ ./SoftRF-replay -b json aircraft.json
+ *  $ ./SoftRF-replay -b uat [frames.txt]
+ *  $ ./SoftRF-replay -b nmea
+ *  $ ./SoftRF-replay -b adb ogn.adb [ogn.cdb]
+ */
+
+#if defined(RASPBERRY_PI) && defined(SOFTRF_REPLAY)
+
+#include "../system/SoC.h"
+#include "../driver/EEPROM.h"
+#include <TinyGPS++.h>
+#include "../driver/RF.h"
+#include "../driver/GNSS.h"
+#include "../driver/Battery.h"
+#include "../driver/Bluetooth.h"
+#include "../driver/WiFi.h"
+#include "../driver/Baro.h"
+#include "../driver/EPD.h"
+#include "../TrafficHelper.h"
+#include "../Wind.h"
+#include "../protocol/data/NMEA.h"
+#include "../protocol/data/JSON.h"
+#include "../protocol/radio/Legacy.h"
+#include "../system/Time.h"
+#include "../system/ADB.h"
+#include <lib_crc.h>
+#include <uat.h>
+#include <fec.h>
+#include <fec/rs.h>
+#include <ldpc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+/* ---- replaced platform and driver globals ---- */
+
+eeprom_t eeprom_block;
+settings_t *settings = &eeprom_block.field.settings;
+ufo_t ThisAircraft;
+char UDPpacketBuffer[UDP_PACKET_BUFSIZE];
+hardware_info_t hw_info;
+
+TinyGPSPlus gnss;
+volatile unsigned long PPS_TimeMarker = 0;
+uint32_t GNSSTimeMarker  = 0;
+uint32_t SetupTimeMarker = 0;
+bool BTactive = false;
+barochip_ops_t *baro_chip = NULL;
+ui_settings_t ui_settings;
+uint32_t adsb_packets_counter = 0;
+
+TTYSerial Serial1("/dev/null");
+TTYSerial Serial2("/dev/null");
+SerialSimulator Serial;
+
+byte TxBuffer[MAX_PKT_SIZE], RxBuffer[MAX_PKT_SIZE];
+time_t RF_time;
+uint8_t RF_current_slot = 0;
+uint16_t RF_last_crc = 0;
+int8_t RF_last_rssi = 0;
+uint32_t rx_packets_counter = 0;
+uint32_t tx_packets_counter = 0;
+bool (*protocol_decode)(void *, ufo_t *, ufo_t *);
+
+extern unsigned long UpdateTrafficTimeMarker;
+
+static bool replay_verbose = false;
+static uint64_t nmea_bytes = 0;
+static uint32_t nmea_writes = 0;
+
+/* ---- virtual clock ---- */
+
+static uint32_t virtual_ms = 0;
+
+unsigned int millis()
+{
+  return virtual_ms;
+}
+
+unsigned int micros()
+{
+  return virtual_ms * 1000;
+}
+
+void delay(unsigned int ms)
+{
+  virtual_ms += ms;
+}
+
+static uint64_t replay_ns()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* ---- NMEA sink: counted, printed to stdout with -v ---- */
+
+static size_t Replay_UART_write(const uint8_t *buf, size_t size)
+{
+  nmea_bytes += size;
+  nmea_writes++;
+  if (replay_verbose) {
+    fwrite(buf, 1, size, stdout);
+  }
+  return size;
+}
+
+static IODev_ops_t Replay_UART_ops = {
+  "Replay UART",
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  Replay_UART_write
+};
+
+void SerialSimulator::begin(int baud) { }
+void SerialSimulator::flush(void) { }
+size_t SerialSimulator::available(void) { return 0; }
+size_t SerialSimulator::read(void) { return 0; }
+
+size_t SerialSimulator::write(const char *s)
+{
+  return Replay_UART_write((const uint8_t *) s, strlen(s));
+}
+
+size_t SerialSimulator::write(unsigned char *s, size_t len)
+{
+  return Replay_UART_write(s, len);
+}
+
+size_t SerialSimulator::write(char ch)
+{
+  return Replay_UART_write((const uint8_t *) &ch, 1);
+}
+
+size_t SerialSimulator::print(const char *s)   { return write(s); }
+size_t SerialSimulator::print(String s)        { return write(s.c_str()); }
+size_t SerialSimulator::print(char ch)         { return write(ch); }
+size_t SerialSimulator::println(void)          { return write("\r\n"); }
+size_t SerialSimulator::println(const char *s) { return print(s) + println(); }
+size_t SerialSimulator::println(String s)      { return print(s) + println(); }
+size_t SerialSimulator::println(char ch)       { return print(ch) + println(); }
+
+static size_t Replay_print_num(long n)
+{
+  char buf[24];
+
+  snprintf(buf, sizeof(buf), "%ld", n);
+  return Serial.write(buf);
+}
+
+size_t SerialSimulator::print(ostime_t n)          { return Replay_print_num(n); }
+size_t SerialSimulator::print(unsigned long n)     { return Replay_print_num(n); }
+size_t SerialSimulator::println(unsigned long n)   { return print(n) + println(); }
+size_t SerialSimulator::println(short signed int n)   { return Replay_print_num(n) + println(); }
+size_t SerialSimulator::println(short unsigned int n) { return Replay_print_num(n) + println(); }
+size_t SerialSimulator::println(int8_t n)          { return Replay_print_num(n) + println(); }
+
+size_t SerialSimulator::print(unsigned int n, int base)
+{
+  char buf[24];
+
+  snprintf(buf, sizeof(buf), base == HEX ? "%X" : "%u", n);
+  return write(buf);
+}
+
+size_t SerialSimulator::print(unsigned char ch, int base)   { return print((unsigned int) ch, base); }
+size_t SerialSimulator::println(unsigned char ch, int base) { return print(ch, base) + println(); }
+
+/* ---- stub SoC ---- */
+
+static long Replay_random(long howsmall, long howBig)
+{
+  return howsmall + random() % (howBig - howsmall);
+}
+
+static uint32_t Replay_getChipId()
+{
+  return 0x00BEEF;
+}
+
+static void Replay_WiFi_transmit_UDP(int port, byte *buf, size_t size)
+{
+  Replay_UART_write(buf, size);
+}
+
+static float Replay_Battery_param(uint8_t param)
+{
+  return param == BATTERY_PARAM_THRESHOLD ? BATTERY_THRESHOLD_USB :
+                                            BATTERY_THRESHOLD_USB + 0.05;
+}
+
+const SoC_ops_t Replay_ops = {
+  SOC_NONE,
+  "Replay",
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  Replay_getChipId,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  Replay_random,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  Replay_WiFi_transmit_UDP,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &Replay_UART_ops,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  Replay_Battery_param,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+const SoC_ops_t *SoC = &Replay_ops;
+
+/* ---- radio and peripheral stubs: packets are encoded but never sent ---- */
+
+uint8_t RF_Payload_Size(uint8_t protocol)
+{
+  return legacy_proto_desc.payload_size;
+}
+
+/* the encoder also projects ThisAircraft ahead and decides its airborne flag */
+size_t RF_Encode(ufo_t *fop)
+{
+  return legacy_encode((void *) &TxBuffer[0], fop);
+}
+
+bool RF_Transmit(size_t size, bool wait) { return false; }
+bool RF_Transmit_Ready()        { return false; }
+
+String Bin2Hex(byte *buffer, size_t size)
+{
+  char buf[2 * MAX_PKT_SIZE + 1];
+
+  size = size > MAX_PKT_SIZE ? MAX_PKT_SIZE : size;
+  for (size_t i = 0; i < size; i++) {
+    snprintf(buf + 2 * i, 3, "%02x", buffer[i]);
+  }
+  buf[2 * size] = 0;
+  return String(buf);
+}
+
+uint8_t parity(uint32_t x)
+{
+  return __builtin_parity(x);
+}
+
+float Battery_voltage()   { return BATTERY_THRESHOLD_USB + 0.05; }
+float Battery_threshold() { return BATTERY_THRESHOLD_USB; }
+bool Buzzer_Notify(int8_t level, bool multi) { return false; }
+int LookupSeparation(float lat, float lon) { return 0; }
+
+static bool GNSS_fix_cache = false;
+
+bool isValidGNSSFix()
+{
+  return GNSS_fix_cache;
+}
+
+/* ---- per-stage latency ---- */
+
+enum
+{
+  STAGE_DECODE,   /* protocol_decode() */
+  STAGE_TRAFFIC,  /* rest of ParseData(): AddTraffic(), Traffic_Update(), Alarm_*() */
+  STAGE_LOOP,     /* Traffic_loop() */
+  STAGE_EXPORT,   /* NMEA_Export() */
+  STAGE_COUNT
+};
+
+static const char *Stage_Name[STAGE_COUNT] = {
+  [STAGE_DECODE]  = "decode",
+  [STAGE_TRAFFIC] = "traffic",
+  [STAGE_LOOP]    = "loop",
+  [STAGE_EXPORT]  = "export"
+};
+
+static std::vector<uint32_t> stage_ns[STAGE_COUNT];
+
+static bool (*replay_decode)(void *, ufo_t *, ufo_t *);
+static uint64_t decode_ns;
+static uint32_t decoded = 0;
+
+static bool Replay_timed_decode(void *buffer, ufo_t *this_aircraft, ufo_t *fop)
+{
+  uint64_t t0 = replay_ns();
+  bool rval = (*replay_decode)(buffer, this_aircraft, fop);
+  decode_ns += replay_ns() - t0;
+  if (rval) {
+    decoded++;
+  }
+  return rval;
+}
+
+/* ---- alarm decisions ---- */
+
+struct alarm_track_t {
+  int8_t   level;
+  int8_t   max_level;
+  uint32_t changes;
+};
+
+static std::map<uint32_t, alarm_track_t> alarm_tracks;
+static uint32_t alarm_changes[ALARM_LEVEL_URGENT + 1];
+
+static void Replay_alarms()
+{
+  for (int n = 0; n < Traffic_Count(); n++) {
+    ufo_t *fop = &Container[traffic_slots[n]];
+    alarm_track_t &track = alarm_tracks[fop->addr];
+
+    if (fop->alarm_level == track.level) {
+      continue;
+    }
+
+    printf("%lu %06X alarm %d -> %d dist %.0f alt %.0f\n",
+           (unsigned long) now(), fop->addr, track.level, fop->alarm_level,
+           fop->distance, fop->alt_diff);
+
+    track.level = fop->alarm_level;
+    track.changes++;
+    if (track.level > track.max_level) {
+      track.max_level = track.level;
+    }
+    if (track.level >= 0 && track.level <= ALARM_LEVEL_URGENT) {
+      alarm_changes[track.level]++;
+    }
+  }
+}
+
+/* ---- log input ---- */
+
+struct replay_line_t {
+  std::string text;
+  time_t      sec;
+  uint32_t    ms;
+};
+
+static int Replay_field(const char *s, int n, char *buf, size_t size)
+{
+  for (; n > 0 && s; n--) {
+    s = strchr(s, ',');
+    if (s) s++;
+  }
+  if (s == NULL) {
+    return 0;
+  }
+
+  size_t len = strcspn(s, ",*");
+  if (len >= size) {
+    len = size - 1;
+  }
+  memcpy(buf, s, len);
+  buf[len] = 0;
+  return len;
+}
+
+/* seconds of the day from a hhmmss[.ss] field, -1 if there is none */
+static long Replay_tod(const char *s)
+{
+  char f[16];
+
+  if (Replay_field(s, 1, f, sizeof(f)) < 6) {
+    return -1;
+  }
+  return ((f[0] - '0') * 10 + f[1] - '0') * 3600 +
+         ((f[2] - '0') * 10 + f[3] - '0') * 60 +
+          (f[4] - '0') * 10 + f[5] - '0';
+}
+
+/* unix time of a line, 0 when it carries no usable time stamp */
+static time_t Replay_stamp(const char *s, time_t last)
+{
+  if (strncmp(s, "$PSRFI,", 7) == 0) {
+    return strtoul(s + 7, NULL, 10);
+  }
+
+  if (s[0] != '$' || s[1] != 'G' ||
+      (strncmp(s + 3, "RMC,", 4) && strncmp(s + 3, "GGA,", 4))) {
+    return 0;
+  }
+
+  long tod = Replay_tod(s);
+  if (tod < 0) {
+    return 0;
+  }
+
+  char d[8];
+  if (s[3] == 'R' && Replay_field(s, 9, d, sizeof(d)) == 6) {
+    tmElements_t tm;
+
+    tm.Day    = (d[0] - '0') * 10 + d[1] - '0';
+    tm.Month  = (d[2] - '0') * 10 + d[3] - '0';
+    tm.Year   = y2kYearToTm((d[4] - '0') * 10 + d[5] - '0');
+    tm.Hour   = tm.Minute = tm.Second = 0;
+    return makeTime(tm) + tod;
+  }
+
+  if (last == 0) {
+    return 0;
+  }
+
+  /* GGA has no date: take it from the previous stamp */
+  time_t t = last - (last % SECS_PER_DAY) + tod;
+  if (t + SECS_PER_DAY / 2 < last) {
+    t += SECS_PER_DAY;
+  }
+  return t;
+}
+
+static bool Replay_load(FILE *fp, std::vector<replay_line_t> &lines)
+{
+  char buf[256];
+  time_t last = 0;
+
+  while (fgets(buf, sizeof(buf), fp)) {
+    size_t len = strcspn(buf, "\r\n");
+    if (len == 0) {
+      continue;
+    }
+    buf[len] = 0;
+
+    replay_line_t line;
+    line.text = buf;
+    time_t t = Replay_stamp(buf, last);
+    line.sec = (t > last) ? t : last;
+    line.ms = 0;
+    last = line.sec;
+    lines.push_back(line);
+  }
+
+  if (lines.empty() || last == 0) {
+    return false;
+  }
+
+  /* lines ahead of the first stamp belong to its second */
+  size_t first = 0;
+  while (lines[first].sec == 0) first++;
+  for (size_t i = 0; i < first; i++) {
+    lines[i].sec = lines[first].sec;
+  }
+
+  time_t base = lines[0].sec;
+  for (size_t i = 0; i < lines.size(); ) {
+    size_t j = i;
+    while (j < lines.size() && lines[j].sec == lines[i].sec) j++;
+    for (size_t k = i; k < j; k++) {
+      lines[k].ms = 1000 + (lines[k].sec - base) * 1000 +
+                    (k - i) * 1000 / (j - i);
+    }
+    i = j;
+  }
+
+  return true;
+}
+
+/* ---- replay ---- */
+
+static void Replay_GNSS(const char *str, size_t len)
+{
+  static uint32_t time_to_estimate_climb = 0;
+  static uint32_t time_to_estimate_wind  = 0;
+  static uint32_t initial_time = 0;
+  static uint32_t nextprev_ms  = 0;
+  static float next_prevcourse  = 0;
+  static float next_prevheading = 0;
+  static float next_prevalt     = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    gnss.encode(str[i]);
+  }
+  gnss.encode('\r');
+  gnss.encode('\n');
+
+  GNSS_fix_cache = gnss.location.isValid()               &&
+                   gnss.altitude.isValid()               &&
+                   gnss.date.isValid()                   &&
+                  (gnss.location.age() <= NMEA_EXP_TIME) &&
+                  (gnss.altitude.age() <= NMEA_EXP_TIME) &&
+                  (gnss.date.age()     <= NMEA_EXP_TIME);
+
+  if (!GNSS_fix_cache || !gnss.location.isUpdated()) {
+    return;
+  }
+
+  uint32_t thistime_ms = millis() - gnss.location.age();
+  if (thistime_ms - ThisAircraft.gnsstime_ms <= 150) {
+    return;
+  }
+
+  if (SetupTimeMarker == 0) {
+    SetupTimeMarker = millis();
+  }
+
+  ThisAircraft.timestamp        = now();
+  ThisAircraft.gnsstime_ms      = thistime_ms;
+  ThisAircraft.latitude         = gnss.location.lat();
+  ThisAircraft.longitude        = gnss.location.lng();
+  ThisAircraft.altitude         = gnss.altitude.meters();
+  ThisAircraft.course           = gnss.course.deg();
+  ThisAircraft.speed            = gnss.speed.knots();
+  ThisAircraft.hdop             = (uint16_t) gnss.hdop.value();
+  ThisAircraft.geoid_separation = gnss.separation.meters();
+
+  if (initial_time == 0) {
+    initial_time = millis();
+  } else if (GNSSTimeMarker == 0 && millis() > initial_time + 30000) {
+    GNSSTimeMarker = millis();
+  }
+
+  /* same snapshot of the previous state as in normal() for turn and climb rates */
+  if (thistime_ms > ((nextprev_ms + 1400) ^ ((nextprev_ms >> 4) & 0x0FF))) {
+    ThisAircraft.prevtime_ms  = nextprev_ms;
+    ThisAircraft.prevcourse   = next_prevcourse;
+    ThisAircraft.prevheading  = next_prevheading;
+    ThisAircraft.prevaltitude = next_prevalt;
+    nextprev_ms      = thistime_ms;
+    next_prevcourse  = ThisAircraft.course;
+    next_prevheading = ThisAircraft.heading;
+    next_prevalt     = ThisAircraft.altitude;
+  }
+
+  if (ThisAircraft.gnsstime_ms > time_to_estimate_climb) {
+    time_to_estimate_climb = ThisAircraft.gnsstime_ms + 4100;
+    ThisAircraft.vs = Estimate_Climbrate();
+  }
+
+  if (ThisAircraft.gnsstime_ms > time_to_estimate_wind) {
+    Estimate_Wind();
+    time_to_estimate_wind = ThisAircraft.gnsstime_ms + 666;
+  }
+
+  /* one transmission per fix */
+  RF_Encode(&ThisAircraft);
+}
+
+static uint32_t packets = 0;
+
+static void Replay_Packet(const char *str, time_t sec)
+{
+  const char *hex = strchr(str + 7, ',');
+  if (hex == NULL) {
+    return;
+  }
+  hex++;
+
+  size_t size = 0;
+  while (size < sizeof(RxBuffer) && isxdigit(hex[0]) && isxdigit(hex[1])) {
+    char byte_s[3] = { hex[0], hex[1], 0 };
+    RxBuffer[size++] = strtoul(byte_s, NULL, 16);
+    hex += 2;
+  }
+  if (size < RF_Payload_Size(settings->rf_protocol)) {
+    return;
+  }
+
+  RF_last_rssi = (*hex == ',') ? atoi(hex + 1) : 0;
+  RF_last_crc  = 0;
+  RF_time      = sec;
+  rx_packets_counter++;
+  packets++;
+
+  if (!isValidFix()) {
+    return;
+  }
+
+  decode_ns = 0;
+  uint64_t t0 = replay_ns();
+  ParseData();
+  uint64_t t = replay_ns() - t0;
+
+  stage_ns[STAGE_DECODE].push_back(decode_ns);
+  stage_ns[STAGE_TRAFFIC].push_back(t - decode_ns);
+}
+
+static void Replay_report(uint64_t wall_ns)
+{
+  uint64_t pipe_ns = 0;
+
+  printf("\n%-8s %8s %10s %10s %10s %10s  (ns)\n",
+         "stage", "calls", "p50", "p90", "p99", "max");
+
+  for (int s = 0; s < STAGE_COUNT; s++) {
+    std::vector<uint32_t> &v = stage_ns[s];
+    if (v.empty()) {
+      printf("%-8s %8u\n", Stage_Name[s], 0);
+      continue;
+    }
+    std::sort(v.begin(), v.end());
+    for (size_t i = 0; i < v.size(); i++) pipe_ns += v[i];
+
+    printf("%-8s %8zu %10u %10u %10u %10u\n", Stage_Name[s], v.size(),
+           v[v.size() * 50 / 100], v[v.size() * 90 / 100],
+           v[v.size() * 99 / 100], v.back());
+  }
+
+  size_t parsed = stage_ns[STAGE_DECODE].size();
+
+  printf("\npackets  %u read, %zu parsed, %u decoded\n", packets, parsed, decoded);
+  printf("pipeline %.0f packets/s (%.3f ms in stages)\n",
+         pipe_ns ? parsed * 1e9 / pipe_ns : 0.0, pipe_ns / 1e6);
+  printf("replay   %.3f ms wall, %.1f s of log, %llu NMEA bytes in %u writes\n",
+         wall_ns / 1e6, (virtual_ms - 1000) / 1000.0,
+         (unsigned long long) nmea_bytes, nmea_writes);
+
+  printf("alarms   %zu targets,", alarm_tracks.size());
+  for (int l = ALARM_LEVEL_CLOSE; l <= ALARM_LEVEL_URGENT; l++) {
+    printf(" %u", alarm_changes[l]);
+  }
+  printf(" transitions to level 1..4\n");
+  printf("         %u alarm evaluations, %u skipped outside the box\n",
+         Traffic_alarm_evaluated, Traffic_alarm_boxed);
+  if (Traffic_track_fixes > 0) {
+    printf("tracking %u fixes, %.1f m off the dead reckoning, %.1f m off the previous fix\n",
+           Traffic_track_fixes, Traffic_track_error / Traffic_track_fixes,
+           Traffic_track_stale / Traffic_track_fixes);
+  }
+
+  for (std::map<uint32_t, alarm_track_t>::iterator it = alarm_tracks.begin();
+       it != alarm_tracks.end(); ++it) {
+    if (it->second.max_level > ALARM_LEVEL_NONE) {
+      printf("         %06X max level %d, %u changes\n",
+             it->first, it->second.max_level, it->second.changes);
+    }
+  }
+}
+
+/* ---- micro-benchmarks ---- */
+
+#define BENCH_FRAMES  4096
+#define BENCH_ROUNDS  256
+
+static const char *replay_bench_arg = NULL;   /* a second file, if given */
+
+/* RX path CRC: byte by byte as before vs. crc_ccitt_block() */
+static void Replay_bench_crc(const char *path)
+{
+  static uint8_t frames[BENCH_FRAMES][LEGACY_PAYLOAD_SIZE];
+  static const uint8_t address[] = { 0x31, 0xFA, 0xB6 };
+  uint16_t crc_byte = 0, crc_block = 0;
+  uint64_t t0, byte_ns, block_ns;
+
+  srandom(1);
+  for (int f = 0; f < BENCH_FRAMES; f++) {
+    for (int i = 0; i < LEGACY_PAYLOAD_SIZE; i++) {
+      frames[f][i] = random();
+    }
+  }
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+      uint16_t crc16 = 0xffff;
+      for (int i = 0; i < (int) sizeof(address); i++) {
+        crc16 = update_crc_ccitt(crc16, address[i]);
+      }
+      for (int i = 0; i < LEGACY_PAYLOAD_SIZE; i++) {
+        crc16 = update_crc_ccitt(crc16, frames[f][i]);
+      }
+      crc_byte += crc16;
+    }
+  }
+  byte_ns = replay_ns() - t0;
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+      uint16_t crc16 = crc_ccitt_block(0xffff, address, sizeof(address));
+      crc_block += crc_ccitt_block(crc16, frames[f], LEGACY_PAYLOAD_SIZE);
+    }
+  }
+  block_ns = replay_ns() - t0;
+
+  printf("crc-ccitt over %d byte frames\n", (int) (sizeof(address) + LEGACY_PAYLOAD_SIZE));
+  printf("  %-10s %8.1f ns/frame\n", "bytewise",
+         (double) byte_ns  / (BENCH_ROUNDS * BENCH_FRAMES));
+  printf("  %-10s %8.1f ns/frame\n", "block",
+         (double) block_ns / (BENCH_ROUNDS * BENCH_FRAMES));
+  printf("  results %s\n", crc_byte == crc_block ? "match" : "DIFFER");
+}
+
+/*
+ * Aircraft lists: ArduinoJson document walk as before vs. parseAircraft().
+ * ThisAircraft is put at the mean position of the listed aircraft.
+ */
+static void Replay_bench_json(const char *path)
+{
+  if (path == NULL) {
+    fprintf(stderr, "-b json: no aircraft.json given\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::ifstream in(path);
+  if (!in) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string text = ss.str();
+  const char *str = text.c_str();
+
+  DynamicJsonDocument doc(text.size() * 4 + 4096);
+  if (deserializeJson(doc, str) || !doc["aircraft"].is<JsonArray>()) {
+    fprintf(stderr, "-b json: no aircraft list in '%s'\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  JsonArray list = doc["aircraft"];
+  double lat = 0, lon = 0, alt = 0;
+  int listed = 0, placed = 0;
+
+  for (JsonObject a : list) {
+    float la = a.containsKey("lat") ? a["lat"] : a["latDD"];
+    float lo = a.containsKey("lon") ? a["lon"] : a["lonDD"];
+    float al = a.containsKey("altitudeMM") ? a["altitudeMM"].as<float>() / 1000.0 :
+               (a.containsKey("altitude") ? a["altitude"] : a["alt_baro"]).as<float>() /
+               _GPS_FEET_PER_METER;
+    listed++;
+    if (la != 0.0 && lo != 0.0) {
+      lat += la; lon += lo; alt += al;
+      placed++;
+    }
+  }
+  doc.clear();
+
+  if (placed > 0) {
+    ThisAircraft.latitude  = lat / placed;
+    ThisAircraft.longitude = lon / placed;
+    ThisAircraft.altitude  = alt / placed;
+  }
+  ThisAircraft.addr      = Replay_getChipId();
+  ThisAircraft.timestamp = now();
+  GNSS_fix_cache = true;
+  settings->rf_protocol = RF_PROTOCOL_LATEST;
+  Traffic_setup();
+
+  /* best of several passes - a busy host only ever adds time */
+  const int passes = 10, rounds = 20;
+  uint64_t t0, t, doc_ns = UINT64_MAX, stream_ns = UINT64_MAX;
+  DeserializationError err;
+  float sink = 0;
+
+  for (int pass = 0; pass < passes; pass++) {
+    t0 = replay_ns();
+    for (int r = 0; r < rounds; r++) {
+      err = deserializeJson(jsonDoc, str);
+      JsonArray aircraft = jsonDoc["aircraft"];
+      for (JsonObject a : aircraft) {
+        const char *hex = a["hex"];
+        sink += (hex ? hex[0] : 0);
+        sink += a["lat"].as<float>() + a["lon"].as<float>() + a["altitude"].as<int>();
+        sink += a["track"].as<int>() + a["speed"].as<int>() + a["vert_rate"].as<int>();
+      }
+      jsonDoc.clear();
+    }
+    t = replay_ns() - t0;
+    doc_ns = std::min(doc_ns, t);
+
+    t0 = replay_ns();
+    for (int r = 0; r < rounds; r++) {
+      parseAircraft(str, text.size());
+    }
+    t = replay_ns() - t0;
+    stream_ns = std::min(stream_ns, t);
+  }
+
+  printf("%s: %zu bytes, %d aircraft listed, %d kept within %d m (sink %.0f)\n",
+         path, text.size(), listed, Traffic_Count(), JSON_IMPORT_RANGE, sink);
+  printf("  %-10s %10.1f us/document (%s)\n", "document",
+         doc_ns / 1e3 / rounds, err.c_str());
+  printf("  %-10s %10.1f us/document\n", "stream",
+         stream_ns / 1e3 / rounds);
+
+  /* the imports have to come with their distance, traffic_geometry() skips them */
+  float dmin = 1e9, dmax = 0;
+  int zero = 0;
+  for (int i = 0; i < MAX_TRACKING_OBJECTS; i++) {
+    if (Container[i].addr == 0)
+      continue;
+    dmin = std::min(dmin, Container[i].distance);
+    dmax = std::max(dmax, Container[i].distance);
+    zero += (Container[i].dx == 0 && Container[i].dy == 0);
+  }
+  printf("  distance %.0f..%.0f m, %d at 0,0\n", dmin, dmax, zero);
+}
+
+#define BENCH_UAT_ADSB    4096
+#define BENCH_UAT_UPLINK  256
+
+static void *bench_rs_short, *bench_rs_long, *bench_rs_uplink;
+
+/* correct_adsb_frame() as it was: long decode, then retry as short */
+static int Replay_adsb_before(uint8_t *to, int *rs_errors)
+{
+  int n_corrected = decode_rs_char(bench_rs_long, to, NULL, 0);
+  if (n_corrected >= 0 && n_corrected <= 7 && (to[0]>>3) != 0) {
+    *rs_errors = n_corrected;
+    return 2;
+  }
+  n_corrected = decode_rs_char(bench_rs_short, to, NULL, 0);
+  if (n_corrected >= 0 && n_corrected <= 6 && (to[0]>>3) == 0) {
+    *rs_errors = n_corrected;
+    return 1;
+  }
+  *rs_errors = 9999;
+  return -1;
+}
+
+/* correct_uplink_frame() as it was: strided deinterleave, decode every block */
+static int Replay_uplink_before(uint8_t *from, uint8_t *to, int *rs_errors)
+{
+  int total_corrected = 0;
+
+  for (int block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+    uint8_t *blockdata = &to[block * UPLINK_BLOCK_DATA_BYTES];
+
+    for (int i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+      blockdata[i] = from[i * UPLINK_FRAME_BLOCKS + block];
+
+    int n_corrected = decode_rs_char(bench_rs_uplink, blockdata, NULL, 0);
+    if (n_corrected < 0 || n_corrected > 10) {
+      *rs_errors = 9999;
+      return -1;
+    }
+    total_corrected += n_corrected;
+  }
+  *rs_errors = total_corrected;
+  return 1;
+}
+
+/* random data with valid parity: the parity symbols are decoded as erasures */
+static void Replay_uat_codeword(void *rs, uint8_t *data, int len, int nroots, int pad, int type)
+{
+  int eras[UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES];
+
+  for (int i = 0; i < len - nroots; i++) {
+    data[i] = random();
+  }
+  data[0] = (type << 3) | (data[0] & 0x07);
+  for (int i = 0; i < nroots; i++) {
+    data[len - nroots + i] = 0;
+    eras[i] = pad + len - nroots + i;
+  }
+  decode_rs_char(rs, data, eras, nroots);
+}
+
+/*
+ * Most frames arrive clean, some with a few bad bytes,
+ * and a few are too damaged to correct.
+ */
+static void Replay_uat_damage(uint8_t *data, int len)
+{
+  int dice = random() % 100;
+  int errors = dice < 75 ? 0 : (dice < 93 ? 1 + random() % 3 : 12);
+
+  for (int i = 0; i < errors; i++) {
+    data[random() % len] ^= 1 + random() % 255;
+  }
+}
+
+/* returns the frame length, or 0 if the line is not a raw UAT frame */
+static size_t Replay_hex_frame(const std::string &line, uint8_t *buf, size_t size)
+{
+  size_t n = line.find_first_of(" \t\r;");
+  n = (n == std::string::npos ? line.size() : n) / 2;
+
+  if (n != SHORT_FRAME_BYTES && n != LONG_FRAME_BYTES && n != UPLINK_FRAME_BYTES) {
+    return 0;
+  }
+  for (size_t i = 0; i < n && i < size; i++) {
+    unsigned int b;
+    if (sscanf(line.c_str() + 2 * i, "%2x", &b) != 1) {
+      return 0;
+    }
+    buf[i] = b;
+  }
+  return n;
+}
+
+/*
+ * UAT FEC: the former long-then-short decode vs. correct_adsb_frame(),
+ * and the former uplink path vs. correct_uplink_frame().
+ * Input is one raw frame per line in hex (data and parity, 30, 48 or 552
+ * bytes), or synthetic frames when no file is given.
+ */
+static void Replay_bench_uat(const char *path)
+{
+  std::vector<std::vector<uint8_t>> adsb, uplink;
+
+  init_fec();
+  bench_rs_short  = init_rs_char(8, 0x187, 120, 1, 12, 225);
+  bench_rs_long   = init_rs_char(8, 0x187, 120, 1, 14, 207);
+  bench_rs_uplink = init_rs_char(8, 0x187, 120, 1, 20, 163);
+
+  if (path != NULL) {
+    std::ifstream in(path);
+    std::string line;
+    uint8_t buf[UPLINK_FRAME_BYTES];
+
+    if (!in) {
+      perror(path);
+      exit(EXIT_FAILURE);
+    }
+    while (std::getline(in, line)) {
+      size_t b = line.find_first_not_of("-+ \t");
+      size_t n = 0;
+
+      memset(buf, 0, sizeof(buf));
+      if (b != std::string::npos) {
+        n = Replay_hex_frame(line.substr(b), buf, sizeof(buf));
+      }
+      if (n == UPLINK_FRAME_BYTES) {
+        uplink.push_back(std::vector<uint8_t>(buf, buf + UPLINK_FRAME_BYTES));
+      } else if (n > 0) {
+        adsb.push_back(std::vector<uint8_t>(buf, buf + LONG_FRAME_BYTES));
+      }
+    }
+  } else {
+    uint8_t buf[UPLINK_FRAME_BYTES];
+
+    srandom(1);
+    for (int f = 0; f < BENCH_UAT_ADSB; f++) {
+      memset(buf, 0, sizeof(buf));
+      if (f & 1) {
+        Replay_uat_codeword(bench_rs_long, buf, LONG_FRAME_BYTES, 14, 207, 1 + random() % 10);
+      } else {
+        Replay_uat_codeword(bench_rs_short, buf, SHORT_FRAME_BYTES, 12, 225, 0);
+        for (int i = SHORT_FRAME_BYTES; i < LONG_FRAME_BYTES; i++) {
+          buf[i] = random();      /* whatever follows on the air */
+        }
+      }
+      Replay_uat_damage(buf, (f & 1) ? LONG_FRAME_BYTES : SHORT_FRAME_BYTES);
+      adsb.push_back(std::vector<uint8_t>(buf, buf + LONG_FRAME_BYTES));
+    }
+    for (int f = 0; f < BENCH_UAT_UPLINK; f++) {
+      uint8_t block[UPLINK_BLOCK_BYTES];
+      for (int b = 0; b < UPLINK_FRAME_BLOCKS; b++) {
+        Replay_uat_codeword(bench_rs_uplink, block, UPLINK_BLOCK_BYTES, 20, 163, random() % 32);
+        if (f % 4 == 0) {
+          Replay_uat_damage(block, UPLINK_BLOCK_BYTES);
+        }
+        for (int i = 0; i < UPLINK_BLOCK_BYTES; i++) {
+          buf[i * UPLINK_FRAME_BLOCKS + b] = block[i];
+        }
+      }
+      uplink.push_back(std::vector<uint8_t>(buf, buf + UPLINK_FRAME_BYTES));
+    }
+  }
+
+  /* best of several passes - a busy host only ever adds time */
+  const int passes = 10;
+  uint8_t out_before[UPLINK_FRAME_BYTES], out_after[UPLINK_FRAME_BYTES];
+  uint64_t t0, t, before_ns[2] = { UINT64_MAX, UINT64_MAX }, after_ns[2] = { UINT64_MAX, UINT64_MAX };
+  int rs_before, rs_after, sink = 0;
+
+  for (int pass = 0; pass < passes; pass++) {
+    t0 = replay_ns();
+    for (size_t f = 0; f < adsb.size(); f++) {
+      memcpy(out_before, adsb[f].data(), LONG_FRAME_BYTES);
+      sink += Replay_adsb_before(out_before, &rs_before);
+    }
+    t = replay_ns() - t0;
+    before_ns[0] = std::min(before_ns[0], t);
+
+    t0 = replay_ns();
+    for (size_t f = 0; f < adsb.size(); f++) {
+      memcpy(out_after, adsb[f].data(), LONG_FRAME_BYTES);
+      sink += correct_adsb_frame(out_after, &rs_after);
+    }
+    t = replay_ns() - t0;
+    after_ns[0] = std::min(after_ns[0], t);
+
+    t0 = replay_ns();
+    for (size_t f = 0; f < uplink.size(); f++) {
+      sink += Replay_uplink_before(uplink[f].data(), out_before, &rs_before);
+    }
+    t = replay_ns() - t0;
+    before_ns[1] = std::min(before_ns[1], t);
+
+    t0 = replay_ns();
+    for (size_t f = 0; f < uplink.size(); f++) {
+      sink += correct_uplink_frame(uplink[f].data(), out_after, &rs_after);
+    }
+    t = replay_ns() - t0;
+    after_ns[1] = std::min(after_ns[1], t);
+  }
+
+  /*
+   * Both must correct every frame the same way. The old ADS-B path could
+   * count corrections that a rejected long decode had made and the short
+   * decode then undid; those frames only differ in rs_errors.
+   */
+  int differ = 0, recount = 0, good = 0;
+
+  for (size_t f = 0; f < adsb.size(); f++) {
+    memcpy(out_before, adsb[f].data(), LONG_FRAME_BYTES);
+    memcpy(out_after,  adsb[f].data(), LONG_FRAME_BYTES);
+    int type_before = Replay_adsb_before(out_before, &rs_before);
+    int type_after  = correct_adsb_frame(out_after, &rs_after);
+    int len = type_before == 2 ? LONG_FRAME_DATA_BYTES : SHORT_FRAME_DATA_BYTES;
+
+    if (type_before != type_after ||
+        (type_before > 0 && memcmp(out_before, out_after, len))) {
+      differ++;
+    } else if (rs_before != rs_after) {
+      recount++;
+    }
+    good += (type_after > 0);
+  }
+  for (size_t f = 0; f < uplink.size(); f++) {
+    int type_before = Replay_uplink_before(uplink[f].data(), out_before, &rs_before);
+    int type_after  = correct_uplink_frame(uplink[f].data(), out_after, &rs_after);
+
+    if (type_before != type_after || rs_before != rs_after ||
+        (type_before > 0 && memcmp(out_before, out_after, UPLINK_FRAME_DATA_BYTES))) {
+      differ++;
+    }
+  }
+
+  printf("%s: %zu ADS-B frames (%d correctable), %zu uplink frames (sink %d)\n",
+         path ? path : "synthetic", adsb.size(), good, uplink.size(), sink);
+  if (adsb.size() > 0) {
+    printf("  %-10s %10.0f ADS-B frames/s\n", "before", adsb.size() * 1e9 / before_ns[0]);
+    printf("  %-10s %10.0f ADS-B frames/s\n", "after",  adsb.size() * 1e9 / after_ns[0]);
+  }
+  if (uplink.size() > 0) {
+    printf("  %-10s %10.0f uplink frames/s\n", "before", uplink.size() * 1e9 / before_ns[1]);
+    printf("  %-10s %10.0f uplink frames/s\n", "after",  uplink.size() * 1e9 / after_ns[1]);
+  }
+  printf("  results %s, %d with a different error count\n",
+         differ ? "DIFFER" : "match", recount);
+}
+
+/* ---- OGNTP Gallager code ---- */
+
+#define BENCH_LDPC_FRAMES   4096
+#define BENCH_LDPC_FLIPS    8
+
+static uint8_t bench_ldpc_check[48][26];
+
+/* parity check matrix rows as bytes, from the index lists of the decoder */
+static void Replay_ldpc_matrix()
+{
+  memset(bench_ldpc_check, 0, sizeof(bench_ldpc_check));
+  for (int row = 0; row < 48; row++) {
+    const uint8_t *index = LDPC_ParityCheckIndex_n208k160[row];
+    for (int b = 1; b <= index[0]; b++) {
+      bench_ldpc_check[row][index[b] >> 3] |= 1 << (index[b] & 7);
+    }
+  }
+}
+
+/* bytewise check over the 48 matrix rows, as before */
+static uint8_t Replay_ldpc_before(const uint8_t *data)
+{
+  uint8_t errors = 0;
+
+  for (int row = 0; row < 48; row++) {
+    uint8_t count = 0;
+    for (int i = 0; i < 26; i++) {
+      count += __builtin_popcount(data[i] & bench_ldpc_check[row][i]);
+    }
+    if (count & 1) errors++;
+  }
+  return errors;
+}
+
+/*
+ * LDPC_Check() bytewise as before vs. re-encoding word-wise,
+ * then how many frames with 1..BENCH_LDPC_FLIPS bad bits LDPC_Repair() brings back.
+ */
+static void Replay_bench_ldpc(const char *path)
+{
+  static uint8_t frames[BENCH_LDPC_FRAMES][26];
+  uint64_t t0, before_ns, after_ns;
+  int differ = 0, sink_before = 0, sink_after = 0;
+
+  Replay_ldpc_matrix();
+
+  srandom(1);
+  for (int f = 0; f < BENCH_LDPC_FRAMES; f++) {
+    for (int i = 0; i < 20; i++) {
+      frames[f][i] = random();
+    }
+    LDPC_Encode(frames[f]);
+    /* half of them damaged, as on a busy channel */
+    if (f & 1) {
+      frames[f][random() % 26] ^= 1 << (random() % 8);
+    }
+  }
+
+  for (int f = 0; f < BENCH_LDPC_FRAMES; f++) {
+    if ((Replay_ldpc_before(frames[f]) == 0) != (LDPC_Check(frames[f]) == 0)) {
+      differ++;
+    }
+  }
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int f = 0; f < BENCH_LDPC_FRAMES; f++) {
+      sink_before += Replay_ldpc_before(frames[f]);
+    }
+  }
+  before_ns = replay_ns() - t0;
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int f = 0; f < BENCH_LDPC_FRAMES; f++) {
+      sink_after += LDPC_Check(frames[f]);
+    }
+  }
+  after_ns = replay_ns() - t0;
+
+  printf("LDPC check of %d OGNTP frames (sink %d/%d)\n",
+         BENCH_LDPC_FRAMES, sink_before, sink_after);
+  printf("  %-10s %8.1f ns/frame\n", "before",
+         (double) before_ns / (BENCH_ROUNDS * BENCH_LDPC_FRAMES));
+  printf("  %-10s %8.1f ns/frame\n", "after",
+         (double) after_ns  / (BENCH_ROUNDS * BENCH_LDPC_FRAMES));
+  printf("  results %s\n", differ ? "DIFFER" : "match");
+
+  printf("LDPC_Repair() on frames with bit errors\n");
+  for (int flips = 1; flips <= BENCH_LDPC_FLIPS; flips++) {
+    int repaired = 0, wrong = 0;
+    uint64_t repair_ns = 0;
+
+    srandom(flips);
+    for (int f = 0; f < BENCH_LDPC_FRAMES; f++) {
+      uint8_t sent[26], frame[26];
+
+      OGN_Packet pkt;
+
+      for (int i = 0; i < 20; i++) {
+        pkt.Byte()[i] = random();
+      }
+      pkt.calcAddrParity();
+      memcpy(sent, pkt.Byte(), 20);
+      LDPC_Encode(sent);
+      memcpy(frame, sent, sizeof(frame));
+      for (int n = 0; n < flips; ) {
+        int bit = random() % 208;
+        if (((frame[bit >> 3] ^ sent[bit >> 3]) >> (bit & 7)) & 1) continue;
+        frame[bit >> 3] ^= 1 << (bit & 7);
+        n++;
+      }
+
+      t0 = replay_ns();
+      int corrected = ogntp_repair(frame);
+      repair_ns += replay_ns() - t0;
+
+      if (corrected >= 0) {
+        if (memcmp(frame, sent, sizeof(frame))) {
+          wrong++;
+        } else {
+          repaired++;
+        }
+      }
+    }
+    printf("  %d bad bits: %5.1f%% repaired, %d wrong codewords, %6.1f us/frame\n",
+           flips, 100.0 * repaired / BENCH_LDPC_FRAMES, wrong,
+           repair_ns / 1e3 / BENCH_LDPC_FRAMES);
+  }
+}
+
+/* ---- per-packet ufo_t traffic ---- */
+
+#define BENCH_UFO_TARGETS   64
+#define BENCH_UFO_PACKETS   (16 * BENCH_UFO_TARGETS)
+
+static ufo_t bench_fo;
+static ufo_t bench_before[BENCH_UFO_TARGETS], bench_after[BENCH_UFO_TARGETS];
+
+/* what a decoder fills in, for aircraft n at time ms */
+static void Replay_ufo_decode(ufo_t *fop, int n, uint32_t ms)
+{
+  fop->addr        = 0xD00000 + n;
+  fop->protocol    = RF_PROTOCOL_LATEST;
+  fop->airborne    = 1;
+  fop->timestamp   = ms / 1000;
+  fop->gnsstime_ms = ms;
+  fop->latitude    = 48.0 + n * 0.001 + ms * 1e-8;
+  fop->longitude   = 11.0 + ms * 1e-8;
+  fop->altitude    = 1000 + (ms & 63);
+  fop->course      = (ms / 100) % 360;
+  fop->speed       = 60;
+  fop->turnrate    = 3;
+  fop->fla_ns[0]   = n;
+  fop->fla_ew[0]   = -n;
+}
+
+/*
+ * ParseData() + AddTraffic() for a tracked aircraft: clearing fo from
+ * EmptyFO and copying the whole record back as before, vs. clearing it
+ * in place and copying only the part a packet replaces.
+ */
+static void Replay_bench_ufo(const char *path)
+{
+  uint64_t t0, before_ns, after_ns;
+  size_t size = sizeof(ufo_t), hist = sizeof(ufo_t) - UFO_PACKET_SIZE;
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int p = 0; p < BENCH_UFO_PACKETS; p++) {
+      int n = p % BENCH_UFO_TARGETS;
+      uint32_t ms = (r * BENCH_UFO_PACKETS + p) * 150;
+      ufo_t *cip = &bench_before[n];
+      ufo_t *fop = &bench_fo;
+
+      *fop = EmptyFO;
+      Replay_ufo_decode(fop, n, ms);
+      if ((fop->gnsstime_ms - cip->gnsstime_ms > 1200) ||
+          (fop->gnsstime_ms - cip->prevtime_ms > 2600)) {
+        fop->prevtime_ms  = cip->gnsstime_ms;
+        fop->prevcourse   = cip->course;
+        fop->prevheading  = cip->heading;
+        fop->prevaltitude = cip->altitude;
+      } else {
+        fop->prevtime_ms  = cip->prevtime_ms;
+        fop->prevcourse   = cip->prevcourse;
+        fop->prevheading  = cip->prevheading;
+        fop->prevaltitude = cip->prevaltitude;
+      }
+      fop->turnrate    = cip->turnrate;
+      fop->alert       = cip->alert;
+      fop->alert_level = cip->alert_level;
+      *cip = *fop;
+    }
+  }
+  before_ns = replay_ns() - t0;
+
+  t0 = replay_ns();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int p = 0; p < BENCH_UFO_PACKETS; p++) {
+      int n = p % BENCH_UFO_TARGETS;
+      uint32_t ms = (r * BENCH_UFO_PACKETS + p) * 150;
+      ufo_t *cip = &bench_after[n];
+      ufo_t *fop = &bench_fo;
+
+      memset(fop, 0, sizeof(ufo_t));
+      Replay_ufo_decode(fop, n, ms);
+      if ((fop->gnsstime_ms - cip->gnsstime_ms > 1200) ||
+          (fop->gnsstime_ms - cip->prevtime_ms > 2600)) {
+        cip->prevtime_ms  = cip->gnsstime_ms;
+        cip->prevcourse   = cip->course;
+        cip->prevheading  = cip->heading;
+        cip->prevaltitude = cip->altitude;
+      }
+      memcpy(cip, fop, UFO_PACKET_SIZE);
+    }
+  }
+  after_ns = replay_ns() - t0;
+
+  /* record copies read and write every byte, a clear only writes them */
+  printf("ufo_t %zu bytes, %zu of them history kept in place\n", size, hist);
+  printf("  %-10s %6zu bytes moved/packet %8.1f ns/packet\n", "before",
+         4 * size + 2 * hist,
+         (double) before_ns / (BENCH_ROUNDS * BENCH_UFO_PACKETS));
+  printf("  %-10s %6zu bytes moved/packet %8.1f ns/packet\n", "after",
+         size + 2 * UFO_PACKET_SIZE,
+         (double) after_ns  / (BENCH_ROUNDS * BENCH_UFO_PACKETS));
+  printf("  results %s\n",
+         memcmp(bench_before, bench_after, sizeof(bench_before)) ? "DIFFER" : "match");
+}
+
+/* ---- configuration sentences ---- */
+
+#define BENCH_NMEA_SENTENCES  4
+
+/* the sentence types and field counts SoftRF registered as TinyGPSCustom */
+static const struct {
+  const char *type;
+  int fields;
+} bench_nmea_custom[] = {
+  { "PSRFC", 19 }, { "PSRFD", 22 }, { "PSRFS", 2 }, { "PSKVC", 19 },
+};
+
+static TinyGPSCustom bench_custom[19 + 22 + 2 + 19];
+
+static const char *bench_nmea_body[BENCH_NMEA_SENTENCES] = {
+  "$GPRMC,120000.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*",
+  "$GPGGA,120000.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*",
+  "$PSRFC,1,0,1,1,1,1,2,3,1,1,1,1,1,2,0,0,0,0,0*",
+  "$PSRFD,1,2,DD1234,000000,000000,0,0,0,00,0,1,1,1,1,0,0,0,0,0,0,0,0*",
+};
+
+/*
+ * A GNSS input stream with configuration sentences in it: every character
+ * through TinyGPS++ with SoftRF's TinyGPSCustom fields registered, reading
+ * back the fields of the sentence, vs. TinyGPS++ with none registered and
+ * the configuration sentences tokenized once and dispatched on their type.
+ */
+static void Replay_bench_nmea(const char *path)
+{
+  static TinyGPSPlus gps_before, gps_after;
+  char sentence[BENCH_NMEA_SENTENCES][NMEA_BUFFER_SIZE];
+  char buf[NMEA_BUFFER_SIZE];
+  char *f[24];
+  uint64_t t0, before_ns[BENCH_NMEA_SENTENCES], after_ns[BENCH_NMEA_SENTENCES];
+  long before_sum = 0, after_sum = 0;
+  int c = 0;
+
+  for (size_t t = 0; t < sizeof(bench_nmea_custom) / sizeof(bench_nmea_custom[0]); t++)
+    for (int term = 1; term <= bench_nmea_custom[t].fields; term++)
+      bench_custom[c++].begin(gps_before, bench_nmea_custom[t].type, term);
+
+  for (int s = 0; s < BENCH_NMEA_SENTENCES; s++) {
+    strcpy(sentence[s], bench_nmea_body[s]);
+    NMEA_add_checksum(sentence[s], sizeof(sentence[s]) - strlen(sentence[s]));
+  }
+
+  for (int s = 0; s < BENCH_NMEA_SENTENCES; s++) {
+    const char *str = sentence[s];
+    size_t len = strlen(str);
+
+    t0 = replay_ns();
+    for (int r = 0; r < BENCH_ROUNDS * 16; r++) {
+      for (size_t i = 0; i < len; i++)
+        gps_before.encode(str[i]);
+      for (int k = 0; k < c; k++)
+        if (bench_custom[k].isUpdated())
+          before_sum += atoi(bench_custom[k].value());
+    }
+    before_ns[s] = replay_ns() - t0;
+
+    t0 = replay_ns();
+    for (int r = 0; r < BENCH_ROUNDS * 16; r++) {
+      for (size_t i = 0; i < len; i++)
+        gps_after.encode(str[i]);
+      if (str[1] == 'P' && str[2] == 'S') {
+        int n = NMEA_tokenize(str, len, buf, sizeof(buf), f, 24);
+        for (int k = 1; k < n; k++)
+          after_sum += atoi(f[k]);
+      }
+    }
+    after_ns[s] = replay_ns() - t0;
+  }
+
+  printf("%d TinyGPSCustom fields registered before, none after\n", c);
+  for (int s = 0; s < BENCH_NMEA_SENTENCES; s++)
+    printf("  %.5s %8.1f ns/sentence before %8.1f after\n", sentence[s] + 1,
+           (double) before_ns[s] / (BENCH_ROUNDS * 16),
+           (double) after_ns[s]  / (BENCH_ROUNDS * 16));
+  printf("  results %s\n", before_sum == after_sum ? "match" : "DIFFER");
+}
+
+#if __SIZEOF_LONG__ == 4   /* uCDB takes an unsigned long for 4 bytes */
+/* uCDB on stdio, as it runs over FatFS on the devices */
+class BenchFile
+{
+public:
+  FILE *f;
+  BenchFile(FILE *fp = NULL) : f(fp) {}
+  operator bool() { return f != NULL; }
+  unsigned long size() { long p = ftell(f); fseek(f, 0, SEEK_END);
+                         long s = ftell(f); fseek(f, p, SEEK_SET); return s; }
+  unsigned long position() { return ftell(f); }
+  bool seek(unsigned long pos) { return fseek(f, pos, SEEK_SET) == 0; }
+  int read() { return fgetc(f); }
+  int read(void *buf, unsigned int n) { return fread(buf, 1, n, f); }
+  void close() { if (f) fclose(f); f = NULL; }
+};
+
+class BenchFS
+{
+public:
+  bool exists(const char *name) { return access(name, R_OK) == 0; }
+  BenchFile open(const char *name) { return BenchFile(fopen(name, "rb")); }
+};
+
+#include "uCDB.hpp"
+
+static BenchFS bench_fs;
+#endif /* __SIZEOF_LONG__ */
+
+static bool bench_adb_pread(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+  return pread(*(int *) ctx, buf, len, offset) == (ssize_t) len;
+}
+
+#define BENCH_ADB_LOOKUPS  200000
+
+/*
+ * Aircraft data base: the ADB file memory-mapped and with a pread() per
+ * seed and record, as with sector reads from flash, vs. uCDB findKey() and
+ * readValue() byte by byte on the CDB of the same aircrafts, if given.
+ */
+static void Replay_bench_adb(const char *path)
+{
+  static uint32_t addr[BENCH_ADB_LOOKUPS];
+  adb_t adb_map, adb_file;
+  adb_record_t rec;
+  uint64_t t0, map_ns, file_ns;
+  int found_map = 0, found_file = 0, n = 0, fd;
+
+  if (path == NULL || !ADB_mmap(&adb_map, path)) {
+    fprintf(stderr, "-b adb: no ADB file given\n");
+    exit(EXIT_FAILURE);
+  }
+  fd = open(path, O_RDONLY);
+  ADB_open(&adb_file, bench_adb_pread, &fd);
+
+  /* the addresses in the file, in random order, and as many misses */
+  const adb_header_t *hdr = &adb_map.hdr;
+  for (uint32_t s = 0; s < hdr->records && n < BENCH_ADB_LOOKUPS / 2; s++) {
+    const uint8_t *r = adb_map.map + hdr->data + s * adb_map.rec_size;
+    addr[n++] = r[0] | (r[1] << 8) | (r[2] << 16);
+  }
+  srandom(1);
+  for (int i = n; i < BENCH_ADB_LOOKUPS; i++)
+    addr[i] = i < 2 * n ? random() & 0xFFFFFF : addr[random() % n];
+  for (int i = BENCH_ADB_LOOKUPS - 1; i > 0; i--) {
+    int j = random() % (i + 1);
+    uint32_t a = addr[i]; addr[i] = addr[j]; addr[j] = a;
+  }
+
+  t0 = replay_ns();
+  for (int i = 0; i < BENCH_ADB_LOOKUPS; i++)
+    found_map += ADB_find(&adb_map, addr[i], &rec);
+  map_ns = replay_ns() - t0;
+
+  t0 = replay_ns();
+  for (int i = 0; i < BENCH_ADB_LOOKUPS; i++)
+    found_file += ADB_find(&adb_file, addr[i], &rec);
+  file_ns = replay_ns() - t0;
+
+  printf("%u aircrafts, %u byte records\n", hdr->records, adb_map.rec_size);
+  printf("  %-10s %8.1f ns/lookup, %d found\n", "adb mmap",
+         (double) map_ns / BENCH_ADB_LOOKUPS, found_map);
+  printf("  %-10s %8.1f ns/lookup, %d found\n", "adb pread",
+         (double) file_ns / BENCH_ADB_LOOKUPS, found_file);
+
+  const char *cdb_path = replay_bench_arg;
+#if __SIZEOF_LONG__ != 4
+  if (cdb_path != NULL) {
+    printf("  no uCDB with a %d byte long\n", (int) sizeof(long));
+    cdb_path = NULL;
+  }
+#else
+  if (cdb_path != NULL) {
+    uCDB<BenchFS, BenchFile> ucdb(bench_fs);
+    char key[8], out[64];
+    int found_cdb = 0, same = 0, c;
+
+    if (ucdb.open(cdb_path) != CDB_OK) {
+      fprintf(stderr, "-b adb: invalid CDB %s\n", cdb_path);
+      exit(EXIT_FAILURE);
+    }
+
+    t0 = replay_ns();
+    for (int i = 0; i < BENCH_ADB_LOOKUPS; i++) {
+      snprintf(key, sizeof(key), "%06X", addr[i]);
+      if (ucdb.findKey(key, strlen(key)) == KEY_FOUND) {
+        int len = 0;
+        while ((c = ucdb.readValue()) != -1 && len < (int) sizeof(out) - 1)
+          out[len++] = (char) c;
+        out[len] = '\0';
+        found_cdb++;
+      }
+    }
+    uint64_t cdb_ns = replay_ns() - t0;
+    ucdb.close();
+
+    /* the same data, in the "type|reg|cn" of the CDB */
+    if (ucdb.open(cdb_path) == CDB_OK) {
+      for (int i = 0; i < BENCH_ADB_LOOKUPS; i += 97) {
+        snprintf(key, sizeof(key), "%06X", addr[i]);
+        bool in_cdb = (ucdb.findKey(key, strlen(key)) == KEY_FOUND);
+        int len = 0;
+        while (in_cdb && (c = ucdb.readValue()) != -1 && len < (int) sizeof(out) - 1)
+          out[len++] = (char) c;
+        out[len] = '\0';
+        bool in_adb = ADB_find(&adb_map, addr[i], &rec);
+        char joined[3 * ADB_FIELD_MAX + 3];
+        snprintf(joined, sizeof(joined), "%s|%s|%s", rec.type, rec.reg, rec.cn);
+        same += (in_cdb == in_adb && (!in_adb || strcmp(out, joined) == 0));
+      }
+      ucdb.close();
+    }
+
+    printf("  %-10s %8.1f ns/lookup, %d found\n", "cdb stdio",
+           (double) cdb_ns / BENCH_ADB_LOOKUPS, found_cdb);
+    printf("  records %s\n", same == (BENCH_ADB_LOOKUPS + 96) / 97 ? "match" : "DIFFER");
+  }
+#endif /* __SIZEOF_LONG__ */
+
+  close(fd);
+  ADB_munmap(&adb_map);
+}
+
+static const struct {
+  const char *name;
+  void (*run)(const char *);
+} Replay_benches[] = {
+  { "crc",  Replay_bench_crc  },
+  { "json", Replay_bench_json },
+  { "uat",  Replay_bench_uat  },
+  { "ldpc", Replay_bench_ldpc },
+  { "ufo",  Replay_bench_ufo  },
+  { "nmea", Replay_bench_nmea },
+  { "adb",  Replay_bench_adb  },
+};
+
+static void Replay_usage(const char *name)
+{
+  fprintf(stderr,
+    "usage: %s [-a none|distance|vector|legacy] [-p legacy|latest] [-v] log\n"
+    "       %s -b crc|json|uat|ldpc|ufo|nmea|adb [aircraft.json|frames.txt|ogn.adb [ogn.cdb]]\n"
+    "  -a  collision prediction method (default: legacy)\n"
+    "  -p  radio protocol of the $PSRFI packets (default: latest)\n"
+    "  -v  print the NMEA output on stdout\n"
+    "  -b  run a micro-benchmark and exit\n", name, name);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+  uint8_t alarm    = TRAFFIC_ALARM_LEGACY;
+  uint8_t protocol = RF_PROTOCOL_LATEST;
+  int bench = -1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "a:p:vb:")) != -1) {
+    switch (opt)
+    {
+    case 'b':
+      for (size_t b = 0; b < sizeof(Replay_benches) / sizeof(Replay_benches[0]); b++) {
+        if (!strcmp(optarg, Replay_benches[b].name)) {
+          bench = b;
+        }
+      }
+      if (bench < 0) {
+        Replay_usage(argv[0]);
+      }
+      break;
+    case 'a':
+      if      (!strcmp(optarg, "none"))     alarm = TRAFFIC_ALARM_NONE;
+      else if (!strcmp(optarg, "distance")) alarm = TRAFFIC_ALARM_DISTANCE;
+      else if (!strcmp(optarg, "vector"))   alarm = TRAFFIC_ALARM_VECTOR;
+      else if (!strcmp(optarg, "legacy"))   alarm = TRAFFIC_ALARM_LEGACY;
+      else Replay_usage(argv[0]);
+      break;
+    case 'p':
+      if      (!strcmp(optarg, "legacy"))   protocol = RF_PROTOCOL_LEGACY;
+      else if (!strcmp(optarg, "latest"))   protocol = RF_PROTOCOL_LATEST;
+      else Replay_usage(argv[0]);
+      break;
+    case 'v':
+      replay_verbose = true;
+      break;
+    default:
+      Replay_usage(argv[0]);
+    }
+  }
+  if (bench >= 0) {
+    replay_bench_arg = optind + 1 < argc ? argv[optind + 1] : NULL;
+    Replay_benches[bench].run(optind < argc ? argv[optind] : NULL);
+    return 0;
+  }
+  if (optind != argc - 1) {
+    Replay_usage(argv[0]);
+  }
+
+  FILE *fp = fopen(argv[optind], "r");
+  if (fp == NULL) {
+    perror(argv[optind]);
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<replay_line_t> lines;
+  bool ok = Replay_load(fp, lines);
+  fclose(fp);
+  if (!ok) {
+    fprintf(stderr, "%s: no time stamps in the log\n", argv[optind]);
+    exit(EXIT_FAILURE);
+  }
+
+  memset(settings, 0, sizeof(settings_t));
+  settings->mode          = SOFTRF_MODE_NORMAL;
+  settings->rf_protocol   = protocol;
+  settings->band          = RF_BAND_EU;
+  settings->aircraft_type = AIRCRAFT_TYPE_GLIDER;
+  settings->alarm         = alarm;
+  settings->nmea_g        = false;
+  settings->nmea_p        = false;
+  settings->nmea_l        = true;
+  settings->nmea_s        = true;
+  settings->nmea_out      = DEST_UART;
+  settings->gdl90_in      = DEST_NONE;
+
+  ThisAircraft.addr          = Replay_getChipId();
+  ThisAircraft.aircraft_type = settings->aircraft_type;
+  ThisAircraft.protocol      = protocol;
+  ThisAircraft.stealth       = false;
+  ThisAircraft.no_track      = false;
+
+  replay_decode   = &legacy_decode;
+  protocol_decode = &Replay_timed_decode;
+
+  for (int s = 0; s < STAGE_COUNT; s++) {
+    stage_ns[s].reserve(lines.size());
+  }
+
+  virtual_ms = lines[0].ms;
+  setTime(lines[0].sec);
+
+  Traffic_setup();
+
+  uint32_t ExportTimeMarker = 0;
+  uint64_t start_ns = replay_ns();
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    const replay_line_t &line = lines[i];
+    const char *str = line.text.c_str();
+
+    virtual_ms = line.ms;
+    if (line.sec != now()) {
+      setTime(line.sec);
+    }
+    RF_time = now();
+
+    if (str[0] == '$' && str[1] == 'G') {
+      Replay_GNSS(str, line.text.length());
+    } else if (strncmp(str, "$PSRFI,", 7) == 0) {
+      Replay_Packet(str, line.sec);
+    }
+
+    if (isValidFix()) {
+      uint64_t t0 = replay_ns();
+      uint32_t marker = UpdateTrafficTimeMarker;
+      Traffic_loop();
+      if (UpdateTrafficTimeMarker != marker) {
+        stage_ns[STAGE_LOOP].push_back(replay_ns() - t0);
+        Replay_alarms();
+      }
+    }
+
+    if (millis() - ExportTimeMarker > 1000) {
+      uint64_t t0 = replay_ns();
+      NMEA_Export();
+      NMEA_Flush();
+      stage_ns[STAGE_EXPORT].push_back(replay_ns() - t0);
+      ExportTimeMarker = millis();
+    }
+
+    NMEA_Flush();
+  }
+
+  Replay_report(replay_ns() - start_ns);
+
+  return 0;
+}
+
+#endif /* RASPBERRY_PI && SOFTRF_REPLAY */
@@ -827,6 +827,22 @@ static size_t SAMD_USB_write(const uint8_t *buffer, size_t size)
 #endif /* USE_TINYUSB */
 }
 
+/* how much write() takes now in one piece, it drops a larger block whole */
+static size_t SAMD_USB_room()
+{
+#if !defined(USE_TINYUSB)
+  return (size_t) -1;     /* write() stores what fits in USB_TX_FIFO */
+#else
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+#endif /* USE_TINYUSB */
+}
+
 IODev_ops_t SAMD_USBSerial_ops = {
   "SAMD USBSerial",
   SAMD_USB_setup,
@@ -834,7 +850,8 @@ IODev_ops_t SAMD_USBSerial_ops = {
   SAMD_USB_fini,
   SAMD_USB_available,
   SAMD_USB_read,
-  SAMD_USB_write
+  SAMD_USB_write,
+  SAMD_USB_room
 };
 
 const SoC_ops_t SAMD_ops = {
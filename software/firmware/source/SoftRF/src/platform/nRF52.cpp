@@ -48,6 +48,7 @@
 #include "../system/Time.h"
 
 #include "uCDB.hpp"
+#include "../system/ADB.h"
 
 #if defined(USE_BLE_MIDI)
 #include <bluefruit.h>
@@ -261,6 +262,54 @@ ui_settings_t ui_settings = {
 ui_settings_t *ui;
 uCDB<FatFileSystem, File> ucdb(fatfs);
 
+static File  adb_file;
+static adb_t ogn_adb;
+static bool  ADB_is_hashed      = false;   /* ogn.adb rather than ogn.cdb */
+
+static bool nRF52_ADB_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+  File *file = (File *) ctx;
+
+  return file->seek(offset) && file->read((uint8_t *) buf, len) == (int) len;
+}
+
+/* type, registration and CN of an aircraft, false if it is not in the DB */
+static bool nRF52_ADB_record(uint32_t id, adb_record_t *rec)
+{
+  char key[8];
+  char out[64];
+  uint8_t tokens[3] = { 0 };
+  int c, i = 0, token_cnt = 0;
+
+  if (ADB_is_hashed) {
+    return ADB_find(&ogn_adb, id, rec);
+  }
+
+  snprintf(key, sizeof(key),"%06X", id);
+
+  if (ucdb.findKey(key, strlen(key)) != KEY_FOUND) {
+    return false;
+  }
+
+  while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
+    if (c == '|') {
+      if (token_cnt < (sizeof(tokens) - 1)) {
+        token_cnt++;
+        tokens[token_cnt] = i+1;
+      }
+      c = 0;
+    }
+    out[i++] = (char) c;
+  }
+  out[i] = 0;
+
+  snprintf(rec->type, sizeof(rec->type), "%s", out + tokens[0]);
+  snprintf(rec->reg,  sizeof(rec->reg),  "%s", out + tokens[1]);
+  snprintf(rec->cn,   sizeof(rec->cn),   "%s", out + tokens[2]);
+
+  return true;
+}
+
 #if !defined(EXCLUDE_IMU)
 #define IMU_UPDATE_INTERVAL 500 /* ms */
 
@@ -690,46 +739,19 @@ static void nRF52_post_init()
     /* EPD back light off */
     digitalWrite(SOC_GPIO_PIN_EPD_BLGT, LOW);
 
-    char key[8];
-    char out[64];
-    uint8_t tokens[3] = { 0 };
-    cdbResult rt;
-    int c, i = 0, token_cnt = 0;
+    adb_record_t rec;
 
     int acfts;
     char *reg, *mam, *cn;
     reg = mam = cn = NULL;
 
     if (ADB_is_open) {
-      acfts = ucdb.recordsNumber();
-
-      snprintf(key, sizeof(key),"%06X", ThisAircraft.addr);
+      acfts = ADB_is_hashed ? ogn_adb.hdr.records : ucdb.recordsNumber();
 
-      rt = ucdb.findKey(key, strlen(key));
-
-      switch (rt) {
-        case KEY_FOUND:
-          while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
-            if (c == '|') {
-              if (token_cnt < (sizeof(tokens) - 1)) {
-                token_cnt++;
-                tokens[token_cnt] = i+1;
-              }
-              c = 0;
-            }
-            out[i++] = (char) c;
-          }
-          out[i] = 0;
-
-          reg = out + tokens[1];
-          mam = out + tokens[0];
-          cn  = out + tokens[2];
-
-          break;
-
-        case KEY_NOT_FOUND:
-        default:
-          break;
+      if (nRF52_ADB_record(ThisAircraft.addr, &rec)) {
+        reg = rec.reg;
+        mam = rec.type;
+        cn  = rec.cn;
       }
 
       reg = (reg != NULL) && strlen(reg) ? reg : (char *) "REG: N/A";
@@ -1833,6 +1855,18 @@ static size_t nRF52_USB_write(const uint8_t *buffer, size_t size)
   return rval;
 }
 
+/* how much write() takes now in one piece, it drops a larger block whole */
+static size_t nRF52_USB_room()
+{
+  if (!USBSerial) {
+    return (size_t) -1;   /* no host, write() discards anything */
+  }
+
+  size_t avail = USBSerial.availableForWrite();
+
+  return (avail > 0 ? avail - 1 : 0);
+}
+
 IODev_ops_t nRF52_USBSerial_ops = {
   "nRF52 USBSerial",
   nRF52_USB_setup,
@@ -1840,12 +1874,28 @@ IODev_ops_t nRF52_USBSerial_ops = {
   nRF52_USB_fini,
   nRF52_USB_available,
   nRF52_USB_read,
-  nRF52_USB_write
+  nRF52_USB_write,
+  nRF52_USB_room
 };
 
 static bool nRF52_ADB_setup()
 {
   if (FATFS_is_mounted) {
+    const char adbName[] = "/Aircrafts/ogn.adb";
+
+    if (fatfs.exists(adbName)) {
+      adb_file = fatfs.open(adbName);
+      if (adb_file && ADB_open(&ogn_adb, nRF52_ADB_read, &adb_file)) {
+        ADB_is_hashed = ADB_is_open = true;
+        return ADB_is_open;
+      }
+      Serial.print("Invalid ADB: ");
+      Serial.println(adbName);
+      if (adb_file) {
+        adb_file.close();
+      }
+    }
+
     const char fileName[] = "/Aircrafts/ogn.cdb";
 
     if (ucdb.open(fileName) != CDB_OK) {
@@ -1862,7 +1912,12 @@ static bool nRF52_ADB_setup()
 static bool nRF52_ADB_fini()
 {
   if (ADB_is_open) {
-    ucdb.close();
+    if (ADB_is_hashed) {
+      adb_file.close();
+      ADB_is_hashed = false;
+    } else {
+      ucdb.close();
+    }
     ADB_is_open = false;
   }
 
@@ -1870,67 +1925,37 @@ static bool nRF52_ADB_fini()
 }
 
 /*
+ * One aircraft ADB query reads one bucket seed and one record.
  * One aircraft CDB (20000+ records) query takes:
  * 1)     FOUND : 5-7 milliseconds
  * 2) NOT FOUND :   3 milliseconds
  */
 static bool nRF52_ADB_query(uint8_t type, uint32_t id, char *buf, size_t size)
 {
-  char key[8];
-  char out[64];
-  uint8_t tokens[3] = { 0 };
-  cdbResult rt;
-  int c, i = 0, token_cnt = 0;
-  bool rval = false;
+  adb_record_t rec;
 
-  if (!ADB_is_open) {
-    return rval;
+  if (!ADB_is_open || !nRF52_ADB_record(id, &rec)) {
+    return false;
   }
 
-  snprintf(key, sizeof(key),"%06X", id);
-
-  rt = ucdb.findKey(key, strlen(key));
-
-  switch (rt) {
-    case KEY_FOUND:
-      while ((c = ucdb.readValue()) != -1 && i < (sizeof(out) - 1)) {
-        if (c == '|') {
-          if (token_cnt < (sizeof(tokens) - 1)) {
-            token_cnt++;
-            tokens[token_cnt] = i+1;
-          }
-          c = 0;
-        }
-        out[i++] = (char) c;
-      }
-      out[i] = 0;
-
-      switch (ui->idpref)
-      {
-      case ID_TAIL:
-        snprintf(buf, size, "CN: %s",
-          strlen(out + tokens[2]) ? out + tokens[2] : "N/A");
-        break;
-      case ID_MAM:
-        snprintf(buf, size, "%s",
-          strlen(out + tokens[0]) ? out + tokens[0] : "Unknown");
-        break;
-      case ID_REG:
-      default:
-        snprintf(buf, size, "%s",
-          strlen(out + tokens[1]) ? out + tokens[1] : "REG: N/A");
-        break;
-      }
-
-      rval = true;
-      break;
-
-    case KEY_NOT_FOUND:
-    default:
-      break;
+  switch (ui->idpref)
+  {
+  case ID_TAIL:
+    snprintf(buf, size, "CN: %s",
+      strlen(rec.cn) ? rec.cn : "N/A");
+    break;
+  case ID_MAM:
+    snprintf(buf, size, "%s",
+      strlen(rec.type) ? rec.type : "Unknown");
+    break;
+  case ID_REG:
+  default:
+    snprintf(buf, size, "%s",
+      strlen(rec.reg) ? rec.reg : "REG: N/A");
+    break;
   }
 
-  return rval;
+  return true;
 }
 
 DB_ops_t nRF52_ADB_ops = {
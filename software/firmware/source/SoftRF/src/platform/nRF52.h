@@ -27,8 +27,11 @@
 #include <pcf8563.h>
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
-#define MAX_TRACKING_OBJECTS    8
+#if !defined(MAX_TRACKING_OBJECTS)
+#define MAX_TRACKING_OBJECTS    32
+#endif
 #define MAX_NMEA_OBJECTS        6
+#define NMEA_QUEUE_SIZE         1024    /* per NMEA output */
 
 #define DEFAULT_SOFTRF_MODEL    SOFTRF_MODEL_BADGE
 
@@ -285,6 +288,7 @@ struct rst_info {
 #define USE_EPAPER                 //  +    kb
 #define USE_EPD_TASK
 #define USE_TIME_SLOTS
+#define USE_PROFILER
 
 /* Experimental */
 //#define USE_WEBUSB_SERIAL
@@ -300,7 +304,7 @@ struct rst_info {
 
 /* FTD-012 data port protocol version 8 and 9 */
 #define PFLAA_EXT1_FMT  ",%d,%d,%d"
-#define PFLAA_EXT1_ARGS ,Container[i].no_track,data_source,Container[i].rssi
+#define PFLAA_EXT1_ARGS ,fop->no_track,data_source,fop->rssi
 
 #if defined(USE_PWM_SOUND)
 #define SOC_GPIO_PIN_BUZZER   (hw_info.rf != RF_IC_SX1262 ? SOC_UNUSED_PIN           : \
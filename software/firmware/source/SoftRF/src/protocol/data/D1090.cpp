@@ -110,7 +110,8 @@ void D1090_Export()
 #endif /* ENABLE_D1090_INPUT || ENABLE_RTLSDR || ENABLE_HACKRF || ENABLE_MIRISDR */
 
   if (settings->d1090 != DEST_NONE && isValidFix()) {
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    for (int n=0; n < Traffic_Count(); n++) {
+      int i = traffic_slots[n];
       if (Container[i].addr && (this_moment - Container[i].timestamp) <= EXPORT_EXPIRATION_TIME) {
 
         distance = Container[i].distance;
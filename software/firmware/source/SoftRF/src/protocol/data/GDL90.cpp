@@ -515,7 +515,9 @@ void GDL90_Export()
       size = makeGeometricAltitude(buf, &ThisAircraft);
       GDL90_Out(buf, size);
 
-      for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+      for (int n=0; n < Traffic_Count(); n++) {
+
+        int i = traffic_slots[n];
 
         // do not echo GDL90 traffic data back to its source
         if (Container[i].addr
@@ -22,10 +22,23 @@
 #include "../radio/Legacy.h"
 #include "NMEA.h"
 #include "GNS5892.h"
+#include <lib_crc.h>
 
 static ufo_t fo1090;
 static char buf1090[256];
-static unsigned char msg[14];
+
+// Complete DF17/18 squitters are drained from Serial2 into this ring,
+// already in binary, and decoded from there a batch at a time.
+// The decoders read the current frame through msg[].
+typedef struct {
+    unsigned char msg[14];
+    uint8_t rssi;
+} frame1090_t;
+static frame1090_t ring1090[GNS5892_RING_SIZE];
+static uint16_t ring_head = 0, ring_tail = 0;
+static unsigned char *msg;
+
+static gns5892_stats_t stats1090, counts1090;
 
 typedef struct mmstruct {
     // variables filled in by message parsing:
@@ -415,45 +428,29 @@ static void CPRRelative_setup()
 
 static int find_traffic_by_addr(uint32_t addr)
 {
-    for (int i=0; i<MAX_TRACKING_OBJECTS; i++) {
-        if (Container[i].addr == addr) {
-            if (Container[i].protocol == RF_PROTOCOL_ADSB_1090)
-                return i;      // found
-            if (ThisAircraft.timestamp - Container[i].timestamp <= ENTRY_EXPIRATION_TIME)
-                return -1;     // already tracked via other means
-            // was tracked via other means, but expired - clear this slot
-            Container[i].addr = 0;
-            return MAX_TRACKING_OBJECTS;
-        }
-    }
-    return MAX_TRACKING_OBJECTS;    // not found
+    int i = Traffic_Find(addr);
+    if (i < 0)
+        return MAX_TRACKING_OBJECTS;    // not found
+    if (Container[i].protocol == RF_PROTOCOL_ADSB_1090)
+        return i;      // found
+    if (ThisAircraft.timestamp - Container[i].timestamp <= ENTRY_EXPIRATION_TIME)
+        return -1;     // already tracked via other means
+    // was tracked via other means, but expired - clear this slot
+    Traffic_Remove(i);
+    return MAX_TRACKING_OBJECTS;
 }
 
 // make room for a new entry
-static int add_traffic_by_dist(float distance)
+static int add_traffic_by_dist(ufo_t *fop)
 {
-    int i;
-    // replace an empty object if found
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr == 0) {
-        return i;
-      }
-    }
-    // replace an expired object if found
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (ThisAircraft.timestamp - Container[i].timestamp > ENTRY_EXPIRATION_TIME) {
-        return i;
-      }
-    }
-    // may replace a non-expired object: identify a less important one
-    for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].distance > distance
-       && Container[i].alarm_level == ALARM_LEVEL_NONE
-       && Container[i].addr != settings->follow_id) {
-            return i;
-      }
-    }
-    return MAX_TRACKING_OBJECTS;
+    // replace an empty (or expired) object if found
+    int i = Traffic_Free_Slot();
+    // may replace a non-expired object: a farther, less important one
+    if (i < 0)
+        i = Traffic_Evict_Slot(fop, false);
+    if (i < 0)
+        return MAX_TRACKING_OBJECTS;
+    return i;
 }
 
 // fill in certain fields from each message type
@@ -473,12 +470,13 @@ static void update_traffic_position()
     if (i < 0)        // already tracked via other means
         return;
     if (i == MAX_TRACKING_OBJECTS) {  // not found
-        i = add_traffic_by_dist(fo1090.distance);
+        i = add_traffic_by_dist(&fo1090);
         if (i == MAX_TRACKING_OBJECTS)    // no room
             return;
+        ufo_t new_fo = EmptyFO;
+        new_fo.addr = fo1090.addr;
+        Traffic_Store(i, &new_fo);
         cip = &Container[i];
-        *cip = EmptyFO;
-        cip->addr = fo1090.addr;
         cip->altitude  = fo1090.altitude;
         // altitude is still pressure altitude, try and correct
         if (baro_chip != NULL)
@@ -776,22 +774,14 @@ static bool parse_position()
     if (decodeCPRrelative() < 0)        // error decoding lat/lon
         return false;
 
-    int32_t y = (int32_t)(111300.0 * (fo1090.latitude - reflat)); // meters
-    int32_t x = (int32_t)(111300.0 * (fo1090.longitude - reflon) * CosLat(reflat));
-    fo1090.dx = x;
-    fo1090.dy = y;
-    fo1090.distance = (float)iapproxHypotenuse1(x, y);
+    LocalFrame_anchor(ThisAircraft.latitude, ThisAircraft.longitude);
+    LocalFrame_xy(fo1090.latitude, fo1090.longitude, &fo1090.dx, &fo1090.dy);
+    fo1090.distance = (float)LocalFrame_distance(fo1090.dx, fo1090.dy);
     if (fo1090.addr != settings->follow_id) {
         if (fo1090.distance > (15*1852))   // 15 nm
             return false;
     }
-    if (fo1090.distance == 0) {
-        fo1090.bearing = 0;
-    } else {
-        fo1090.bearing = iatan2_approx(y,x);
-        if (fo1090.bearing < 0)
-            fo1090.bearing += 360;
-    }
+    fo1090.bearing = LocalFrame_bearing(fo1090.dx, fo1090.dy);
 
     update_traffic_position();
 
@@ -906,48 +896,15 @@ static bool parse_velocity()
 }
 
 
-// assume the n chars in buf[] include the starting '*' but not the ending ';'
+// the frame in msg[] has passed the CRC, and is DF17 or DF18
 
-static bool parse(char *buf, int n)
+static bool parse(uint8_t rssi)
 {
     mm = EmptyMsg;      // start with a clean slate of all zeros
     mm.msgtype = ' ';
-    int k=0;
-    int i=1;
-    if (buf[0] == '*') {
-        if (n != 29)
-            return false;     // not a 112-bit ES
-        mm.rssi = 0;
-    } else
-    if (buf[0] == '+') {
-        if (n != 31)
-            return false;     // not a 112-bit ES
-        mm.rssi = (hex2bin(buf[1]) << 4) | hex2bin(buf[2]);
-        i = 3;    // point to DF
-    }
-    else
-        return false;     // not a valid GNS5892 sentence
-
-    // parse just the first 4 bytes for now
-    int j=0;
-    while (j < 4) {
-        msg[j++] = (hex2bin(buf[i]) << 4) | hex2bin(buf[i+1]);
-        i += 2;
-    }
-
+    mm.rssi = rssi;
     mm.frame = msg[0]>>3;    // Downlink Format
 
-    if (mm.frame != 17 && mm.frame != 18)
-        return false;
-
-    // convert the rest of the message from hex to binary
-    n -= 6;               // skip the PI (checksum field)
-    j=4;
-    while (i < n) {
-        msg[j++] = (hex2bin(buf[i]) << 4) | hex2bin(buf[i+1]);
-        i += 2;
-    }
-
 /*
 To determine whether you receive an ADS-B message or a TIS-B message you should start
 looking at the Downlink Format (DF, first 5 bits of the message) if the DF = 17, then
@@ -980,12 +937,8 @@ https://aviation.stackexchange.com/questions/17610/what-icao-codes-are-reserved-
 
     fo1090 = EmptyFO;   // start with a clean slate of all zeros
 
-    // ICAO address
+    // ICAO address, already screened in queue1090()
     fo1090.addr = (msg[1] << 16) | (msg[2] << 8) | msg[3];
-    if (fo1090.addr == ThisAircraft.addr)        // somehow seeing ourselves
-        return false;
-    if (fo1090.addr == settings->ignore_id)      // ID told in settings to ignore
-        return false;
 
     // parsing of the 56-bit ME - just DF 17-18:
 
@@ -1063,6 +1016,48 @@ void gns5892_setup()
 }
 
 
+// take a complete '*' or '+' sentence (n chars, without the ending ';')
+// into the ring - only 112-bit DF17/18 squitters from others get in
+static void queue1090(const char *buf, int n)
+{
+    int i;
+    uint8_t rssi = 0;
+
+    if (buf[0] == '*' && n == 29) {
+        i = 1;
+    } else if (buf[0] == '+' && n == 31) {
+        rssi = (hex2bin(buf[1]) << 4) | hex2bin(buf[2]);
+        i = 3;    // point to DF
+    } else {
+        ++counts1090.rejected;    // short Mode S, or garbled
+        return;
+    }
+
+    unsigned char head[4];
+    for (int j=0; j<4; j++, i+=2)
+        head[j] = (hex2bin(buf[i]) << 4) | hex2bin(buf[i+1]);
+
+    int frame = head[0] >> 3;
+    uint32_t addr = (head[1] << 16) | (head[2] << 8) | head[3];
+    if ((frame != 17 && frame != 18)
+     || addr == ThisAircraft.addr           // somehow seeing ourselves
+     || addr == settings->ignore_id) {      // ID told in settings to ignore
+        ++counts1090.rejected;
+        return;
+    }
+
+    if ((uint16_t)(ring_tail - ring_head) >= GNS5892_RING_SIZE) {
+        ++counts1090.dropped;     // decoding fell behind
+        return;
+    }
+    frame1090_t *fp = &ring1090[ring_tail % GNS5892_RING_SIZE];
+    memcpy(fp->msg, head, 4);
+    for (int j=4; j<14; j++, i+=2)
+        fp->msg[j] = (hex2bin(buf[i]) << 4) | hex2bin(buf[i+1]);
+    fp->rssi = rssi;
+    ++ring_tail;
+}
+
 // called from NMEA.cpp NMEA_loop() when appropriate
 void gns5892_loop()
 {
@@ -1071,53 +1066,89 @@ void gns5892_loop()
 
   CPRRelative_precomp();   // usually does nothing
 
-  int avail = Serial2.available();
-  if (avail <= 0)
-      return;
-  if (avail > (GNS5892_INPUT_BUF_SIZE - 256))    // input buffer is getting full
-      Serial2.readBytes(buf1090, 256);           // discard some input data
-
-  static bool input_complete = false;
+  // drain everything the UART holds, so that its buffer never overflows
   static int n = 0;  // inputchars
-  if (input_complete)
-      n = 0;          // start a new input sentence
-  input_complete = false;
-  while (Serial2.available()) {  // loop until a full sentence or no more data
-      char c = Serial2.read();
+  char chunk[64];
+  int avail = Serial2.available();
+  while (avail > 0) {
+    int len = Serial2.readBytes(chunk, (avail < (int) sizeof(chunk) ? avail : sizeof(chunk)));
+    if (len <= 0)
+        break;
+    avail -= len;
+    for (int k=0; k<len; k++) {
+      char c = chunk[k];
       if (c=='*' || c=='+' || c=='#') {
+          if (n > 0)
+              ++counts1090.dropped;  // sentence cut short
           buf1090[0] = c;            // start new sentence, drop any preceding data
           n = 1;
       } else if (n == 0) {      // wait for a valid starting char
           continue;
       } else if (c==';' || c=='\r' || c=='\n') {   // completed sentence
-          if (n > 14 /* && n <= 32 */ ) {
-              input_complete = true;
-              break;
+          if (n <= 14) {
+              // invalid, start over
+          } else if (buf1090[0] == '#') {            // response to commands
+              if (rx1090found == false) {
+                if (buf1090[1]=='4' && buf1090[2]=='9' && buf1090[5]=='3') {  // response to "play"
+                    rx1090found = true;
+                    Serial.println(">>> GNS5892 module responded");
+                }
+              }
+              Serial.write(buf1090, n);           // copy to console
+              Serial.println("");
+              NMEA_bridge_sent = true;
+          } else {                                   // ADS-B data received
+              queue1090(buf1090, n);
           }
-          n = 0;                 // invalid, start over
-      } else {
+          n = 0;
+      } else if (n < (int) sizeof(buf1090)) {
           buf1090[n++] = c;
+      } else {
+          ++counts1090.dropped;     // runaway sentence
+          n = 0;
       }
+    }
   }
   yield();
-  if (! input_complete || n == 0)
-      return;
 
-  if (buf1090[0] == '*' || buf1090[0] == '+') {    // ADS-B data received
-      (void) parse(buf1090, n);
+  // then decode a batch - CRC first, position range filter in parse_position()
+  int batch = 0;
+  while (ring_head != ring_tail && batch < GNS5892_BATCH_SIZE) {
+      frame1090_t *fp = &ring1090[ring_head % GNS5892_RING_SIZE];
+      msg = fp->msg;
+      uint32_t pi = ((uint32_t) msg[11] << 16) | (msg[12] << 8) | msg[13];
+      if (crc_modes_block(0, msg, 11) != pi) {
+          ++counts1090.bad_crc;
+      } else {
+          if (parse(fp->rssi))
+              ++counts1090.accepted;
+          else
+              ++counts1090.rejected;
+      }
+      ++ring_head;
+      ++batch;
+  }
+  if (batch > 0) {
       yield();
-  } else if (buf1090[0] == '#') {                  // response to commands
-      if (rx1090found == false) {
-        if (buf1090[1]=='4' && buf1090[2]=='9' && buf1090[5]=='3') {  // response to "play"
-            rx1090found = true;
-            Serial.println(">>> GNS5892 module responded");
-        }
+      NMEA_bridge_sent = true;   // not really sent, but substantial processing
+  }
+
+  static uint32_t stats_time = 0;
+  if (millis() - stats_time >= 1000) {
+      stats1090 = counts1090;
+      memset(&counts1090, 0, sizeof(counts1090));
+      stats_time = millis();
+      if (settings->debug_flags & DEBUG_RESVD1) {
+          Serial.printf("GNS5892: %u accepted, %u rejected, %u bad CRC, %u dropped\r\n",
+              stats1090.accepted, stats1090.rejected, stats1090.bad_crc, stats1090.dropped);
       }
-      Serial.write(buf1090, n);           // copy to console
-      Serial.println("");
   }
+}
 
-  NMEA_bridge_sent = true;   // not really sent, but substantial processing
+// frame counts of the last full second
+void gns5892_stats(gns5892_stats_t *sp)
+{
+    *sp = stats1090;
 }
 
 #endif  // ESP32
@@ -19,9 +19,20 @@
 #ifndef GNS5892_H
 #define GNS5892_H
 
+#define GNS5892_RING_SIZE   64    /* decoded squitters waiting, power of 2 */
+#define GNS5892_BATCH_SIZE  32    /* squitters decoded per loop pass */
+
+typedef struct {
+    uint32_t accepted;    /* used for the traffic table */
+    uint32_t rejected;    /* not DF17/18, out of range, or not of interest */
+    uint32_t bad_crc;
+    uint32_t dropped;     /* ring full, or sentence cut short */
+} gns5892_stats_t;
+
 void play5892(void);
 void gns5892_setup(void);
 void gns5892_loop(void);
+void gns5892_stats(gns5892_stats_t *);
 
 extern uint32_t adsb_packets_counter;
 
@@ -29,6 +29,7 @@
 #include "../../driver/Baro.h"
 #include "../../driver/EPD.h"
 #include "../../TrafficHelper.h"
+#include "../../ApproxMath.h"
 #include "NMEA.h"
 #include "GDL90.h"
 #include "D1090.h"
@@ -73,7 +74,8 @@ void JSON_Export()
   JsonObject root = jsonDoc.to<JsonObject>();
   JsonArray aircraft_array = root.createNestedArray("aircraft");
 
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+  for (int n=0; n < Traffic_Count(); n++) {
+    int i = traffic_slots[n];
     if (Container[i].addr && (this_moment - Container[i].timestamp) <= EXPORT_EXPIRATION_TIME) {
 
       distance = Container[i].distance;
@@ -120,161 +122,379 @@ void JSON_Export()
   }
 
   if (has_aircraft) {
-    root.printTo(buffer);
+    serializeJson(root, buffer, sizeof(buffer));
     Serial.println(buffer);
   }
 
   jsonDoc.clear();
 }
 
-void parsePING(JsonObject root)
+/*
+ * Streaming reader for the aircraft lists of dump1090 ('aircraft.json')
+ * and uAvionix PingStation. The document is walked in place, one
+ * aircraft object at a time - nothing is copied or allocated. Targets
+ * outside of the import box around ThisAircraft are dropped as soon as
+ * their position is known, the others go to AddTraffic().
+ */
+
+typedef struct {
+  const char *p;
+  const char *end;
+} json_reader_t;
+
+typedef struct {
+  float lat;
+  float lon;
+  float dlat;
+  float dlon;
+  float alt;
+  float baro_corr;
+} json_filter_t;
+
+#define JSON_KEY(k, n, s)  ((n) == sizeof(s) - 1 && !memcmp((k), (s), sizeof(s) - 1))
+
+static void json_ws(json_reader_t *r)
 {
-  ping_aircraft_t *aircraft_array;
+  while (r->p < r->end &&
+         (*r->p == ' ' || *r->p == '\t' || *r->p == '\r' || *r->p == '\n')) {
+    r->p++;
+  }
+}
 
-  JsonArray aircraft = root["aircraft"];
+static bool json_char(json_reader_t *r, char c)
+{
+  json_ws(r);
+  if (r->p < r->end && *r->p == c) {
+    r->p++;
+    return true;
+  }
+  return false;
+}
 
-  int size = aircraft.size();
-  time_t timestamp = now();
+/* raw characters of a string value, escapes are left in place */
+static bool json_string(json_reader_t *r, const char **s, size_t *len)
+{
+  if (!json_char(r, '"')) {
+    return false;
+  }
 
-  if (size > 0) {
-    aircraft_array = (ping_aircraft_t *)
-                      malloc(sizeof(ping_aircraft_t) * size);
+  const char *b = r->p;
+  while (r->p < r->end && *r->p != '"') {
+    if (*r->p == '\\') {
+      r->p++;
+    }
+    r->p++;
+  }
+  if (r->p >= r->end) {
+    return false;
+  }
 
-    if (aircraft_array == NULL) {
-      return;
+  *s   = b;
+  *len = r->p - b;
+  r->p++;
+  return true;
+}
+
+/*
+ * Only the first 9 significant digits are kept - that is more than
+ * a float holds, and they fit into 32 bits.
+ */
+static bool json_number(json_reader_t *r, float *v)
+{
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+  };
+
+  json_ws(r);
+
+  const char *p = r->p;
+  bool neg = (p < r->end && *p == '-');
+  uint32_t m = 0;
+  int nd = 0, e = 0;
+
+  if (neg) {
+    p++;
+  }
+  const char *digits = p;
+  for (; p < r->end && *p >= '0' && *p <= '9'; p++) {
+    if (nd < 9) {
+      m = m * 10 + (*p - '0');
+      nd += (m != 0);
+    } else {
+      e++;
+    }
+  }
+  if (p < r->end && *p == '.') {
+    for (p++; p < r->end && *p >= '0' && *p <= '9'; p++) {
+      if (nd < 9) {
+        m = m * 10 + (*p - '0');
+        nd += (m != 0);
+        e--;
+      }
     }
+  }
+  if (p == digits) {
+    return false;          /* a string, true/false or null */
+  }
+  if (p < r->end && (*p == 'e' || *p == 'E')) {
+    bool eneg = false;
+    int x = 0;
 
-    for (int i=0; i < size; i++) {
-      JsonObject aircraft_obj = aircraft[i];
-
-      aircraft_array[i].icaoAddress = aircraft_obj["icaoAddress"];
-      aircraft_array[i].trafficSource = aircraft_obj["trafficSource"];
-      aircraft_array[i].latDD = aircraft_obj["latDD"];
-      aircraft_array[i].lonDD = aircraft_obj["lonDD"];
-      aircraft_array[i].altitudeMM = aircraft_obj["altitudeMM"];
-      aircraft_array[i].headingDE2 = aircraft_obj["headingDE2"];
-      aircraft_array[i].horVelocityCMS = aircraft_obj["horVelocityCMS"];
-      aircraft_array[i].verVelocityCMS = aircraft_obj["verVelocityCMS"];
-      aircraft_array[i].squawk = aircraft_obj["squawk"];
-      aircraft_array[i].altitudeType = aircraft_obj["altitudeType"];
-      aircraft_array[i].Callsign = aircraft_obj["Callsign"];
-      aircraft_array[i].emitterType = aircraft_obj["emitterType"];
-      aircraft_array[i].utcSync = aircraft_obj["utcSync"];
-      aircraft_array[i].timeStamp = aircraft_obj["timeStamp"];
+    p++;
+    if (p < r->end && (*p == '+' || *p == '-')) {
+      eneg = (*p++ == '-');
     }
+    for (; p < r->end && *p >= '0' && *p <= '9'; p++) {
+      if (x < 1000) {
+        x = x * 10 + (*p - '0');
+      }
+    }
+    e += (eneg ? -x : x);
+  }
 
-    for (int i=0; i < size; i++) {
+  double n = m;
+  if (e >= -9 && e <= 9) {
+    n = (e < 0 ? n / pow10[-e] : n * pow10[e]);
+  } else {
+    n *= pow(10, e);
+  }
 
-      if (aircraft_array[i].icaoAddress &&
-          aircraft_array[i].latDD != 0.0 &&
-          aircraft_array[i].lonDD != 0.0 &&
-          aircraft_array[i].altitudeMM != 0) {
+  *v = (float) (neg ? -n : n);
+  r->p = p;
+  return true;
+}
 
-        fo = EmptyFO;
-        memset(fo.raw, 0, sizeof(fo.raw));
+/* skip one value of any kind, stops in front of the next ',' '}' or ']' */
+static bool json_skip(json_reader_t *r)
+{
+  int depth = 0;
+  const char *s;
+  size_t len;
 
-#if 0
-        std::tm t = {};
-        std::istringstream ss(aircraft_array[i].timeStamp);
-        ss.imbue(std::locale("en_US.UTF-8"));
-        ss >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
-        if (ss.fail()) {
-            std::cout << "Parse failed\n";
-        }
+  json_ws(r);
 
-        if (aircraft_array[i].utcSync) {
-          fo.timestamp = mktime(&t);
-        } else {
-          fo.timestamp = timestamp;
-        }
-#else
-        fo.timestamp = timestamp;
-#endif
-        fo.protocol = RF_PROTOCOL_ADSB_1090;
+  const char *start = r->p;
+  while (r->p < r->end) {
+    char c = *r->p;
 
-        fo.addr = strtoul (&aircraft_array[i].icaoAddress[0], NULL, 16);
-        fo.addr_type = ADDR_TYPE_ICAO;
+    if (c == '"') {
+      if (!json_string(r, &s, &len)) {
+        return false;
+      }
+      if (depth == 0) {
+        return true;
+      }
+      continue;
+    }
+    if (depth == 0 && (c == ',' || c == '}' || c == ']')) {
+      return r->p > start;
+    }
+    r->p++;
+    if (c == '{' || c == '[') {
+      depth++;
+    } else if ((c == '}' || c == ']') && --depth == 0) {
+      return true;
+    }
+  }
 
-        fo.latitude = aircraft_array[i].latDD;
-        fo.longitude = aircraft_array[i].lonDD;
+  return false;
+}
 
-        if (aircraft_array[i].altitudeType == 0) {
-          fo.pressure_altitude = aircraft_array[i].altitudeMM / 1000.0;
+/* next "key": of an object, false at its end */
+static bool json_member(json_reader_t *r, const char **key, size_t *len)
+{
+  json_char(r, ',');
+  return json_string(r, key, len) && json_char(r, ':');
+}
 
-          /* TBD */
-          fo.altitude = fo.pressure_altitude;
-        } else if (aircraft_array[i].altitudeType == 1) {
-          fo.altitude = aircraft_array[i].altitudeMM / 1000.0;
-        }
+static uint32_t json_hex(const char *s, size_t len)
+{
+  uint32_t val = 0;
 
-        fo.course = (float) aircraft_array[i].headingDE2 / 100.0;
-        fo.speed = (float) aircraft_array[i].horVelocityCMS / (_GPS_MPS_PER_KNOT * 100);
-        fo.aircraft_type = GDL90_TO_AT(aircraft_array[i].emitterType);
-        fo.vs = (float) aircraft_array[i].verVelocityCMS * (_GPS_FEET_PER_METER * 60.0) / 100;
-        fo.stealth = false;
-        fo.no_track = false;
-        fo.rssi = 0;
+  for (size_t i = 0; i < len && isxdigit(s[i]); i++) {
+    val = (val << 4) | getVal(s[i]);
+  }
+  return val;
+}
 
-        Traffic_Update(&fo);
+static void json_callsign(ufo_t *fop, const char *s, size_t len)
+{
+  while (len > 0 && s[len - 1] == ' ') {
+    len--;
+  }
+  if (len > 8) {
+    len = 8;
+  }
+  memcpy(fop->callsign, s, len);
+  fop->callsign[len] = 0;
+}
 
-        int j;
+static bool json_aircraft(json_reader_t *r, json_filter_t *f)
+{
+  const char *key, *s;
+  size_t klen, len;
+  float v, alt = 0;
+  bool has_lat = false, has_lon = false, has_alt = false;
+  bool pressure = true, skip = false;
+
+  fo = EmptyFO;
+  fo.aircraft_type = AIRCRAFT_TYPE_JET;
+
+  while (json_member(r, &key, &klen)) {
+
+    if (skip) {
+      /* out of range: only look for the end of the object */
+    } else if (JSON_KEY(key, klen, "hex") ||
+               JSON_KEY(key, klen, "icaoAddress")) {
+      if (json_string(r, &s, &len)) {
+        /* dump1090 marks non-ICAO addresses with a '~' */
+        bool anon = (len > 0 && s[0] == '~');
+        fo.addr_type = (anon ? ADDR_TYPE_ANONYMOUS : ADDR_TYPE_ICAO);
+        fo.addr      = (anon ? json_hex(s + 1, len - 1) : json_hex(s, len));
+        continue;
+      }
+    } else if (JSON_KEY(key, klen, "flight") ||
+               JSON_KEY(key, klen, "Callsign")) {
+      if (json_string(r, &s, &len)) {
+        json_callsign(&fo, s, len);
+        continue;
+      }
+    } else if (json_number(r, &v)) {
+
+      if (JSON_KEY(key, klen, "lat") || JSON_KEY(key, klen, "latDD")) {
+        fo.latitude = v;
+        has_lat = (v != 0.0);
+        skip = fabs(v - f->lat) > f->dlat;
+      } else if (JSON_KEY(key, klen, "lon") || JSON_KEY(key, klen, "lonDD")) {
+        fo.longitude = v;
+        has_lon = (v != 0.0);
+        skip = fabs(v - f->lon) > f->dlon;
+      } else if (JSON_KEY(key, klen, "altitude") ||
+                 JSON_KEY(key, klen, "alt_baro")) {
+        alt = v / _GPS_FEET_PER_METER;
+        has_alt = (v != 0.0);
+      } else if (JSON_KEY(key, klen, "altitudeMM")) {
+        alt = v / 1000.0;
+        has_alt = (v != 0.0);
+      } else if (JSON_KEY(key, klen, "altitudeType")) {
+        pressure = (v == 0);
+      } else if (JSON_KEY(key, klen, "track")) {
+        fo.course = v;
+      } else if (JSON_KEY(key, klen, "headingDE2")) {
+        fo.course = v / 100.0;
+      } else if (JSON_KEY(key, klen, "speed") || JSON_KEY(key, klen, "gs")) {
+        fo.speed = v;
+      } else if (JSON_KEY(key, klen, "horVelocityCMS")) {
+        fo.speed = v / (_GPS_MPS_PER_KNOT * 100);
+      } else if (JSON_KEY(key, klen, "vert_rate") ||
+                 JSON_KEY(key, klen, "baro_rate")) {
+        fo.vs = v;
+      } else if (JSON_KEY(key, klen, "verVelocityCMS")) {
+        fo.vs = v * (_GPS_FEET_PER_METER * 60.0) / 100;
+      } else if (JSON_KEY(key, klen, "emitterType")) {
+        fo.aircraft_type = GDL90_TO_AT((int) v);
+      } else if (JSON_KEY(key, klen, "rssi")) {
+        fo.rssi = (int8_t) v;
+      }
+      continue;
+    }
 
-        /* Try to find and update an entry with the same aircraft ID */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (Container[j].addr == fo.addr && Container[j].protocol == fo.protocol) {
-            Container[j] = fo;
-            break;
-          }
-        }
+    if (!json_skip(r)) {
+      return false;
+    }
+  }
 
-        if (j < MAX_TRACKING_OBJECTS) {
-            continue;
-        }
+  if (!json_char(r, '}')) {
+    return false;
+  }
 
-        /* Fill a free entry if able */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (Container[j].addr == 0 &&
-             memcmp(Container[j].raw, EmptyFO.raw, sizeof(EmptyFO.raw)) == 0) {
-            Container[j] = fo;
-            break;
-          }
-        }
+  if (skip || !has_lat || !has_lon || !has_alt || fo.addr == 0 ||
+      fo.addr == ThisAircraft.addr || fo.addr == settings->ignore_id) {
+    return true;
+  }
 
-        if (j < MAX_TRACKING_OBJECTS) {
-            continue;
-        }
+  if (pressure) {
+    fo.pressure_altitude = alt;
+    /* same correction as for the GDL90 input */
+    fo.altitude = alt + f->baro_corr;
+  } else {
+    fo.altitude = alt;
+  }
+  if (fabs(fo.altitude - f->alt) > JSON_IMPORT_ALT_RANGE) {
+    return true;
+  }
+
+  /*
+   * traffic_geometry() leaves ADS-B targets to whoever placed them,
+   * as the GNS5892 decoder does, so do it here for every import
+   */
+  LocalFrame_anchor(ThisAircraft.latitude, ThisAircraft.longitude);
+  LocalFrame_xy(fo.latitude, fo.longitude, &fo.dx, &fo.dy);
+  fo.distance = (float) LocalFrame_distance(fo.dx, fo.dy);
+  fo.bearing  = LocalFrame_bearing(fo.dx, fo.dy);
+
+  fo.protocol    = RF_PROTOCOL_ADSB_1090;
+  fo.timestamp   = ThisAircraft.timestamp;
+  fo.gnsstime_ms = millis();
+  fo.airborne    = 1;
+
+  AddTraffic(&fo);
+
+  return true;
+}
 
-        /* Overwrite expired entry */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (timestamp - Container[j].timestamp > ENTRY_EXPIRATION_TIME) {
-            Container[j] = fo;
+/*
+ * Returns false when the document has no "aircraft" array,
+ * so that the caller can hand it to ArduinoJson instead.
+ */
+bool parseAircraft(const char *str, size_t len)
+{
+  json_reader_t r = { str, str + len };
+  json_filter_t f;
+  const char *key;
+  size_t klen;
+  bool found = false;
+
+  if (!json_char(&r, '{')) {
+    return false;
+  }
+
+  f.lat       = ThisAircraft.latitude;
+  f.lon       = ThisAircraft.longitude;
+  f.alt       = ThisAircraft.altitude;
+  f.dlat      = JSON_IMPORT_RANGE / 111300.0;
+  f.dlon      = f.dlat / CosLat(f.lat);
+  f.baro_corr = (baro_chip != NULL ? ThisAircraft.baro_alt_diff : average_baro_alt_diff);
+
+  while (json_member(&r, &key, &klen)) {
+
+    if (JSON_KEY(key, klen, "aircraft") && json_char(&r, '[')) {
+      found = true;
+
+      /* without a fix of our own the distances mean nothing */
+      if (!isValidFix()) {
+        break;
+      }
+
+      while (!json_char(&r, ']')) {
+        json_char(&r, ',');
+        if (json_char(&r, '{')) {
+          if (!json_aircraft(&r, &f)) {
             break;
           }
+        } else if (!json_skip(&r)) {
+          break;
         }
       }
+      break;
     }
 
-#if 0
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr &&
-          Container[i].latitude  != 0.0 &&
-          Container[i].longitude != 0.0 &&
-          Container[i].altitude  != 0.0) {
-
-        printf("%06X %f %f %f %d %d %d\n",
-            Container[i].addr,
-            Container[i].latitude,
-            Container[i].longitude,
-            Container[i].altitude,
-            Container[i].addr_type,
-            (int) Container[i].vs,
-            Container[i].aircraft_type);
-      }
+    if (!json_skip(&r)) {
+      break;
     }
-#endif
-
-    free(aircraft_array);
   }
+
+  return found;
 }
 
 void parseTPV(JsonObject root)
@@ -334,146 +554,6 @@ void parseTPV(JsonObject root)
   }
 }
 
-void parseD1090(JsonObject root)
-{
-  dump1090_aircraft_t *aircraft_array;
-
-  float var_now = root["now"];
-  int var_messages = root["messages"];
-
-  JsonArray aircraft = root["aircraft"];
-
-  int size = aircraft.size();
-  time_t timestamp = now();
-
-  if (size > 0) {
-    aircraft_array = (dump1090_aircraft_t *)
-                      malloc(sizeof(dump1090_aircraft_t) * size);
-
-    if (aircraft_array == NULL) {
-      return;
-    }
-
-    for (int i=0; i < size; i++) {
-      JsonObject& aircraft_obj = aircraft[i];
-
-      aircraft_array[i].hex = aircraft_obj["hex"];
-      aircraft_array[i].squawk = aircraft_obj["squawk"];
-      aircraft_array[i].flight = aircraft_obj["flight"];
-      aircraft_array[i].lat = aircraft_obj["lat"];
-      aircraft_array[i].lon = aircraft_obj["lon"];
-      aircraft_array[i].nucp = aircraft_obj["nucp"];
-      aircraft_array[i].seen_pos = aircraft_obj["seen_pos"];
-      aircraft_array[i].altitude = aircraft_obj["altitude"];
-      aircraft_array[i].vert_rate = aircraft_obj["vert_rate"];
-      aircraft_array[i].track = aircraft_obj["track"];
-      aircraft_array[i].speed = aircraft_obj["speed"];
-      aircraft_array[i].messages = aircraft_obj["messages"];
-      aircraft_array[i].seen = aircraft_obj["seen"];
-      aircraft_array[i].rssi = aircraft_obj["rssi"];
-    }
-
-    for (int i=0; i < size; i++) {
-
-      if (aircraft_array[i].hex &&
-          aircraft_array[i].lat != 0.0 &&
-          aircraft_array[i].lon != 0.0 &&
-          aircraft_array[i].altitude != 0.0) {
-
-        fo = EmptyFO;
-        memset(fo.raw, 0, sizeof(fo.raw));
-#if 0
-        fo.timestamp = (time_t) (var_now - aircraft_array[i].seen_pos);
-#else
-        fo.timestamp = timestamp;
-#endif
-        fo.protocol = RF_PROTOCOL_ADSB_1090;
-
-        if (aircraft_array[i].hex[0] == '~') {
-          fo.addr = strtoul (&aircraft_array[i].hex[1], NULL, 16);
-          fo.addr_type = ADDR_TYPE_ANONYMOUS;
-        } else {
-          fo.addr = strtoul (&aircraft_array[i].hex[0], NULL, 16);
-          fo.addr_type = ADDR_TYPE_ICAO;
-        }
-
-        fo.latitude = aircraft_array[i].lat;
-        fo.longitude = aircraft_array[i].lon;
-        fo.pressure_altitude = aircraft_array[i].altitude / _GPS_FEET_PER_METER;
-
-        /* TBD */
-        fo.altitude = fo.pressure_altitude;
-
-        fo.course = aircraft_array[i].track;
-        fo.speed = aircraft_array[i].speed;
-        fo.aircraft_type = AIRCRAFT_TYPE_JET;
-        fo.vs = aircraft_array[i].vert_rate;
-        fo.stealth = false;
-        fo.no_track = false;
-        fo.rssi = aircraft_array[i].rssi;
-
-        Traffic_Update(&fo);
-
-        int j;
-
-        /* Try to find and update an entry with the same aircraft ID */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (Container[j].addr == fo.addr && Container[j].protocol == fo.protocol) {
-            Container[j] = fo;
-            break;
-          }
-        }
-
-        if (j < MAX_TRACKING_OBJECTS) {
-            continue;
-        }
-
-        /* Fill a free entry if able */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (Container[j].addr == 0 &&
-             memcmp(Container[j].raw, EmptyFO.raw, sizeof(EmptyFO.raw)) == 0) {
-            Container[j] = fo;
-            break;
-          }
-        }
-
-        if (j < MAX_TRACKING_OBJECTS) {
-            continue;
-        }
-
-        /* Overwrite expired entry */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (timestamp - Container[j].timestamp > ENTRY_EXPIRATION_TIME) {
-            Container[j] = fo;
-            break;
-          }
-        }
-      }
-    }
-
-#if 0
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr &&
-          Container[i].latitude  != 0.0 &&
-          Container[i].longitude != 0.0 &&
-          Container[i].altitude  != 0.0) {
-
-        printf("%06X %f %f %f %d %d %d\n",
-            Container[i].addr,
-            Container[i].latitude,
-            Container[i].longitude,
-            Container[i].altitude,
-            Container[i].addr_type,
-            (int) Container[i].vs,
-            Container[i].aircraft_type);
-      }
-    }
-#endif
-
-    free(aircraft_array);
-  }
-}
-
 void parseRAW(JsonObject root)
 {
 
@@ -509,25 +589,10 @@ void parseRAW(JsonObject root)
 
         int j;
 
-        /* Fill a free entry if able */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (Container[j].addr == 0 &&
-             memcmp(Container[j].raw, EmptyFO.raw, sizeof(EmptyFO.raw)) == 0) {
-            Container[j] = fo;
-            break;
-          }
-        }
-
-        if (j < MAX_TRACKING_OBJECTS) {
-            continue;
-        }
-
-        /* Overwrite expired entry */
-        for (j=0; j < MAX_TRACKING_OBJECTS; j++) {
-          if (timestamp - Container[j].timestamp > ENTRY_EXPIRATION_TIME) {
-            Container[j] = fo;
-            break;
-          }
+        /* Fill a free (or expired) entry if able */
+        j = Traffic_Free_Slot();
+        if (j >= 0) {
+          Traffic_Store(j, &fo);
         }
       }
     }
@@ -32,49 +32,16 @@
 #define JSON_BUFFER_SIZE  65536
 #define isValidGPSDFix() (hasValidGPSDFix)
 
+/* ADS-B traffic taken from aircraft lists, around ThisAircraft */
+#define JSON_IMPORT_RANGE       (ALARM_ZONE_NONE * 2) /* meters */
+#define JSON_IMPORT_ALT_RANGE   2000                  /* meters */
+
 enum
 {
 	JSON_OFF,
 	JSON_PING
 };
 
-struct dump1090_aircraft_struct {
-  const char* hex;
-  const char* squawk;
-  const char* flight;
-  float       lat;
-  float       lon;
-  int         nucp;
-  float       seen_pos;
-  int         altitude;   // in feet
-  int         vert_rate;  // in feet/minute
-  int         track;      // degrees, 0-360
-  int         speed;      // in knots
-  int         messages;
-  float       seen;
-  float       rssi;
-};
-
-struct ping_aircraft_struct {
-  const char* icaoAddress;
-  int         trafficSource;
-  float       latDD;
-  float       lonDD;
-  long        altitudeMM;
-  int         headingDE2;
-  int         horVelocityCMS;
-  int         verVelocityCMS;
-  int         squawk;
-  int         altitudeType;
-  const char* Callsign;
-  int         emitterType;
-  int         utcSync;
-  const char* timeStamp;
-};
-
-typedef  struct dump1090_aircraft_struct dump1090_aircraft_t;
-typedef  struct ping_aircraft_struct ping_aircraft_t;
-
 extern StaticJsonDocument<JSON_BUFFER_SIZE> jsonDoc;
 extern bool hasValidGPSDFix;
 
@@ -82,8 +49,7 @@ extern void JSON_Export();
 extern void parseTPV(JsonObject);
 extern void parseSettings(JsonObject);
 extern void parseUISettings(JsonObject);
-extern void parseD1090(JsonObject);
-extern void parsePING(JsonObject);
+extern bool parseAircraft(const char *, size_t);
 extern void parseRAW(JsonObject);
 extern byte getVal(char);
 
@@ -60,7 +60,8 @@ void MAVLinkShareTraffic()
 {
     time_t this_moment = now();
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    for (int n=0; n < Traffic_Count(); n++) {
+      int i = traffic_slots[n];
       if (Container[i].addr && (this_moment - Container[i].timestamp) <= EXPORT_EXPIRATION_TIME) {
 
         char hexbuf[8];
@@ -181,91 +181,91 @@ unsigned long RPYL_TimeMarker = 0;
 
 #if defined(USE_NMEA_CFG)
 
-TinyGPSCustom C_Version;   /* 1 */
-TinyGPSCustom C_Mode;
-TinyGPSCustom C_Protocol;
-TinyGPSCustom C_Band;
-TinyGPSCustom C_AcftType;
-TinyGPSCustom C_Alarm;
-TinyGPSCustom C_TxPower;
-TinyGPSCustom C_Volume;
-TinyGPSCustom C_Pointer;
-TinyGPSCustom C_NMEA_gnss; /* 10 */
-TinyGPSCustom C_NMEA_private;
-TinyGPSCustom C_NMEA_legacy;
-TinyGPSCustom C_NMEA_sensors;
-TinyGPSCustom C_NMEA_Output;
-TinyGPSCustom C_GDL90_Output;
-TinyGPSCustom C_D1090_Output;
-TinyGPSCustom C_Stealth;
-TinyGPSCustom C_noTrack;
-TinyGPSCustom C_PowerSave; /* 19 */
+/* field numbers of the configuration sentences, field 0 is the type */
+
+enum {
+  C_Version = 1,
+  C_Mode,
+  C_Protocol,
+  C_Band,
+  C_AcftType,
+  C_Alarm,
+  C_TxPower,
+  C_Volume,
+  C_Pointer,
+  C_NMEA_gnss, /* 10 */
+  C_NMEA_private,
+  C_NMEA_legacy,
+  C_NMEA_sensors,
+  C_NMEA_Output,
+  C_GDL90_Output,
+  C_D1090_Output,
+  C_Stealth,
+  C_noTrack,
+  C_PowerSave, /* 19 */
+};
 
 // additional settings added by MB
-TinyGPSCustom D_Version;   /* 1 */
-TinyGPSCustom D_id_method;
-TinyGPSCustom D_aircraft_id;
-TinyGPSCustom D_ignore_id;
-TinyGPSCustom D_follow_id;
-TinyGPSCustom D_baud_rate;
-TinyGPSCustom D_power_ext;
-TinyGPSCustom D_NMEA_debug;
-TinyGPSCustom D_debug_flags;
-TinyGPSCustom D_NMEA2;    /* 10 */
-TinyGPSCustom D_NMEA2_gnss;
-TinyGPSCustom D_NMEA2_private;
-TinyGPSCustom D_NMEA2_legacy;
-TinyGPSCustom D_NMEA2_sensors;
-TinyGPSCustom D_NMEA2_debug;
-TinyGPSCustom D_relay;
-TinyGPSCustom D_bluetooth;  /* 17 */
-TinyGPSCustom D_baudrate2;
-TinyGPSCustom D_invert2;
-TinyGPSCustom D_extern1;
-TinyGPSCustom D_extern2;  /* 21 */
-TinyGPSCustom D_altpin0;
+enum {
+  D_Version = 1,
+  D_id_method,
+  D_aircraft_id,
+  D_ignore_id,
+  D_follow_id,
+  D_baud_rate,
+  D_power_ext,
+  D_NMEA_debug,
+  D_debug_flags,
+  D_NMEA2, /* 10 */
+  D_NMEA2_gnss,
+  D_NMEA2_private,
+  D_NMEA2_legacy,
+  D_NMEA2_sensors,
+  D_NMEA2_debug,
+  D_relay,
+  D_bluetooth, /* 17 */
+  D_baudrate2,
+  D_invert2,
+  D_extern1,
+  D_extern2, /* 21 */
+  D_altpin0,
+};
 
 #if defined(USE_OGN_ENCRYPTION)
 /* Security and privacy */
-TinyGPSCustom S_Version;
-TinyGPSCustom S_IGC_Key;
+enum {
+  S_Version = 1,
+  S_IGC_Key,
+};
 #endif /* USE_OGN_ENCRYPTION */
 
 #if defined(USE_SKYVIEW_CFG)
 #include "../../driver/EPD.h"
 
-TinyGPSCustom V_Version; /* 1 */
-TinyGPSCustom V_Adapter;
-TinyGPSCustom V_Connection;
-TinyGPSCustom V_Units;
-TinyGPSCustom V_Zoom;
-TinyGPSCustom V_Protocol;
-TinyGPSCustom V_Baudrate;
-TinyGPSCustom V_Server;
-TinyGPSCustom V_Key;
-TinyGPSCustom V_Rotate;  /* 10 */
-TinyGPSCustom V_Orientation;
-TinyGPSCustom V_AvDB;
-TinyGPSCustom V_ID_Pref;
-TinyGPSCustom V_VMode;
-TinyGPSCustom V_Voice;
-TinyGPSCustom V_AntiGhost;
-TinyGPSCustom V_Filter;
-TinyGPSCustom V_PowerSave;
-TinyGPSCustom V_Team;    /* 19 */
+enum {
+  V_Version = 1,
+  V_Adapter,
+  V_Connection,
+  V_Units,
+  V_Zoom,
+  V_Protocol,
+  V_Baudrate,
+  V_Server,
+  V_Key,
+  V_Rotate, /* 10 */
+  V_Orientation,
+  V_AvDB,
+  V_ID_Pref,
+  V_VMode,
+  V_Voice,
+  V_AntiGhost,
+  V_Filter,
+  V_PowerSave,
+  V_Team, /* 19 */
+};
 #endif /* USE_SKYVIEW_CFG */
 #endif /* USE_NMEA_CFG */
 
-static char *ltrim(char *s)
-{
-  if(s) {
-    while(*s && isspace(*s))
-      ++s;
-  }
-
-  return s;
-}
-
 void NMEA_add_checksum(char *buf, size_t limit)
 {
   size_t sentence_size = strlen(buf);
@@ -280,6 +280,56 @@ void NMEA_add_checksum(char *buf, size_t limit)
   snprintf_P(csum_ptr, limit, PSTR("%02X\r\n"), cs);
 }
 
+static int hex_digit(char c)
+{
+  if (c >= '0' && c <= '9')  return c - '0';
+  if (c >= 'A' && c <= 'F')  return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')  return c - 'a' + 10;
+  return -1;
+}
+
+/*
+ * Check the checksum of a whole sentence "$...*CS" and split it into its
+ * fields, in one pass over the characters.  The fields are copied into
+ * buf, field[0] is the sentence type (e.g. "PSRFC") and field[1] the first
+ * data field.  Returns the number of fields, 0 if the sentence is not valid.
+ */
+int NMEA_tokenize(const char *s, size_t len, char *buf, size_t size,
+                  char **field, int max)
+{
+  if (len < 4 || len > size || s[0] != '$')
+    return 0;
+
+  unsigned char cs = 0;
+  int n = 0;
+  char *p = buf;
+  size_t i;
+
+  field[n++] = p;
+  for (i = 1; i < len && s[i] != '*'; i++) {
+    char c = s[i];
+    cs ^= c;
+    if (c == ',') {
+      if (n == max)
+        return 0;
+      *p++ = '\0';
+      field[n++] = p;
+    } else {
+      *p++ = c;
+    }
+  }
+  *p = '\0';
+
+  if (i + 2 >= len)
+    return 0;
+  int hi = hex_digit(s[i+1]);
+  int lo = hex_digit(s[i+2]);
+  if (hi < 0 || lo < 0 || ((hi << 4) | lo) != cs)
+    return 0;
+
+  return n;
+}
+
 // send self-test and version sentences out, imitating a FLARM
 void sendPFLAV()
 {
@@ -335,91 +385,6 @@ void NMEA_setup()
   }
 #endif
 
-#if defined(USE_NMEA_CFG)
-  const char *psrf_c = "PSRFC";
-  int term_num = 1;
-
-  C_Version.begin      (gnss, psrf_c, term_num++); /* 1 */
-  C_Mode.begin         (gnss, psrf_c, term_num++);
-  C_Protocol.begin     (gnss, psrf_c, term_num++);
-  C_Band.begin         (gnss, psrf_c, term_num++);
-  C_AcftType.begin     (gnss, psrf_c, term_num++);
-  C_Alarm.begin        (gnss, psrf_c, term_num++);
-  C_TxPower.begin      (gnss, psrf_c, term_num++);
-  C_Volume.begin       (gnss, psrf_c, term_num++);
-  C_Pointer.begin      (gnss, psrf_c, term_num++);
-  C_NMEA_gnss.begin    (gnss, psrf_c, term_num++); /* 10 */
-  C_NMEA_private.begin (gnss, psrf_c, term_num++);
-  C_NMEA_legacy.begin  (gnss, psrf_c, term_num++);
-  C_NMEA_sensors.begin (gnss, psrf_c, term_num++);
-  C_NMEA_Output.begin  (gnss, psrf_c, term_num++);
-  C_GDL90_Output.begin (gnss, psrf_c, term_num++);
-  C_D1090_Output.begin (gnss, psrf_c, term_num++);
-  C_Stealth.begin      (gnss, psrf_c, term_num++);
-  C_noTrack.begin      (gnss, psrf_c, term_num++);
-  C_PowerSave.begin    (gnss, psrf_c, term_num  ); /* 19 */
-
-  const char *psrf_d = "PSRFD";
-  term_num = 1;
-
-  D_Version.begin       (gnss, psrf_d, term_num++); /* 1 */
-  D_id_method.begin     (gnss, psrf_d, term_num++);
-  D_aircraft_id.begin   (gnss, psrf_d, term_num++);
-  D_ignore_id.begin     (gnss, psrf_d, term_num++);
-  D_follow_id.begin     (gnss, psrf_d, term_num++);
-  D_baud_rate.begin     (gnss, psrf_d, term_num++);
-  D_power_ext.begin     (gnss, psrf_d, term_num++);
-  D_NMEA_debug.begin    (gnss, psrf_d, term_num++);
-  D_debug_flags.begin   (gnss, psrf_d, term_num++);
-  D_NMEA2.begin         (gnss, psrf_d, term_num++); /* 10 */
-  D_NMEA2_gnss.begin    (gnss, psrf_d, term_num++);
-  D_NMEA2_private.begin (gnss, psrf_d, term_num++);
-  D_NMEA2_legacy.begin  (gnss, psrf_d, term_num++);
-  D_NMEA2_sensors.begin (gnss, psrf_d, term_num++);
-  D_NMEA2_debug.begin   (gnss, psrf_d, term_num++);
-  D_relay.begin         (gnss, psrf_d, term_num++);
-  D_bluetooth.begin     (gnss, psrf_d, term_num++);
-  D_baudrate2.begin     (gnss, psrf_d, term_num++);
-  D_invert2.begin       (gnss, psrf_d, term_num++);
-  D_extern1.begin       (gnss, psrf_d, term_num++);
-  D_extern2.begin       (gnss, psrf_d, term_num++); /* 21 */
-  D_altpin0.begin       (gnss, psrf_d, term_num++);
-
-#if defined(USE_OGN_ENCRYPTION)
-/* Security and privacy */
-  const char *psrf_s = "PSRFS";
-  term_num = 1;
-
-  S_Version.begin      (gnss, psrf_s, term_num++);
-  S_IGC_Key.begin      (gnss, psrf_s, term_num  );
-#endif /* USE_OGN_ENCRYPTION */
-
-#if defined(USE_SKYVIEW_CFG)
-  const char *pskv_c = "PSKVC";
-  term_num = 1;
-
-  V_Version.begin      (gnss, pskv_c, term_num++); /* 1 */
-  V_Adapter.begin      (gnss, pskv_c, term_num++);
-  V_Connection.begin   (gnss, pskv_c, term_num++);
-  V_Units.begin        (gnss, pskv_c, term_num++);
-  V_Zoom.begin         (gnss, pskv_c, term_num++);
-  V_Protocol.begin     (gnss, pskv_c, term_num++);
-  V_Baudrate.begin     (gnss, pskv_c, term_num++);
-  V_Server.begin       (gnss, pskv_c, term_num++);
-  V_Key.begin          (gnss, pskv_c, term_num++);
-  V_Rotate.begin       (gnss, pskv_c, term_num++); /* 10 */
-  V_Orientation.begin  (gnss, pskv_c, term_num++);
-  V_AvDB.begin         (gnss, pskv_c, term_num++);
-  V_ID_Pref.begin      (gnss, pskv_c, term_num++);
-  V_VMode.begin        (gnss, pskv_c, term_num++);
-  V_Voice.begin        (gnss, pskv_c, term_num++);
-  V_AntiGhost.begin    (gnss, pskv_c, term_num++);
-  V_Filter.begin       (gnss, pskv_c, term_num++);
-  V_PowerSave.begin    (gnss, pskv_c, term_num++);
-  V_Team.begin         (gnss, pskv_c, term_num  ); /* 19 */
-#endif /* USE_SKYVIEW_CFG */
-#endif /* USE_NMEA_CFG */
-
 #if defined(NMEA_TCP_SERVICE)
   if (settings->nmea_out  == DEST_TCP
    || settings->nmea_out2 == DEST_TCP
@@ -458,59 +423,68 @@ void NMEA_setup()
   sendPFLAV();
 }
 
-void NMEA_Out(uint8_t dest, const char *buf, size_t size, bool nl)
-{
-#if 0
-  Serial.print("NMEA_Out(");
-  Serial.print(dest);
-  Serial.print("): ", dest);
-  Serial.write(buf, size);
-  if (nl) Serial.write('\n');
-#endif
+/*
+ * NMEA output queues.
+ *
+ * NMEA_Out() does not write to the port. It appends the sentence to
+ * the queue of its destination, and NMEA_Flush(), once per main loop
+ * pass, hands every queue to its sink in one piece: one UART/USB/BLE
+ * write, one TCP write, one UDP datagram. Bytes a sink does not take
+ * stay queued for the next pass. A sentence that does not fit in the
+ * queue is dropped whole and counted.
+ *
+ * There is one queue for each of the two configured outputs. Output to
+ * any other destination (e.g. a reply to the source port) is written
+ * straight away, as before.
+ */
 
-  if (dest == NMEA_Source)          // do not echo NMEA back to its source
-    return;                         // NMEA_Source = DEST_NONE for internal NMEA
+typedef struct nmea_queue {
+  uint8_t  dest;
+  uint16_t head;        /* first unsent byte */
+  uint16_t tail;        /* end of queued data */
+  char     buf[NMEA_QUEUE_SIZE];
+} nmea_queue_t;
 
-  if (dest == settings->gdl90_in)   // do not send NMEA to GDL90 source
-    return;
+static nmea_queue_t NMEA_Queue[2];
+static NMEA_Out_Stats_t NMEA_Stats[2];
+
+/* write to the sink, returns the number of bytes it took */
+static size_t NMEA_Write(uint8_t dest, const char *buf, size_t size)
+{
+  size_t rval = size;
 
   switch (dest)
   {
   case DEST_UART:
     {
       if (SoC->UART_ops) {
-        SoC->UART_ops->write((const byte*) buf, size);
-        if (nl)
-          SoC->UART_ops->write((const byte *) "\n", 1);
+        rval = SoC->UART_ops->write((const byte*) buf, size);
       } else {
-        Serial.write(buf, size);
-        if (nl)
-          Serial.write('\n');
+#if defined(ESP32)
+        /* do not block the main loop on a slow serial link */
+        size_t room = Serial.availableForWrite();
+        if (size > room)
+          size = room;
+#endif /* ESP32 */
+        rval = (size > 0 ? Serial.write((byte *) buf, size) : 0);
       }
     }
     break;
   case DEST_UART2:
     {
       if (has_serial2) {
-        Serial2.write(buf, size);
-        if (nl)
-          Serial2.write('\n');
+#if defined(ESP32)
+        size_t room = Serial2.availableForWrite();
+        if (size > room)
+          size = room;
+#endif /* ESP32 */
+        rval = (size > 0 ? Serial2.write((byte *) buf, size) : 0);
       }
     }
     break;
   case DEST_UDP:
     {
-      size_t udp_size = size;
-
-      if (size >= sizeof(UDPpacketBuffer))
-        udp_size = sizeof(UDPpacketBuffer) - 1;
-      memcpy(UDPpacketBuffer, buf, udp_size);
-
-      if (nl)
-        UDPpacketBuffer[udp_size] = '\n';
-
-      SoC->WiFi_transmit_UDP(UDP_NMEA_Output_Port, (byte *) UDPpacketBuffer,
-                              nl ? udp_size + 1 : udp_size);
+      SoC->WiFi_transmit_UDP(UDP_NMEA_Output_Port, (byte *) buf, size);
     }
     break;
   case DEST_TCP:
@@ -518,8 +492,6 @@ void NMEA_Out(uint8_t dest, const char *buf, size_t size, bool nl)
 #if defined(NMEA_TCP_SERVICE)
       if (TCP_active) {
         WiFi_transmit_TCP(buf, size);
-        if (nl)
-          WiFi_transmit_TCP("\n", 1);
       }
 #endif
     }
@@ -527,18 +499,20 @@ void NMEA_Out(uint8_t dest, const char *buf, size_t size, bool nl)
   case DEST_USB:
     {
       if (SoC->USB_ops) {
-        SoC->USB_ops->write((const byte *) buf, size);
-        if (nl)
-          SoC->USB_ops->write((const byte *) "\n", 1);
+        /* USB write() is all or nothing, hand it no more than it takes */
+        if (SoC->USB_ops->room) {
+          size_t room = SoC->USB_ops->room();
+          if (size > room)
+            size = room;
+        }
+        rval = (size > 0 ? SoC->USB_ops->write((const byte *) buf, size) : 0);
       }
     }
     break;
   case DEST_BLUETOOTH:
     {
       if (BTactive && SoC->Bluetooth_ops) {
-        SoC->Bluetooth_ops->write((const byte *) buf, size);
-        if (nl)
-          SoC->Bluetooth_ops->write((const byte *) "\n", 1);
+        rval = SoC->Bluetooth_ops->write((const byte *) buf, size);
       }
     }
     break;
@@ -546,7 +520,67 @@ void NMEA_Out(uint8_t dest, const char *buf, size_t size, bool nl)
   default:
     break;
   }
-  yield();
+
+  return rval;
+}
+
+void NMEA_Out(uint8_t dest, const char *buf, size_t size, bool nl)
+{
+#if 0
+  Serial.print("NMEA_Out(");
+  Serial.print(dest);
+  Serial.print("): ", dest);
+  Serial.write(buf, size);
+  if (nl) Serial.write('\n');
+#endif
+
+  if (dest == NMEA_Source)          // do not echo NMEA back to its source
+    return;                         // NMEA_Source = DEST_NONE for internal NMEA
+
+  if (dest == settings->gdl90_in)   // do not send NMEA to GDL90 source
+    return;
+
+  if (dest == DEST_NONE)
+    return;
+
+  int q = (dest == settings->nmea_out  ? 0 :
+           dest == settings->nmea_out2 ? 1 : -1);
+
+  if (q < 0) {
+    NMEA_Write(dest, buf, size);
+    if (nl)
+      NMEA_Write(dest, "\n", 1);
+    yield();
+    return;
+  }
+
+  nmea_queue_t *qp = &NMEA_Queue[q];
+  size_t len = size + (nl ? 1 : 0);
+
+  if (qp->dest != dest) {
+    /* the output was reassigned, whatever is queued is stale */
+    NMEA_Stats[q].dropped += qp->tail - qp->head;
+    qp->head = qp->tail = 0;
+    qp->dest = dest;
+  }
+
+  if (sizeof(qp->buf) - qp->tail < len && qp->head > 0) {
+    /* sink is behind, move the unsent bytes to the front */
+    memmove(qp->buf, qp->buf + qp->head, qp->tail - qp->head);
+    qp->tail -= qp->head;
+    qp->head  = 0;
+  }
+
+  if (sizeof(qp->buf) - qp->tail < len) {
+    NMEA_Stats[q].dropped += len;
+    NMEA_Stats[q].drops++;
+    return;
+  }
+
+  memcpy(qp->buf + qp->tail, buf, size);
+  if (nl)
+    qp->buf[qp->tail + size] = '\n';
+  qp->tail += len;
 }
 
 void NMEA_Outs(bool out1, bool out2, const char *buf, size_t size, bool nl) {
@@ -556,6 +590,42 @@ void NMEA_Outs(bool out1, bool out2, const char *buf, size_t size, bool nl) {
         NMEA_Out(settings->nmea_out2, buf, size, nl);
 }
 
+void NMEA_Flush()
+{
+  bool written = false;
+
+  for (int q = 0; q < 2; q++) {
+    nmea_queue_t *qp = &NMEA_Queue[q];
+
+    if (qp->tail == qp->head)
+      continue;
+
+    size_t len  = qp->tail - qp->head;
+    size_t sent = NMEA_Write(qp->dest, qp->buf + qp->head, len);
+
+    if (sent > len)
+      sent = len;
+    NMEA_Stats[q].sent += sent;
+    if (sent < len)
+      NMEA_Stats[q].stalls++;
+
+    qp->head += sent;
+    if (qp->head == qp->tail)
+      qp->head = qp->tail = 0;
+
+    written = true;
+  }
+
+  if (written)
+    yield();
+}
+
+void NMEA_Out_Stats(int output, NMEA_Out_Stats_t *stats)
+{
+  *stats = NMEA_Stats[output];
+  stats->queued = NMEA_Queue[output].tail - NMEA_Queue[output].head;
+}
+
 // Send buffered sentences to bridged outputs
 bool NMEA_bridge_sent = false;
 void NMEA_bridge_send(char *buf, int len)
@@ -577,12 +647,8 @@ void NMEA_bridge_send(char *buf, int len)
     // Not sure whether to process SKV sentences here or pass them on?
     if (buf[1]=='P' && buf[2]=='S' && buf[3]=='R' && buf[4]=='F') {
         NMEA_bridge_sent = true;   // not really sent, but substantial processing
-        for (int i=0; i<len; i++) {
-            if (gnss.encode(buf[i])) {   // valid sentence
-                NMEA_Process_SRF_SKV_Sentences();
-                return;
-            }
-        }
+        if (NMEA_Process_SRF_SKV_Sentences(buf, len))   // valid sentence
+            return;
         // if $PSRF but not a valid sentence, send it back to the source:
         NMEA_Out(NMEA_Source, buf, len, false);
         NMEA_Out(NMEA_Source, "-- invalid", 10, true);
@@ -889,6 +955,8 @@ void NMEA_loop()
 
 void NMEA_fini()
 {
+  NMEA_Flush();
+
 #if defined(NMEA_TCP_SERVICE)
   if (TCP_active) {
     if (settings->tcpmode == TCP_MODE_SERVER)
@@ -899,6 +967,117 @@ void NMEA_fini()
 #endif /* NMEA_TCP_SERVICE */
 }
 
+/*
+ * NMEA_Export() keeps some state from one export to the next:
+ *
+ * - the report order of the traffic. It is only repaired by an
+ *   insertion sort, so an export where no target changed its rank
+ *   costs one pass over the list;
+ * - the name and type fields of the $PFLAA sentences, formatted once
+ *   per reported aircraft and reused while they do not change.
+ */
+
+static uint8_t NMEA_Order[MAX_TRACKING_OBJECTS];  /* Container[] slots */
+static int     NMEA_Order_Count = 0;
+
+typedef struct nmea_fragment {
+  uint32_t addr;
+  uint8_t  protocol;
+  uint8_t  addr_type;
+  uint8_t  aircraft_type;
+  bool     no_track;
+  uint8_t  callsign[sizeof(((ufo_t *) 0)->callsign)];
+  uint8_t  used;          /* export pass that used this entry */
+  char     id[24];        /* "<addr type>,<ID>!<name>" */
+  char     type[12];      /* "<aircraft type>,<no track>,<source>" */
+} nmea_fragment_t;
+
+static nmea_fragment_t NMEA_Fragments[MAX_NMEA_OBJECTS];
+static uint8_t NMEA_Export_Pass = 0;
+
+/* true when Container[a] is to be reported ahead of Container[b] */
+static bool NMEA_precedes(const ufo_t *a, const ufo_t *b, uint32_t follow_id)
+{
+  if ((a->addr == follow_id) != (b->addr == follow_id))
+    return (a->addr == follow_id);
+  if (a->alarm_level != b->alarm_level)
+    return (a->alarm_level > b->alarm_level);
+  return (a->adj_distance < b->adj_distance);
+}
+
+static void NMEA_fragment_fill(nmea_fragment_t *f, const ufo_t *fop,
+                               uint32_t id, uint8_t addr_type)
+{
+  f->addr          = fop->addr;
+  f->protocol      = fop->protocol;
+  f->addr_type     = fop->addr_type;
+  f->aircraft_type = fop->aircraft_type;
+  f->no_track      = fop->no_track;
+  memcpy(f->callsign, fop->callsign, sizeof(f->callsign));
+
+  /*
+   * When callsign is available - send it to a NMEA client.
+   * If it is not - generate a callsign substitute,
+   * based upon a protocol ID and the ICAO address
+   */
+  if (fop->callsign[0] == '\0') {
+    snprintf_P(f->id, sizeof(f->id), PSTR("%d,%06X!%s_%06X"),
+               addr_type, id, NMEA_CallSign_Prefix[fop->protocol], id);
+  } else {
+    snprintf_P(f->id, sizeof(f->id), PSTR("%d,%06X!%s"),
+               addr_type, id, (const char *) f->callsign);
+  }
+
+  // aircraft type is supposed to be hex:
+  snprintf_P(f->type, sizeof(f->type), PSTR("%X,%d,%d"),
+             fop->aircraft_type, (fop->no_track? 1 : 0),
+             (fop->protocol==RF_PROTOCOL_ADSB_1090? 1 : (fop->protocol==RF_PROTOCOL_GDL90? 1 : 0)));
+}
+
+/* look up (or format) the static fields of a non-stealth target */
+static const nmea_fragment_t *NMEA_fragment(const ufo_t *fop, uint8_t addr_type)
+{
+  nmea_fragment_t *victim = NULL;
+
+  for (int k = 0; k < MAX_NMEA_OBJECTS; k++) {
+    nmea_fragment_t *f = &NMEA_Fragments[k];
+
+    if (f->addr          == fop->addr          &&
+        f->protocol      == fop->protocol      &&
+        f->addr_type     == fop->addr_type     &&
+        f->aircraft_type == fop->aircraft_type &&
+        f->no_track      == fop->no_track      &&
+        memcmp(f->callsign, fop->callsign, sizeof(f->callsign)) == 0) {
+      f->used = NMEA_Export_Pass;
+      return f;
+    }
+    if (victim == NULL && f->used != NMEA_Export_Pass)
+      victim = f;
+  }
+
+  NMEA_fragment_fill(victim, fop, fop->addr, addr_type);
+  victim->used = NMEA_Export_Pass;
+
+  return victim;
+}
+
+/* climb rate in m/s with one decimal, from integer tenths */
+static void NMEA_climb_rate(char *buf, size_t size, float vs)
+{
+  int tenths = (int) roundf(vs * (10.0 / (_GPS_FEET_PER_METER * 60.0)));
+
+  tenths = constrain(tenths, -327, 327);
+  snprintf_P(buf, size, PSTR("%s%d.%d"), (tenths < 0 ? "-" : ""),
+             abs(tenths) / 10, abs(tenths) % 10);
+}
+
+/* checksum the sentence in NMEABuffer and queue it on the traffic outputs */
+static void NMEA_Export_commit()
+{
+  NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
+  NMEA_Outs(settings->nmea_l, settings->nmea2_l, NMEABuffer, strlen(NMEABuffer), false);
+}
+
 void NMEA_Export()
 {
     if (! settings->nmea_l && ! settings->nmea2_l)
@@ -918,7 +1097,6 @@ void NMEA_Export()
     uint32_t follow_id = settings->follow_id;
 
     /* High priority object (most relevant target) */
-    int HP_index = MAX_TRACKING_OBJECTS;
     int HP_alt_diff = 0;
     int HP_alarm_level = ALARM_LEVEL_NONE;
     float HP_adj_dist  = 999999999;
@@ -927,14 +1105,23 @@ void NMEA_Export()
     uint32_t HP_addr = 0;
     bool HP_stealth = false;
     int total_objects = 0;
-    int head = 0;
 
     bool has_Fix = (isValidFix() || (settings->mode == SOFTRF_MODE_TXRX_TEST));
 
+    if (++NMEA_Export_Pass == 0) {
+      /* skip the value that fresh fragment entries carry */
+      NMEA_Export_Pass = 1;
+    }
+
     if (has_Fix) {
 
-      for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+      /* 1: report candidate, 2: also in NMEA_Order[] */
+      uint8_t candidate[MAX_TRACKING_OBJECTS];
+      memset(candidate, 0, sizeof(candidate));
 
+      for (int n=0; n < Traffic_Count(); n++) {
+
+        int i = traffic_slots[n];
         ufo_t *cip = &Container[i];
 
         if (cip->addr && ((this_moment - cip->timestamp) <= EXPORT_EXPIRATION_TIME)) {
@@ -978,31 +1165,8 @@ void NMEA_Export()
                || cip->addr == follow_id)
               && show) {
 
-             /* put candidate traffic to report into a sorted list */
-
-             int next, previous;
-             if (total_objects == 0) {  /* first inserted into the list */
-               head = i;
-               cip->next = MAX_TRACKING_OBJECTS;
-               total_objects = 1;
-             } else {
-               next = head;
-               while (next < MAX_TRACKING_OBJECTS) {
-                 if (Container[next].alarm_level <= alarm_level
-                  && Container[next].addr != follow_id
-                  && Container[next].adj_distance >= adj_dist)
-                        break;   /* insert before this one */
-                 /* else */
-                   previous = next;  /* the preceding list entry */
-                   next = Container[next].next;
-               }
-               cip->next = next;
-               if (head == next)
-                 head = i;
-               else
-                 Container[previous].next = i;
-               total_objects++;
-             }
+             candidate[i] = 1;
+             total_objects++;
 
              /* Alarm or close traffic is treated as highest priority */
              if (alarm_level > HP_alarm_level ||
@@ -1012,18 +1176,45 @@ void NMEA_Export()
                 HP_alarm_level = alarm_level;
                 HP_distance = distance;
                 HP_adj_dist = adj_dist;
-                HP_addr = (stealth? 0xFFFFF0 + i : cip->addr);
+                HP_addr = (stealth? 0xFFFFF0 + (i & 0x0F) : cip->addr);
                 HP_stealth = stealth;
              }
           }
         }
       }
 
-      ufo_t *fop = &Container[head];
+      /* keep last order for the remaining candidates, append the new ones */
+      int count = 0;
+      for (int k = 0; k < NMEA_Order_Count; k++) {
+        uint8_t i = NMEA_Order[k];
+        if (candidate[i] == 1) {
+          candidate[i] = 2;
+          NMEA_Order[count++] = i;
+        }
+      }
+      for (int n=0; n < Traffic_Count() && count < total_objects; n++) {
+        uint8_t i = traffic_slots[n];
+        if (candidate[i] == 1)
+          NMEA_Order[count++] = i;
+      }
+      NMEA_Order_Count = count;
+
+      for (int k = 1; k < count; k++) {
+        uint8_t i = NMEA_Order[k];
+        int j = k;
+        while (j > 0 &&
+               NMEA_precedes(&Container[i], &Container[NMEA_Order[j-1]], follow_id)) {
+          NMEA_Order[j] = NMEA_Order[j-1];
+          j--;
+        }
+        NMEA_Order[j] = i;
+      }
 
       for (int i=0; i < total_objects && i < MAX_NMEA_OBJECTS; i++) {
 
-         // note that MAX_NMEA_OBJECTS (6) < MAX_TRACKING_OBJECTS (8)
+         // note that MAX_NMEA_OBJECTS (6) < MAX_TRACKING_OBJECTS
+
+         ufo_t *fop = &Container[NMEA_Order[i]];
 
          uint8_t addr_type = fop->addr_type > ADDR_TYPE_ANONYMOUS ?
                                   ADDR_TYPE_ANONYMOUS : fop->addr_type;
@@ -1032,10 +1223,16 @@ void NMEA_Export()
 
          alarm_level = fop->alarm_level;
 
-         uint32_t id = fop->addr;
+         fop->callsign[sizeof(fop->callsign)-1] = '\0';
+
+         const nmea_fragment_t *frag;
+         nmea_fragment_t stealth_frag;
          if (stealth) {
-           id = 0xFFFFF0 + i;   /* show as anonymous */
-           addr_type = ADDR_TYPE_ANONYMOUS;
+           /* show as anonymous */
+           NMEA_fragment_fill(&stealth_frag, fop, 0xFFFFF0 + i, ADDR_TYPE_ANONYMOUS);
+           frag = &stealth_frag;
+         } else {
+           frag = NMEA_fragment(fop, addr_type);
          }
 
          // may want to skip the HP object if there are many to report
@@ -1055,9 +1252,7 @@ void NMEA_Export()
              course = 0;
              speed  = 0;
          } else {
-             dtostrf(
-               constrain(fop->vs / (_GPS_FEET_PER_METER * 60.0), -32.7, 32.7),
-               5, 1, str_climb_rate);
+             NMEA_climb_rate(str_climb_rate, sizeof(str_climb_rate), fop->vs);
          }
 
          if (alarm_level > ALARM_LEVEL_NONE)  --alarm_level;
@@ -1066,59 +1261,16 @@ void NMEA_Export()
          data_source = fop->protocol == RF_PROTOCOL_ADSB_UAT ?
                             DATA_SOURCE_ADSB : DATA_SOURCE_FLARM;
 
-#if 1
-         /*
-          * When callsign is available - send it to a NMEA client.
-          * If it is not - generate a callsign substitute,
-          * based upon a protocol ID and the ICAO address
-          */
-         if (fop->callsign[0] == '\0') {
-
-           snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-//            PSTR("$PFLAA,%d,%d,%d,%d,%d,%06X!%s_%06X,%d,,%d,%s,%d,%d,%d,%d" PFLAA_EXT1_FMT "*"),
-// aircraft type is supposed to be hex:
-              PSTR("$PFLAA,%d,%d,%d,%d,%d,%06X!%s_%06X,%d,,%d,%s,%X,%d,%d,%d" PFLAA_EXT1_FMT "*"),
-              alarm_level, (int) fop->dy, (int) fop->dx,
-              alt_diff, addr_type, id, NMEA_CallSign_Prefix[fop->protocol], id,
-              course, speed, ltrim(str_climb_rate), fop->aircraft_type,
-              (fop->no_track? 1 : 0),
-              (fop->protocol==RF_PROTOCOL_ADSB_1090? 1 : (fop->protocol==RF_PROTOCOL_GDL90? 1 : 0)),
-              fop->rssi
-              PFLAA_EXT1_ARGS );
-
-         } else {   /* there is a callsign from incoming data */
-
-           /* memset((void *) NMEA_Callsign, 0, sizeof(NMEA_Callsign));
-              memcpy(NMEA_Callsign, fop->callsign, sizeof(fop->callsign)); */
-           fop->callsign[sizeof(fop->callsign)-1] = '\0';
-
-           snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-              PSTR("$PFLAA,%d,%d,%d,%d,%d,%06X!%s,%d,,%d,%s,%X,%d,%d,%d" PFLAA_EXT1_FMT "*"),
-              alarm_level, (int) fop->dy, (int) fop->dx,
-              alt_diff, addr_type, id, fop->callsign,
-              course, speed, ltrim(str_climb_rate), fop->aircraft_type,
-              (fop->no_track? 1 : 0),
-              (fop->protocol==RF_PROTOCOL_ADSB_1090? 1 : (fop->protocol==RF_PROTOCOL_GDL90? 1 : 0)),
-              fop->rssi
-              PFLAA_EXT1_ARGS );
-         }
-#else
-         // skip the callsign
          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-            PSTR("$PFLAA,%d,%d,%d,%d,%d,%06X,%d,,%d,%s,%X" PFLAA_EXT1_FMT "*"),
-            alarm_level, (int) fop->dy, (int) fop->dx,
-            alt_diff, addr_type, id,
-            course, speed, ltrim(str_climb_rate), fop->aircraft_type
+            PSTR("$PFLAA,%d,%d,%d,%d,%s,%d,,%d,%s,%s,%d" PFLAA_EXT1_FMT "*"),
+            alarm_level, (int) (fop->dy / 4), (int) (fop->dx / 4),
+            alt_diff, frag->id,
+            course, speed, str_climb_rate, frag->type,
+            fop->rssi
             PFLAA_EXT1_ARGS );
-#endif
-         NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
-         NMEA_Outs(settings->nmea_l, settings->nmea2_l, NMEABuffer, strlen(NMEABuffer), false);
+         NMEA_Export_commit();
 
         //}  /* done skipping the HP object */
-
-        if (fop->next >= MAX_TRACKING_OBJECTS)  break;    /* belt and suspenders */
-
-        fop = &Container[fop->next];
       }
     }
 
@@ -1133,7 +1285,7 @@ void NMEA_Export()
         if (HP_addr == 0) {
            /* no aircraft has been identified as high priority, use */
            /*  the aircraft from the top of the sorted list, if any */
-           ufo_t *cip = &Container[head];
+           ufo_t *cip = &Container[NMEA_Order[0]];
            if (cip->addr) {
                HP_bearing = cip->bearing;
                HP_alt_diff = cip->alt_diff;
@@ -1176,9 +1328,7 @@ void NMEA_Export()
                 power_status, ALARM_LEVEL_NONE
                 PFLAU_EXT1_ARGS );
     }
-
-    NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
-    NMEA_Outs(settings->nmea_l, settings->nmea2_l, NMEABuffer, strlen(NMEABuffer), false);
+    NMEA_Export_commit();
 
     static int beatcount = 0;
     if (++beatcount < 10)
@@ -1189,14 +1339,16 @@ void NMEA_Export()
     snprintf_P(NMEABuffer, sizeof(NMEABuffer),
             PSTR("$PSRFH,%06X,%d,%d,%d,%d,%d*"),
             ThisAircraft.addr,settings->rf_protocol,
-            rx_packets_counter,tx_packets_counter,(int)(voltage*100),ESP.getFreeHeap());
-    NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
-    NMEA_Outs(settings->nmea_l, settings->nmea2_l, NMEABuffer, strlen(NMEABuffer), false);
+            rx_packets_counter,tx_packets_counter,(int)(voltage*100),
+            SoC->getFreeHeap ? SoC->getFreeHeap() : 0);
+    NMEA_Export_commit();
 #endif /* EXCLUDE_SOFTRF_HEARTBEAT */
 
     if (settings->debug_flags & DEBUG_RESVD1) {
-        Serial.printf("ThisAircraft.baro_alt_diff = %.0f\r\n", ThisAircraft.baro_alt_diff);
-        Serial.printf("OthAcfts Avg baro_alt_diff = %.0f\r\n", average_baro_alt_diff);
+        snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+            PSTR("ThisAircraft.baro_alt_diff = %.0f\r\nOthAcfts Avg baro_alt_diff = %.0f\r\n"),
+            ThisAircraft.baro_alt_diff, average_baro_alt_diff);
+        Serial.print(NMEABuffer);
     }
 }
 
@@ -1336,6 +1488,52 @@ void NMEA_GGA()
   }
 }
 
+/* RMC from the last fix, for a GNSS that sends no NMEA of its own (UBX) */
+void NMEA_RMC()
+{
+  if (! settings->nmea_g && ! settings->nmea2_g)
+    return;
+
+  NmeaInfo info;
+
+  float latitude = gnss.location.lat();
+  float longitude = gnss.location.lng();
+
+  nmeaInfoClear(&info);
+
+  info.utc.year = gnss.date.year();
+  info.utc.mon = gnss.date.month();
+  info.utc.day = gnss.date.day();
+  info.utc.hour = gnss.time.hour();
+  info.utc.min = gnss.time.minute();
+  info.utc.sec = gnss.time.second();
+  info.utc.hsec = gnss.time.centisecond();
+
+  info.latitude = ((int) latitude) * 100.0;
+  info.latitude += (latitude - (int) latitude) * 60.0;
+  info.longitude = ((int) longitude) * 100.0;
+  info.longitude += (longitude - (int) longitude) * 60.0;
+
+  info.sig = (NmeaSignal) gnss.location.Quality();
+  info.speed = gnss.speed.kmph();
+  info.track = gnss.course.deg();
+
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_UTCDATE);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_UTCTIME);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_SIG);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_LAT);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_LON);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_SPEED);
+  nmeaInfoSetPresent(&info.present, NMEALIB_PRESENT_TRACK);
+
+  size_t gen_sz = nmeaSentenceFromInfo(&nmealib_buf, &info, (NmeaSentence)
+                                        NMEALIB_SENTENCE_GPRMC );
+
+  if (gen_sz) {
+    NMEA_Outs(settings->nmea_g, settings->nmea2_g, nmealib_buf.buffer, gen_sz, false);
+  }
+}
+
 #endif /* USE_NMEALIB */
 
 #if defined(USE_NMEA_CFG)
@@ -1368,488 +1566,544 @@ static void nmea_cfg_restart()
   reboot();
 }
 
-void NMEA_Process_SRF_SKV_Sentences()
+/*
+ * A field is taken as updated if the sentence has it and it is not empty,
+ * so that a sentence can change some of the settings and leave the rest.
+ */
+#define CFG_UPDATED(field)  ((field) < n && f[field][0] != '\0')
+
+static void NMEA_PSRFC(char **f, int n)
 {
-      if (C_Version.isUpdated()) {
-        if (strncmp(C_Version.value(), "RST", 3) == 0) {
-            SoC->WDT_fini();
-            nmea_cfg_restart();
-        } else if (strncmp(C_Version.value(), "OFF", 3) == 0) {
-          shutdown(SOFTRF_SHUTDOWN_NMEA);
-        } else if (strncmp(C_Version.value(), "?", 1) == 0) {
-
-          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-              PSTR("$PSRFC,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d*"),
-              PSRFC_VERSION,        settings->mode,     settings->rf_protocol,
-              settings->band,       settings->aircraft_type, settings->alarm,
-              settings->txpower,    settings->volume,   settings->pointer,
-              settings->nmea_g,     settings->nmea_p,   settings->nmea_l,
-              settings->nmea_s,     settings->nmea_out, settings->gdl90,
-              settings->d1090,      settings->stealth,  settings->no_track,
-              settings->power_save );
-
-          nmea_cfg_send();
-
-        } else if (atoi(C_Version.value()) == PSRFC_VERSION) {
-          bool cfg_is_updated = false;
-
-          if (C_Mode.isUpdated())
-          {
-            settings->mode = atoi(C_Mode.value());
-            Serial.print(F("Mode = ")); Serial.println(settings->mode);
-            cfg_is_updated = true;
-          }
-          if (C_Protocol.isUpdated())
-          {
-            settings->rf_protocol = atoi(C_Protocol.value());
-            Serial.print(F("Protocol = ")); Serial.println(settings->rf_protocol);
-            cfg_is_updated = true;
-          }
-          if (C_Band.isUpdated())
-          {
-            settings->band = atoi(C_Band.value());
-            Serial.print(F("Region = ")); Serial.println(settings->band);
-            cfg_is_updated = true;
-          }
-          if (C_AcftType.isUpdated())
-          {
-            settings->aircraft_type = atoi(C_AcftType.value());
-            Serial.print(F("AcftType = ")); Serial.println(settings->aircraft_type);
-            cfg_is_updated = true;
-          }
-          if (C_Alarm.isUpdated())
-          {
-            settings->alarm = atoi(C_Alarm.value());
-            Serial.print(F("Alarm = ")); Serial.println(settings->alarm);
-            cfg_is_updated = true;
-          }
-          if (C_TxPower.isUpdated())
-          {
-            settings->txpower = atoi(C_TxPower.value());
-            Serial.print(F("TxPower = ")); Serial.println(settings->txpower);
-            cfg_is_updated = true;
-          }
-          if (C_Volume.isUpdated())
-          {
-            settings->volume = atoi(C_Volume.value());
-            Serial.print(F("Volume = ")); Serial.println(settings->volume);
-            cfg_is_updated = true;
-          }
-           if (C_Pointer.isUpdated())
-          {
-            settings->pointer = atoi(C_Pointer.value());
-            Serial.print(F("Pointer = ")); Serial.println(settings->pointer);
-            cfg_is_updated = true;
-          }
-          if (C_NMEA_gnss.isUpdated())
-          {
-            settings->nmea_g = atoi(C_NMEA_gnss.value());
-            Serial.print(F("NMEA_gnss = ")); Serial.println(settings->nmea_g);
-            cfg_is_updated = true;
-          }
-          if (C_NMEA_private.isUpdated())
-          {
-            settings->nmea_p = atoi(C_NMEA_private.value());
-            Serial.print(F("NMEA_private = ")); Serial.println(settings->nmea_p);
-            cfg_is_updated = true;
-          }
-          if (C_NMEA_legacy.isUpdated())
-          {
-            settings->nmea_l = atoi(C_NMEA_legacy.value());
-            Serial.print(F("NMEA_legacy = ")); Serial.println(settings->nmea_l);
-            cfg_is_updated = true;
-          }
-           if (C_NMEA_sensors.isUpdated())
-          {
-            settings->nmea_s = atoi(C_NMEA_sensors.value());
-            Serial.print(F("NMEA_sensors = ")); Serial.println(settings->nmea_s);
-            cfg_is_updated = true;
-          }
-          if (C_NMEA_Output.isUpdated())
-          {
-            settings->nmea_out = atoi(C_NMEA_Output.value());
-            Serial.print(F("NMEA_Output = ")); Serial.println(settings->nmea_out);
-            cfg_is_updated = true;
-          }
-          if (C_GDL90_Output.isUpdated())
-          {
-            settings->gdl90 = atoi(C_GDL90_Output.value());
-            Serial.print(F("GDL90_Output = ")); Serial.println(settings->gdl90);
-            cfg_is_updated = true;
-          }
-          if (C_D1090_Output.isUpdated())
-          {
-            settings->d1090 = atoi(C_D1090_Output.value());
-            Serial.print(F("D1090_Output = ")); Serial.println(settings->d1090);
-            cfg_is_updated = true;
-          }
-          if (C_Stealth.isUpdated())
-          {
-            settings->stealth = atoi(C_Stealth.value());
-            Serial.print(F("Stealth = ")); Serial.println(settings->stealth);
-            cfg_is_updated = true;
-          }
-          if (C_noTrack.isUpdated())
-          {
-            settings->no_track = atoi(C_noTrack.value());
-            Serial.print(F("noTrack = ")); Serial.println(settings->no_track);
-            cfg_is_updated = true;
-          }
-          if (C_PowerSave.isUpdated())
-          {
-            settings->power_save = atoi(C_PowerSave.value());
-            Serial.print(F("PowerSave = ")); Serial.println(settings->power_save);
-            cfg_is_updated = true;
-          }
+  if (strncmp(f[C_Version], "RST", 3) == 0) {
+      SoC->WDT_fini();
+      nmea_cfg_restart();
+  } else if (strncmp(f[C_Version], "OFF", 3) == 0) {
+    shutdown(SOFTRF_SHUTDOWN_NMEA);
+  } else if (strncmp(f[C_Version], "?", 1) == 0) {
 
-          if (cfg_is_updated) {
-            SoC->WDT_fini();
-            if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
-            EEPROM_store();
-            nmea_cfg_restart();
-          }
-        }
-      }
+    snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+        PSTR("$PSRFC,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d*"),
+        PSRFC_VERSION,        settings->mode,     settings->rf_protocol,
+        settings->band,       settings->aircraft_type, settings->alarm,
+        settings->txpower,    settings->volume,   settings->pointer,
+        settings->nmea_g,     settings->nmea_p,   settings->nmea_l,
+        settings->nmea_s,     settings->nmea_out, settings->gdl90,
+        settings->d1090,      settings->stealth,  settings->no_track,
+        settings->power_save );
 
-      if (D_Version.isUpdated()) {
-        if (strncmp(D_Version.value(), "?", 1) == 0) {
-          char psrfd_buf[MAX_PSRFD_LEN];
-          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-              PSTR("$PSRFD,%d,%d,%06X,%06X,%06X,%d,%d,%d,%02X,%d,%d,%d,%d,%d,%d*"),
-              PSRFD_VERSION,            settings->id_method,  settings->aircraft_id,
-              settings->ignore_id,      settings->follow_id,  settings->baud_rate,
-              settings->power_external, settings->nmea_d,     settings->debug_flags,
-              settings->nmea_out2,      settings->nmea2_g,    settings->nmea2_p,
-              settings->nmea2_l,        settings->nmea2_s,    settings->nmea2_d);
-
-          nmea_cfg_send();
-
-        } else if (atoi(D_Version.value()) == PSRFD_VERSION) {
-          bool cfg_is_updated = false;
-
-          if (D_id_method.isUpdated()) {
-            settings->id_method = atoi(D_id_method.value());
-            Serial.print(F("ID method = ")); Serial.println(settings->id_method);
-            cfg_is_updated = true;
-          }
-          if (D_aircraft_id.isUpdated()) {
-            settings->aircraft_id = strtoul(D_aircraft_id.value(), NULL, 16);
-            Serial.print(F("Aircraft ID = ")); Serial.println(settings->aircraft_id, HEX);
-            cfg_is_updated = true;
-          }
-          if (D_ignore_id.isUpdated()) {
-            settings->ignore_id = strtoul(D_ignore_id.value(), NULL, 16);
-            Serial.print(F("Ignore ID = ")); Serial.println(settings->ignore_id, HEX);
-            cfg_is_updated = true;
-          }
-          if (D_follow_id.isUpdated()) {
-            settings->follow_id = strtoul(D_follow_id.value(), NULL, 16);
-            Serial.print(F("Follow ID = ")); Serial.println(settings->follow_id, HEX);
-            cfg_is_updated = true;
-          }
-          if (D_baud_rate.isUpdated()) {
-            settings->baud_rate = atoi(D_baud_rate.value());
-            Serial.print(F("Baud rate = ")); Serial.println(settings->baud_rate);
-            cfg_is_updated = true;
-          }
-          if (D_power_ext.isUpdated()) {
-            settings->power_external = atoi(D_power_ext.value());
-            Serial.print(F("Power source = ")); Serial.println(settings->power_external);
-            cfg_is_updated = true;
-          }
-          if (D_NMEA_debug.isUpdated()) {
-            settings->nmea_d = atoi(D_NMEA_debug.value());
-            Serial.print(F("NMEA_debug = ")); Serial.println(settings->nmea_d);
-            cfg_is_updated = true;
-          }
-          if (D_debug_flags.isUpdated()) {
-            settings->debug_flags = atoi(D_debug_flags.value());
-            Serial.print(F("Debug flags = ")); Serial.println(settings->debug_flags);
-            cfg_is_updated = true;
-          }
-          if (D_NMEA2.isUpdated())
-          {
-            int nmea1 = settings->nmea_out;
-            int nmea2 = atoi(D_NMEA2.value());
-            Serial.print(F("NMEA_Output2 (given) = ")); Serial.println(nmea2);
-            if (nmea2 == nmea1)
-                nmea2 = DEST_NONE;
-            if (hw_info.model == SOFTRF_MODEL_PRIME_MK2) {
-              if ((nmea1==DEST_UART || nmea1==DEST_USB)
-               && (nmea2==DEST_UART || nmea2==DEST_USB))
-                  nmea2 = DEST_NONE;      // USB & UART wired together
-            }
+    nmea_cfg_send();
+
+  } else if (atoi(f[C_Version]) == PSRFC_VERSION) {
+    bool cfg_is_updated = false;
+
+    if (CFG_UPDATED(C_Mode))
+    {
+      settings->mode = atoi(f[C_Mode]);
+      Serial.print(F("Mode = ")); Serial.println(settings->mode);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_Protocol))
+    {
+      settings->rf_protocol = atoi(f[C_Protocol]);
+      Serial.print(F("Protocol = ")); Serial.println(settings->rf_protocol);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_Band))
+    {
+      settings->band = atoi(f[C_Band]);
+      Serial.print(F("Region = ")); Serial.println(settings->band);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_AcftType))
+    {
+      settings->aircraft_type = atoi(f[C_AcftType]);
+      Serial.print(F("AcftType = ")); Serial.println(settings->aircraft_type);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_Alarm))
+    {
+      settings->alarm = atoi(f[C_Alarm]);
+      Serial.print(F("Alarm = ")); Serial.println(settings->alarm);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_TxPower))
+    {
+      settings->txpower = atoi(f[C_TxPower]);
+      Serial.print(F("TxPower = ")); Serial.println(settings->txpower);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_Volume))
+    {
+      settings->volume = atoi(f[C_Volume]);
+      Serial.print(F("Volume = ")); Serial.println(settings->volume);
+      cfg_is_updated = true;
+    }
+     if (CFG_UPDATED(C_Pointer))
+    {
+      settings->pointer = atoi(f[C_Pointer]);
+      Serial.print(F("Pointer = ")); Serial.println(settings->pointer);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_NMEA_gnss))
+    {
+      settings->nmea_g = atoi(f[C_NMEA_gnss]);
+      Serial.print(F("NMEA_gnss = ")); Serial.println(settings->nmea_g);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_NMEA_private))
+    {
+      settings->nmea_p = atoi(f[C_NMEA_private]);
+      Serial.print(F("NMEA_private = ")); Serial.println(settings->nmea_p);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_NMEA_legacy))
+    {
+      settings->nmea_l = atoi(f[C_NMEA_legacy]);
+      Serial.print(F("NMEA_legacy = ")); Serial.println(settings->nmea_l);
+      cfg_is_updated = true;
+    }
+     if (CFG_UPDATED(C_NMEA_sensors))
+    {
+      settings->nmea_s = atoi(f[C_NMEA_sensors]);
+      Serial.print(F("NMEA_sensors = ")); Serial.println(settings->nmea_s);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_NMEA_Output))
+    {
+      settings->nmea_out = atoi(f[C_NMEA_Output]);
+      Serial.print(F("NMEA_Output = ")); Serial.println(settings->nmea_out);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_GDL90_Output))
+    {
+      settings->gdl90 = atoi(f[C_GDL90_Output]);
+      Serial.print(F("GDL90_Output = ")); Serial.println(settings->gdl90);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_D1090_Output))
+    {
+      settings->d1090 = atoi(f[C_D1090_Output]);
+      Serial.print(F("D1090_Output = ")); Serial.println(settings->d1090);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_Stealth))
+    {
+      settings->stealth = atoi(f[C_Stealth]);
+      Serial.print(F("Stealth = ")); Serial.println(settings->stealth);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_noTrack))
+    {
+      settings->no_track = atoi(f[C_noTrack]);
+      Serial.print(F("noTrack = ")); Serial.println(settings->no_track);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(C_PowerSave))
+    {
+      settings->power_save = atoi(f[C_PowerSave]);
+      Serial.print(F("PowerSave = ")); Serial.println(settings->power_save);
+      cfg_is_updated = true;
+    }
+
+    if (cfg_is_updated) {
+      SoC->WDT_fini();
+      if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
+      EEPROM_store();
+      nmea_cfg_restart();
+    }
+  }
+}
+
+static void NMEA_PSRFD(char **f, int n)
+{
+  if (strncmp(f[D_Version], "?", 1) == 0) {
+    char psrfd_buf[MAX_PSRFD_LEN];
+    snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+        PSTR("$PSRFD,%d,%d,%06X,%06X,%06X,%d,%d,%d,%02X,%d,%d,%d,%d,%d,%d*"),
+        PSRFD_VERSION,            settings->id_method,  settings->aircraft_id,
+        settings->ignore_id,      settings->follow_id,  settings->baud_rate,
+        settings->power_external, settings->nmea_d,     settings->debug_flags,
+        settings->nmea_out2,      settings->nmea2_g,    settings->nmea2_p,
+        settings->nmea2_l,        settings->nmea2_s,    settings->nmea2_d);
+
+    nmea_cfg_send();
+
+  } else if (atoi(f[D_Version]) == PSRFD_VERSION) {
+    bool cfg_is_updated = false;
+
+    if (CFG_UPDATED(D_id_method)) {
+      settings->id_method = atoi(f[D_id_method]);
+      Serial.print(F("ID method = ")); Serial.println(settings->id_method);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_aircraft_id)) {
+      settings->aircraft_id = strtoul(f[D_aircraft_id], NULL, 16);
+      Serial.print(F("Aircraft ID = ")); Serial.println(settings->aircraft_id, HEX);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_ignore_id)) {
+      settings->ignore_id = strtoul(f[D_ignore_id], NULL, 16);
+      Serial.print(F("Ignore ID = ")); Serial.println(settings->ignore_id, HEX);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_follow_id)) {
+      settings->follow_id = strtoul(f[D_follow_id], NULL, 16);
+      Serial.print(F("Follow ID = ")); Serial.println(settings->follow_id, HEX);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_baud_rate)) {
+      settings->baud_rate = atoi(f[D_baud_rate]);
+      Serial.print(F("Baud rate = ")); Serial.println(settings->baud_rate);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_power_ext)) {
+      settings->power_external = atoi(f[D_power_ext]);
+      Serial.print(F("Power source = ")); Serial.println(settings->power_external);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA_debug)) {
+      settings->nmea_d = atoi(f[D_NMEA_debug]);
+      Serial.print(F("NMEA_debug = ")); Serial.println(settings->nmea_d);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_debug_flags)) {
+      settings->debug_flags = atoi(f[D_debug_flags]);
+      Serial.print(F("Debug flags = ")); Serial.println(settings->debug_flags);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA2))
+    {
+      int nmea1 = settings->nmea_out;
+      int nmea2 = atoi(f[D_NMEA2]);
+      Serial.print(F("NMEA_Output2 (given) = ")); Serial.println(nmea2);
+      if (nmea2 == nmea1)
+          nmea2 = DEST_NONE;
+      if (hw_info.model == SOFTRF_MODEL_PRIME_MK2) {
+        if ((nmea1==DEST_UART || nmea1==DEST_USB)
+         && (nmea2==DEST_UART || nmea2==DEST_USB))
+            nmea2 = DEST_NONE;      // USB & UART wired together
+      }
 //            bool wireless1 = (nmea1==DEST_UDP || nmea1==DEST_TCP || nmea1==DEST_BLUETOOTH);
 //            bool wireless2 = (nmea2==DEST_UDP || nmea2==DEST_TCP || nmea2==DEST_BLUETOOTH);
 //            if (wireless1 && wireless2)
 //                  nmea2 = DEST_NONE;      // only one wireless output route possible
-            Serial.print(F("NMEA_Output2 (adjusted) = ")); Serial.println(nmea2);
-            settings->nmea_out2 = nmea2;
-            cfg_is_updated = true;
-          }
-          if (D_NMEA2_gnss.isUpdated())
-          {
-            settings->nmea2_g = atoi(D_NMEA2_gnss.value());
-            Serial.print(F("NMEA2_gnss = ")); Serial.println(settings->nmea_g);
-            cfg_is_updated = true;
-          }
-          if (D_NMEA2_private.isUpdated())
-          {
-            settings->nmea2_p = atoi(D_NMEA2_private.value());
-            Serial.print(F("NMEA2_private = ")); Serial.println(settings->nmea_p);
-            cfg_is_updated = true;
-          }
-          if (D_NMEA2_legacy.isUpdated())
-          {
-            settings->nmea2_l = atoi(D_NMEA2_legacy.value());
-            Serial.print(F("NMEA2_legacy = ")); Serial.println(settings->nmea_l);
-            cfg_is_updated = true;
-          }
-           if (D_NMEA2_sensors.isUpdated())
-          {
-            settings->nmea2_s = atoi(D_NMEA2_sensors.value());
-            Serial.print(F("NMEA2_sensors = ")); Serial.println(settings->nmea_s);
-            cfg_is_updated = true;
-          }
-          if (D_NMEA2_debug.isUpdated()) {
-            settings->nmea2_d = atoi(D_NMEA2_debug.value());
-            Serial.print(F("NMEA2_debug = ")); Serial.println(settings->nmea_d);
-            cfg_is_updated = true;
-          }
-          if (D_relay.isUpdated()) {
-            settings->relay = atoi(D_relay.value());
-            Serial.print(F("Relay = ")); Serial.println(settings->relay);
-            cfg_is_updated = true;
-          }
-          if (D_bluetooth.isUpdated()) {
-            settings->bluetooth = atoi(D_bluetooth.value());
-            Serial.print(F("Bluetooth = ")); Serial.println(settings->bluetooth);
-            cfg_is_updated = true;
-          }
+      Serial.print(F("NMEA_Output2 (adjusted) = ")); Serial.println(nmea2);
+      settings->nmea_out2 = nmea2;
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA2_gnss))
+    {
+      settings->nmea2_g = atoi(f[D_NMEA2_gnss]);
+      Serial.print(F("NMEA2_gnss = ")); Serial.println(settings->nmea_g);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA2_private))
+    {
+      settings->nmea2_p = atoi(f[D_NMEA2_private]);
+      Serial.print(F("NMEA2_private = ")); Serial.println(settings->nmea_p);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA2_legacy))
+    {
+      settings->nmea2_l = atoi(f[D_NMEA2_legacy]);
+      Serial.print(F("NMEA2_legacy = ")); Serial.println(settings->nmea_l);
+      cfg_is_updated = true;
+    }
+     if (CFG_UPDATED(D_NMEA2_sensors))
+    {
+      settings->nmea2_s = atoi(f[D_NMEA2_sensors]);
+      Serial.print(F("NMEA2_sensors = ")); Serial.println(settings->nmea_s);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_NMEA2_debug)) {
+      settings->nmea2_d = atoi(f[D_NMEA2_debug]);
+      Serial.print(F("NMEA2_debug = ")); Serial.println(settings->nmea_d);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_relay)) {
+      settings->relay = atoi(f[D_relay]);
+      Serial.print(F("Relay = ")); Serial.println(settings->relay);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_bluetooth)) {
+      settings->bluetooth = atoi(f[D_bluetooth]);
+      Serial.print(F("Bluetooth = ")); Serial.println(settings->bluetooth);
+      cfg_is_updated = true;
+    }
 #if defined(ESP32)
-          if (D_altpin0.isUpdated()) {
-            settings->altpin0 = atoi(D_altpin0.value());
-            Serial.print(F("Use alt RX pin = ")); Serial.println(settings->altpin0);
-            cfg_is_updated = true;
-          }
-          if (D_baudrate2.isUpdated()) {
-            settings->baudrate2 = atoi(D_baudrate2.value());
-            Serial.print(F("Baud rate 2 = ")); Serial.println(settings->baudrate2);
-            cfg_is_updated = true;
-          }
-          if (D_invert2.isUpdated()) {
-            settings->invert2 = atoi(D_invert2.value());
-            Serial.print(F("Serial2 logic = ")); Serial.println(settings->invert2);
-            cfg_is_updated = true;
-          }
+    if (CFG_UPDATED(D_altpin0)) {
+      settings->altpin0 = atoi(f[D_altpin0]);
+      Serial.print(F("Use alt RX pin = ")); Serial.println(settings->altpin0);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_baudrate2)) {
+      settings->baudrate2 = atoi(f[D_baudrate2]);
+      Serial.print(F("Baud rate 2 = ")); Serial.println(settings->baudrate2);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_invert2)) {
+      settings->invert2 = atoi(f[D_invert2]);
+      Serial.print(F("Serial2 logic = ")); Serial.println(settings->invert2);
+      cfg_is_updated = true;
+    }
 #endif
-          if (D_extern1.isUpdated()) {
-            settings->nmea_e = atoi(D_extern1.value());
-            Serial.print(F("NMEA1_ext = ")); Serial.println(settings->nmea_e);
-            cfg_is_updated = true;
-          }
-          if (D_extern2.isUpdated()) {
-            settings->nmea2_e = atoi(D_extern2.value());
-            Serial.print(F("NMEA2_ext = ")); Serial.println(settings->nmea2_e);
-            cfg_is_updated = true;
-          }
+    if (CFG_UPDATED(D_extern1)) {
+      settings->nmea_e = atoi(f[D_extern1]);
+      Serial.print(F("NMEA1_ext = ")); Serial.println(settings->nmea_e);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(D_extern2)) {
+      settings->nmea2_e = atoi(f[D_extern2]);
+      Serial.print(F("NMEA2_ext = ")); Serial.println(settings->nmea2_e);
+      cfg_is_updated = true;
+    }
 
-          if (cfg_is_updated) {
-            SoC->WDT_fini();
-            if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
-            EEPROM_store();
-            nmea_cfg_restart();
-          }
-        }
-      }
+    if (cfg_is_updated) {
+      SoC->WDT_fini();
+      if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
+      EEPROM_store();
+      nmea_cfg_restart();
+    }
+  }
+}
 
 #if defined(USE_OGN_ENCRYPTION)
-      if (S_Version.isUpdated()) {
-        if (strncmp(S_Version.value(), "?", 1) == 0) {
-
-          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-              PSTR("$PSRFS,%d,%08X%08X%08X%08X*"),
-              PSRFS_VERSION,
-              settings->igc_key[0]? 0x88888888 : 0,
-              settings->igc_key[1]? 0x88888888 : 0,
-              settings->igc_key[2]? 0x88888888 : 0,
-              settings->igc_key[3]? 0x88888888 : 0);
-              /* mask the key from prying eyes */
-
-          nmea_cfg_send();
-
-        } else if (atoi(S_Version.value()) == PSRFS_VERSION) {
-          bool cfg_is_updated = false;
-
-          if (S_IGC_Key.isUpdated())
-          {
-            char buf[32 + 1];
-
-            strncpy(buf, S_IGC_Key.value(), sizeof(buf));
-
-            settings->igc_key[3] = strtoul(buf + 24, NULL, 16);
-            buf[24] = 0;
-            settings->igc_key[2] = strtoul(buf + 16, NULL, 16);
-            buf[16] = 0;
-            settings->igc_key[1] = strtoul(buf +  8, NULL, 16);
-            buf[ 8] = 0;
-            settings->igc_key[0] = strtoul(buf +  0, NULL, 16);
-
-            snprintf_P(buf, sizeof(buf),
-              PSTR("%08X%08X%08X%08X"),
-              settings->igc_key[0], settings->igc_key[1],
-              settings->igc_key[2], settings->igc_key[3]);
-
-            Serial.print(F("IGC Key = ")); Serial.println(buf);
-            cfg_is_updated = true;
-          }
-          if (cfg_is_updated) {
-            SoC->WDT_fini();
-            if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
-            EEPROM_store();
-            nmea_cfg_restart();
-          }
-        }
-      }
+static void NMEA_PSRFS(char **f, int n)
+{
+  if (strncmp(f[S_Version], "?", 1) == 0) {
+
+    snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+        PSTR("$PSRFS,%d,%08X%08X%08X%08X*"),
+        PSRFS_VERSION,
+        settings->igc_key[0]? 0x88888888 : 0,
+        settings->igc_key[1]? 0x88888888 : 0,
+        settings->igc_key[2]? 0x88888888 : 0,
+        settings->igc_key[3]? 0x88888888 : 0);
+        /* mask the key from prying eyes */
+
+    nmea_cfg_send();
+
+  } else if (atoi(f[S_Version]) == PSRFS_VERSION) {
+    bool cfg_is_updated = false;
+
+    if (CFG_UPDATED(S_IGC_Key))
+    {
+      char buf[32 + 1];
+
+      strncpy(buf, f[S_IGC_Key], sizeof(buf));
+
+      settings->igc_key[3] = strtoul(buf + 24, NULL, 16);
+      buf[24] = 0;
+      settings->igc_key[2] = strtoul(buf + 16, NULL, 16);
+      buf[16] = 0;
+      settings->igc_key[1] = strtoul(buf +  8, NULL, 16);
+      buf[ 8] = 0;
+      settings->igc_key[0] = strtoul(buf +  0, NULL, 16);
+
+      snprintf_P(buf, sizeof(buf),
+        PSTR("%08X%08X%08X%08X"),
+        settings->igc_key[0], settings->igc_key[1],
+        settings->igc_key[2], settings->igc_key[3]);
+
+      Serial.print(F("IGC Key = ")); Serial.println(buf);
+      cfg_is_updated = true;
+    }
+    if (cfg_is_updated) {
+      SoC->WDT_fini();
+      if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
+      EEPROM_store();
+      nmea_cfg_restart();
+    }
+  }
+}
 #endif /* USE_OGN_ENCRYPTION */
 
 #if defined(USE_SKYVIEW_CFG)
-      if (V_Version.isUpdated()) {
-        if (strncmp(V_Version.value(), "?", 1) == 0) {
-
-          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
-              PSTR("$PSKVC,%d,%d,%d,%d,%d,%d,%d,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%X*"),
-              PSKVC_VERSION,  ui->adapter,      ui->connection,
-              ui->units,      ui->zoom,         ui->protocol,
-              ui->baudrate,   ui->server,       ui->key,
-              ui->rotate,     ui->orientation,  ui->adb,
-              ui->idpref,     ui->vmode,        ui->voice,
-              ui->aghost,     ui->filter,       ui->power_save,
-              ui->team);
-
-          nmea_cfg_send();
-
-        } else if (atoi(V_Version.value()) == PSKVC_VERSION) {
-          bool cfg_is_updated = false;
-
-          if (V_Adapter.isUpdated())
-          {
-            ui->adapter = atoi(V_Adapter.value());
-            Serial.print(F("Adapter = ")); Serial.println(ui->adapter);
-            cfg_is_updated = true;
-          }
-          if (V_Connection.isUpdated())
-          {
-            ui->connection = atoi(V_Connection.value());
-            Serial.print(F("Connection = ")); Serial.println(ui->connection);
-            cfg_is_updated = true;
-          }
-          if (V_Units.isUpdated())
-          {
-            ui->units = atoi(V_Units.value());
-            Serial.print(F("Units = ")); Serial.println(ui->units);
-            cfg_is_updated = true;
-          }
-          if (V_Zoom.isUpdated())
-          {
-            ui->zoom = atoi(V_Zoom.value());
-            Serial.print(F("Zoom = ")); Serial.println(ui->zoom);
-            cfg_is_updated = true;
-          }
-          if (V_Protocol.isUpdated())
-          {
-            ui->protocol = atoi(V_Protocol.value());
-            Serial.print(F("Protocol = ")); Serial.println(ui->protocol);
-            cfg_is_updated = true;
-          }
-          if (V_Baudrate.isUpdated())
-          {
-            ui->baudrate = atoi(V_Baudrate.value());
-            Serial.print(F("Baudrate = ")); Serial.println(ui->baudrate);
-            cfg_is_updated = true;
-          }
-          if (V_Server.isUpdated())
-          {
-            strncpy(ui->server, V_Server.value(), sizeof(ui->server));
-            Serial.print(F("Server = ")); Serial.println(ui->server);
-            cfg_is_updated = true;
-          }
-           if (V_Key.isUpdated())
-          {
-            strncpy(ui->key, V_Key.value(), sizeof(ui->key));
-            Serial.print(F("Key = ")); Serial.println(ui->key);
-            cfg_is_updated = true;
-          }
-          if (V_Rotate.isUpdated())
-          {
-            ui->rotate = atoi(V_Rotate.value());
-            Serial.print(F("Rotation = ")); Serial.println(ui->rotate);
-            cfg_is_updated = true;
-          }
-          if (V_Orientation.isUpdated())
-          {
-            ui->orientation = atoi(V_Orientation.value());
-            Serial.print(F("Orientation = ")); Serial.println(ui->orientation);
-            cfg_is_updated = true;
-          }
-          if (V_AvDB.isUpdated())
-          {
-            ui->adb = atoi(V_AvDB.value());
-            Serial.print(F("AvDB = ")); Serial.println(ui->adb);
-            cfg_is_updated = true;
-          }
-          if (V_ID_Pref.isUpdated())
-          {
-            ui->idpref = atoi(V_ID_Pref.value());
-            Serial.print(F("ID_Pref = ")); Serial.println(ui->idpref);
-            cfg_is_updated = true;
-          }
-           if (V_VMode.isUpdated())
-          {
-            ui->vmode = atoi(V_VMode.value());
-            Serial.print(F("VMode = ")); Serial.println(ui->vmode);
-            cfg_is_updated = true;
-          }
-          if (V_Voice.isUpdated())
-          {
-            ui->voice = atoi(V_Voice.value());
-            Serial.print(F("Voice = ")); Serial.println(ui->voice);
-            cfg_is_updated = true;
-          }
-          if (V_AntiGhost.isUpdated())
-          {
-            ui->aghost = atoi(V_AntiGhost.value());
-            Serial.print(F("AntiGhost = ")); Serial.println(ui->aghost);
-            cfg_is_updated = true;
-          }
-          if (V_Filter.isUpdated())
-          {
-            ui->filter = atoi(V_Filter.value());
-            Serial.print(F("Filter = ")); Serial.println(ui->filter);
-            cfg_is_updated = true;
-          }
-          if (V_PowerSave.isUpdated())
-          {
-            ui->power_save = atoi(V_PowerSave.value());
-            Serial.print(F("PowerSave = ")); Serial.println(ui->power_save);
-            cfg_is_updated = true;
-          }
-          if (V_Team.isUpdated())
-          {
-            ui->team = strtoul(V_Team.value(), NULL, 16);
-            Serial.print(F("Team = ")); Serial.println(ui->team, HEX);
-            cfg_is_updated = true;
-          }
+static void NMEA_PSKVC(char **f, int n)
+{
+  if (strncmp(f[V_Version], "?", 1) == 0) {
 
-          if (cfg_is_updated) {
-            SoC->WDT_fini();
-            if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
-            EEPROM_store();
-            nmea_cfg_restart();
-          }
-        }
-      }
+    snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+        PSTR("$PSKVC,%d,%d,%d,%d,%d,%d,%d,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%X*"),
+        PSKVC_VERSION,  ui->adapter,      ui->connection,
+        ui->units,      ui->zoom,         ui->protocol,
+        ui->baudrate,   ui->server,       ui->key,
+        ui->rotate,     ui->orientation,  ui->adb,
+        ui->idpref,     ui->vmode,        ui->voice,
+        ui->aghost,     ui->filter,       ui->power_save,
+        ui->team);
+
+    nmea_cfg_send();
+
+  } else if (atoi(f[V_Version]) == PSKVC_VERSION) {
+    bool cfg_is_updated = false;
+
+    if (CFG_UPDATED(V_Adapter))
+    {
+      ui->adapter = atoi(f[V_Adapter]);
+      Serial.print(F("Adapter = ")); Serial.println(ui->adapter);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Connection))
+    {
+      ui->connection = atoi(f[V_Connection]);
+      Serial.print(F("Connection = ")); Serial.println(ui->connection);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Units))
+    {
+      ui->units = atoi(f[V_Units]);
+      Serial.print(F("Units = ")); Serial.println(ui->units);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Zoom))
+    {
+      ui->zoom = atoi(f[V_Zoom]);
+      Serial.print(F("Zoom = ")); Serial.println(ui->zoom);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Protocol))
+    {
+      ui->protocol = atoi(f[V_Protocol]);
+      Serial.print(F("Protocol = ")); Serial.println(ui->protocol);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Baudrate))
+    {
+      ui->baudrate = atoi(f[V_Baudrate]);
+      Serial.print(F("Baudrate = ")); Serial.println(ui->baudrate);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Server))
+    {
+      strncpy(ui->server, f[V_Server], sizeof(ui->server));
+      Serial.print(F("Server = ")); Serial.println(ui->server);
+      cfg_is_updated = true;
+    }
+     if (CFG_UPDATED(V_Key))
+    {
+      strncpy(ui->key, f[V_Key], sizeof(ui->key));
+      Serial.print(F("Key = ")); Serial.println(ui->key);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Rotate))
+    {
+      ui->rotate = atoi(f[V_Rotate]);
+      Serial.print(F("Rotation = ")); Serial.println(ui->rotate);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Orientation))
+    {
+      ui->orientation = atoi(f[V_Orientation]);
+      Serial.print(F("Orientation = ")); Serial.println(ui->orientation);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_AvDB))
+    {
+      ui->adb = atoi(f[V_AvDB]);
+      Serial.print(F("AvDB = ")); Serial.println(ui->adb);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_ID_Pref))
+    {
+      ui->idpref = atoi(f[V_ID_Pref]);
+      Serial.print(F("ID_Pref = ")); Serial.println(ui->idpref);
+      cfg_is_updated = true;
+    }
+     if (CFG_UPDATED(V_VMode))
+    {
+      ui->vmode = atoi(f[V_VMode]);
+      Serial.print(F("VMode = ")); Serial.println(ui->vmode);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Voice))
+    {
+      ui->voice = atoi(f[V_Voice]);
+      Serial.print(F("Voice = ")); Serial.println(ui->voice);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_AntiGhost))
+    {
+      ui->aghost = atoi(f[V_AntiGhost]);
+      Serial.print(F("AntiGhost = ")); Serial.println(ui->aghost);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Filter))
+    {
+      ui->filter = atoi(f[V_Filter]);
+      Serial.print(F("Filter = ")); Serial.println(ui->filter);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_PowerSave))
+    {
+      ui->power_save = atoi(f[V_PowerSave]);
+      Serial.print(F("PowerSave = ")); Serial.println(ui->power_save);
+      cfg_is_updated = true;
+    }
+    if (CFG_UPDATED(V_Team))
+    {
+      ui->team = strtoul(f[V_Team], NULL, 16);
+      Serial.print(F("Team = ")); Serial.println(ui->team, HEX);
+      cfg_is_updated = true;
+    }
+
+    if (cfg_is_updated) {
+      SoC->WDT_fini();
+      if (SoC->Bluetooth_ops) { SoC->Bluetooth_ops->fini(); }
+      EEPROM_store();
+      nmea_cfg_restart();
+    }
+  }
+}
 #endif /* USE_SKYVIEW_CFG */
+
+/* the 4 characters after the 'P' of a proprietary sentence type */
+#define NMEA_TYPE(a,b,c,d)  (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | \
+                             ((uint32_t)(c) <<  8) |  (uint32_t)(d))
+
+#define NMEA_CFG_FIELDS     24
+
+/*
+ * Process one whole configuration sentence.  Its checksum is checked and
+ * it is split into fields once, then handed to the handler of its type.
+ * Returns false if the sentence is not valid.
+ */
+bool NMEA_Process_SRF_SKV_Sentences(const char *s, size_t len)
+{
+  static char buf[2 * NMEA_BUFFER_SIZE];
+  char *f[NMEA_CFG_FIELDS];
+
+  int n = NMEA_tokenize(s, len, buf, sizeof(buf), f, NMEA_CFG_FIELDS);
+  if (n == 0)
+    return false;
+
+  const char *t = f[0];
+  if (t[0] != 'P' || strlen(t) != 5 || n < 2)
+    return true;
+
+  switch (NMEA_TYPE(t[1], t[2], t[3], t[4]))
+  {
+  case NMEA_TYPE('S','R','F','C'):
+    NMEA_PSRFC(f, n);
+    break;
+  case NMEA_TYPE('S','R','F','D'):
+    NMEA_PSRFD(f, n);
+    break;
+#if defined(USE_OGN_ENCRYPTION)
+  case NMEA_TYPE('S','R','F','S'):
+    NMEA_PSRFS(f, n);
+    break;
+#endif /* USE_OGN_ENCRYPTION */
+#if defined(USE_SKYVIEW_CFG)
+  case NMEA_TYPE('S','K','V','C'):
+    NMEA_PSKVC(f, n);
+    break;
+#endif /* USE_SKYVIEW_CFG */
+  default:
+    break;
+  }
+
+  return true;
 }
 #endif /* USE_NMEA_CFG */
 
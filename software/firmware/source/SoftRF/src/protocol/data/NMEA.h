@@ -31,6 +31,12 @@
 #define NMEA_BUFFER_SIZE    128
 #define NMEA_CALLSIGN_SIZE  (3 /* prefix */ + 1 /* _ */ + 6 /* ICAO */ + 1 /* EOL */)
 
+/* bytes queued per NMEA output between two NMEA_Flush() calls, */
+/* small for the MCUs with little RAM, platforms with more raise it */
+#if !defined(NMEA_QUEUE_SIZE)
+#define NMEA_QUEUE_SIZE     256
+#endif
+
 #define PSRFC_VERSION       1
 #define MAX_PSRFC_LEN       64
 
@@ -50,11 +56,24 @@ void NMEA_Export(void);
 void NMEA_Position(void);
 void NMEA_Out(uint8_t, const char *, size_t, bool);
 void NMEA_Outs(bool, bool, const char *, size_t, bool);
+void NMEA_Flush(void);
 void NMEA_GGA(void);
+void NMEA_RMC(void);
 void NMEA_add_checksum(char *, size_t);
+int  NMEA_tokenize(const char *, size_t, char *, size_t, char **, int);
 
 int WiFi_transmit_TCP(const char *buf, size_t size);
 
+typedef struct NMEA_Out_Stats_struct {
+  uint32_t sent;        /* bytes taken by the sink */
+  uint32_t dropped;     /* bytes of sentences that found the queue full */
+  uint32_t drops;       /* such sentences */
+  uint32_t stalls;      /* flushes the sink did not take in full */
+  uint32_t queued;      /* bytes waiting now */
+} NMEA_Out_Stats_t;
+
+void NMEA_Out_Stats(int, NMEA_Out_Stats_t *);
+
 char *bytes2Hex(byte *, size_t);
 
 extern uint8_t NMEA_Source;
@@ -65,7 +84,7 @@ extern bool rx1090found;
 extern bool NMEA_bridge_sent;
 
 #if defined(USE_NMEA_CFG)
-void NMEA_Process_SRF_SKV_Sentences(void);
+bool NMEA_Process_SRF_SKV_Sentences(const char *, size_t);
 #endif /* USE_NMEA_CFG */
 
 #if defined(NMEA_TCP_SERVICE)
@@ -111,53 +111,134 @@ void btea(uint32_t *v, int8_t n, const uint32_t key[4]) {
 }
 
 
+/*
+ * The fixed key of the 2024 protocol makes the whole btea() key schedule
+ * a constant: the key word used at position p in round r is
+ * key[(p & 3) ^ e(r)], with e(r) taken from sum = (r + 1) * DELTA.
+ */
+static constexpr uint32_t btea2_keys[4] = { 0xa5f9b21c, 0xab3f9d12, 0xc6f34e34, 0xd72fa378 };
+
+#define BTEA2_SUM(r)    ((uint32_t) (((r) + 1) * (uint64_t) DELTA))
+#define BTEA2_KEY(r,p)  btea2_keys[(p) ^ ((BTEA2_SUM(r) >> 2) & 3)]
+#define BTEA2_ROUND(r)  { BTEA2_KEY(r,0), BTEA2_KEY(r,1), BTEA2_KEY(r,2), BTEA2_KEY(r,3) }
+
+static const uint32_t btea2_schedule[ROUNDS][4] = {
+    BTEA2_ROUND(0), BTEA2_ROUND(1), BTEA2_ROUND(2),
+    BTEA2_ROUND(3), BTEA2_ROUND(4), BTEA2_ROUND(5)
+};
+
+#define MX2(k) (((z >> 5 ^ y << 2) + (y >> 3 ^ z << 4)) ^ ((sum ^ y) + ((k) ^ z)))
+
 // first stage of decrypting
+// - same as btea(data+2, +/-4, btea2_keys), unrolled over the fixed schedule
 void btea2(uint32_t *data, bool encode)
 {
-    // for new protocol, ths btea() stage uses fixed keys
-    static const uint32_t keys[4] = { 0xa5f9b21c, 0xab3f9d12, 0xc6f34e34, 0xd72fa378 };
-    btea(data+2, (encode? 4 : -4), keys);
+    uint32_t *v = data + 2;
+    uint32_t y, z, sum;
+    int r;
+
+    if (encode) {
+        z = v[3];
+        for (r = 0; r < ROUNDS; r++) {
+            const uint32_t *k = btea2_schedule[r];
+            sum = BTEA2_SUM(r);
+            y = v[1]; z = v[0] += MX2(k[0]);
+            y = v[2]; z = v[1] += MX2(k[1]);
+            y = v[3]; z = v[2] += MX2(k[2]);
+            y = v[0]; z = v[3] += MX2(k[3]);
+        }
+    } else {
+        y = v[0];
+        for (r = ROUNDS - 1; r >= 0; r--) {
+            const uint32_t *k = btea2_schedule[r];
+            sum = BTEA2_SUM(r);
+            z = v[2]; y = v[3] -= MX2(k[3]);
+            z = v[1]; y = v[2] -= MX2(k[2]);
+            z = v[0]; y = v[1] -= MX2(k[1]);
+            z = v[3]; y = v[0] -= MX2(k[0]);
+        }
+    }
 }
 
+/*
+ * Keys only change with the time epoch, so they are cached per sender:
+ * make_key() depends on (timestamp >> 6, address) and the scramble()
+ * mask on (timestamp >> 4, first two packet words), which hold steady
+ * for the dozens of packets one aircraft sends in that time.
+ */
+/* entries per cache, a power of two in line with the traffic table size */
+#if !defined(LEGACY_KEY_CACHE_SIZE)
+#if MAX_TRACKING_OBJECTS > 128
+#define LEGACY_KEY_CACHE_SIZE  256
+#elif MAX_TRACKING_OBJECTS > 64
+#define LEGACY_KEY_CACHE_SIZE  128
+#elif MAX_TRACKING_OBJECTS > 32
+#define LEGACY_KEY_CACHE_SIZE  64
+#else
+#define LEGACY_KEY_CACHE_SIZE  32
+#endif
+#endif /* LEGACY_KEY_CACHE_SIZE */
+
+#define LEGACY_KEY_VALID    0x80000000UL    /* above any epoch value */
+
+typedef struct {
+    uint32_t epoch;      /* | LEGACY_KEY_VALID */
+    uint32_t id[2];
+    uint32_t key[4];
+} legacy_key_cache_t;
+
+static legacy_key_cache_t legacy_keys[LEGACY_KEY_CACHE_SIZE];
+static legacy_key_cache_t latest_keys[LEGACY_KEY_CACHE_SIZE];
+
 // second stage of decrypting
 void scramble(uint32_t *data, uint32_t timestamp)
 {
-
-    uint32_t wkeys[4];
-    wkeys[0] = data[0];
-    wkeys[1] = data[1];
-    wkeys[2] = (timestamp >> 4);
-    wkeys[3] = 0x956f6c77;         // the scramble KEY
-
-    int z, y, x, sum, p, q;
-    //int n = 16;                        // do by bytes instead of longwords
-    byte *bkeys = (byte *) wkeys;
-
-    z = bkeys[15];
-    sum = 0;
-    q = 2;                         // only 2 iterations
-    do {
-      sum += DELTA;
-      y = bkeys[0];
-      for (p=0; p<15; p++) {
+    uint32_t epoch = (timestamp >> 4) | LEGACY_KEY_VALID;
+    legacy_key_cache_t *kc = &latest_keys[(data[0] ^ (data[0] >> 12) ^ data[1] ^ epoch)
+                                          & (LEGACY_KEY_CACHE_SIZE - 1)];
+
+    if (kc->epoch != epoch || kc->id[0] != data[0] || kc->id[1] != data[1]) {
+
+      uint32_t *wkeys = kc->key;
+      wkeys[0] = data[0];
+      wkeys[1] = data[1];
+      wkeys[2] = (timestamp >> 4);
+      wkeys[3] = 0x956f6c77;         // the scramble KEY
+
+      int z, y, x, sum, p, q;
+      //int n = 16;                        // do by bytes instead of longwords
+      byte *bkeys = (byte *) wkeys;
+
+      z = bkeys[15];
+      sum = 0;
+      q = 2;                         // only 2 iterations
+      do {
+        sum += DELTA;
+        y = bkeys[0];
+        for (p=0; p<15; p++) {
+          x = y;
+          y = bkeys[p+1];
+          x += ((((z >> 5) ^ (y << 2)) + ((y >> 3) ^ (z << 4))) ^ (sum ^ y));
+          bkeys[p] = (byte)x;
+          z = x & 0xff;
+        }
         x = y;
-        y = bkeys[p+1];
+        y = bkeys[0];
         x += ((((z >> 5) ^ (y << 2)) + ((y >> 3) ^ (z << 4))) ^ (sum ^ y));
-        bkeys[p] = (byte)x;
+        bkeys[15] = (byte)x;
         z = x & 0xff;
-      }
-      x = y;
-      y = bkeys[0];
-      x += ((((z >> 5) ^ (y << 2)) + ((y >> 3) ^ (z << 4))) ^ (sum ^ y));
-      bkeys[15] = (byte)x;
-      z = x & 0xff;
-    } while (--q > 0);
+      } while (--q > 0);
+
+      kc->epoch = epoch;
+      kc->id[0] = data[0];
+      kc->id[1] = data[1];
+    }
 
     // now XOR results with last 4 words of the packet
-    data[2] ^= wkeys[0];
-    data[3] ^= wkeys[1];
-    data[4] ^= wkeys[2];
-    data[5] ^= wkeys[3];
+    data[2] ^= kc->key[0];
+    data[3] ^= kc->key[1];
+    data[4] ^= kc->key[2];
+    data[5] ^= kc->key[3];
 }
 
 /* http://pastebin.com/YK2f8bfm */
@@ -170,11 +251,24 @@ long obscure(uint32_t key, uint32_t seed) {
 static const uint32_t table[8] = LEGACY_KEY1;
 
 void make_key(uint32_t key[4], uint32_t timestamp, uint32_t address) {
-    int8_t i, ndx;
-    for (i = 0; i < 4; i++) {
-        ndx = ((timestamp >> 23) & 1) ? i+4 : i ;
-        key[i] = obscure(table[ndx] ^ ((timestamp >> 6) ^ address), LEGACY_KEY2) ^ LEGACY_KEY3;
+    uint32_t epoch = (timestamp >> 6) | LEGACY_KEY_VALID;
+    legacy_key_cache_t *kc = &legacy_keys[(address ^ (address >> 8) ^ (address >> 16) ^ epoch)
+                                          & (LEGACY_KEY_CACHE_SIZE - 1)];
+
+    if (kc->epoch != epoch || kc->id[0] != address) {
+        int8_t i, ndx;
+        for (i = 0; i < 4; i++) {
+            ndx = ((timestamp >> 23) & 1) ? i+4 : i ;
+            kc->key[i] = obscure(table[ndx] ^ ((timestamp >> 6) ^ address), LEGACY_KEY2) ^ LEGACY_KEY3;
+        }
+        kc->epoch = epoch;
+        kc->id[0] = address;
     }
+
+    key[0] = kc->key[0];
+    key[1] = kc->key[1];
+    key[2] = kc->key[2];
+    key[3] = kc->key[3];
 }
 
 // lookup the divisor for latitude for new protocol
@@ -436,13 +530,11 @@ bool legacy_decode(void *buffer, ufo_t *this_aircraft, ufo_t *fop) {
     if (fop->addr == ThisAircraft.addr)
          return false;                 /* same ID as this aircraft - ignore */
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr == fop->addr) {
-        if (RF_last_crc != 0 && RF_last_crc == Container[i].last_crc) {
-          //Serial.println("duplicate packet");      // usually duplicated in 2nd time slot
-          return false;
-          //break;
-        }
+    int i = Traffic_Find(fop->addr);
+    if (i >= 0) {
+      if (RF_last_crc != 0 && RF_last_crc == Container[i].last_crc) {
+        //Serial.println("duplicate packet");      // usually duplicated in 2nd time slot
+        return false;
       }
     }
     fop->last_crc = RF_last_crc;
@@ -48,4 +48,25 @@ extern const rf_proto_desc_t ogntp_proto_desc;
 bool ogntp_decode(void *, ufo_t *, ufo_t *);
 size_t ogntp_encode(void *, ufo_t *);
 
+/*
+ * LDPC_Repair() of an OGNTP frame, re-validated: a repair which lands on
+ * a wrong codeword and flips an odd number of header bits breaks the
+ * address parity, so the frame is dropped rather than decoded.
+ */
+static inline int8_t ogntp_repair(uint8_t *frame, uint8_t *err = NULL)
+{
+  int8_t corrected = LDPC_Repair(frame, err);
+
+  if (corrected > 0) {
+    OGN_Packet header;
+
+    memcpy(&header.HeaderWord, frame, sizeof(header.HeaderWord));
+    if (!header.goodAddrParity()) {
+      return -1;
+    }
+  }
+
+  return corrected;
+}
+
 #endif /* PROTOCOL_OGNTP_H */
\ No newline at end of file
@@ -56,7 +56,8 @@ const rf_proto_desc_t p3i_proto_desc = {
   .slot1            = {0, 0}
 };
 
-const uint8_t whitening_pattern[] PROGMEM = { 0x05, 0xb4, 0x05, 0xae, 0x14, 0xda,
+/* word aligned, so that the radio drivers can apply it 32 bits at a time */
+const uint8_t whitening_pattern[] PROGMEM __attribute__((aligned(4))) = { 0x05, 0xb4, 0x05, 0xae, 0x14, 0xda,
   0xbf, 0x83, 0xc4, 0x04, 0xb2, 0x04, 0xd6, 0x4d, 0x87, 0xe2, 0x01, 0xa3, 0x26,
   0xac, 0xbb, 0x63, 0xf1, 0x01, 0xca, 0x07, 0xbd, 0xaf, 0x60, 0xc8, 0x12, 0xed,
   0x04, 0xbc, 0xf6, 0x12, 0x2c, 0x01, 0xd9, 0x04, 0xb1, 0xd5, 0x03, 0xab, 0x06,
@@ -0,0 +1,179 @@
+/*
+ * ADB.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ADB.h"
+
+#if defined(RASPBERRY_PI)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* RASPBERRY_PI */
+
+static uint32_t ADB_u4(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static bool ADB_map_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+  adb_t *adb = (adb_t *) ctx;
+
+  if (offset > adb->size || len > adb->size - offset)
+    return false;
+  memcpy(buf, adb->map + offset, len);
+  return true;
+}
+
+static bool ADB_header(adb_t *adb)
+{
+  uint8_t h[sizeof(adb_header_t)];
+  adb_header_t *hdr = &adb->hdr;
+
+  if (!adb->read(adb->ctx, 0, h, sizeof(h)) || memcmp(h, ADB_MAGIC, 4) != 0)
+    return false;
+
+  memcpy(hdr->magic, h, 4);
+  hdr->type_len = h[4];
+  hdr->reg_len  = h[5];
+  hdr->cn_len   = h[6];
+  hdr->records  = ADB_u4(h + 8);
+  hdr->buckets  = ADB_u4(h + 12);
+  hdr->seeds    = ADB_u4(h + 16);
+  hdr->data     = ADB_u4(h + 20);
+
+  if (hdr->type_len > ADB_FIELD_MAX || hdr->reg_len > ADB_FIELD_MAX ||
+      hdr->cn_len > ADB_FIELD_MAX || hdr->records == 0 || hdr->buckets == 0)
+    return false;
+
+  adb->rec_size = 3 + hdr->type_len + hdr->reg_len + hdr->cn_len;
+  return true;
+}
+
+/* a data base read through the given function, e.g. from a file on flash */
+bool ADB_open(adb_t *adb, adb_read_t read, void *ctx)
+{
+  adb->map  = NULL;
+  adb->size = 0;
+  adb->read = read;
+  adb->ctx  = ctx;
+  return ADB_header(adb);
+}
+
+/* a data base that is in memory as a whole */
+bool ADB_open_map(adb_t *adb, const uint8_t *map, size_t size)
+{
+  adb->map  = map;
+  adb->size = size;
+  adb->read = ADB_map_read;
+  adb->ctx  = adb;
+  return ADB_header(adb);
+}
+
+static void ADB_field(char *dst, const uint8_t *src, size_t len)
+{
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+}
+
+/* look up a 24-bit address, true and the record if it is there */
+bool ADB_find(adb_t *adb, uint32_t addr, adb_record_t *rec)
+{
+  const adb_header_t *hdr = &adb->hdr;
+  uint8_t buf[3 + 3 * ADB_FIELD_MAX];
+  const uint8_t *r;
+  uint32_t seed, slot, offset;
+
+  addr &= 0xFFFFFF;
+
+  offset = hdr->seeds + (ADB_hash(addr, ADB_BUCKET_SEED) % hdr->buckets) * 4;
+  if (adb->map != NULL) {
+    if (offset + 4 > adb->size)
+      return false;
+    seed = ADB_u4(adb->map + offset);
+  } else {
+    if (!adb->read(adb->ctx, offset, buf, 4))
+      return false;
+    seed = ADB_u4(buf);
+  }
+
+  slot = (seed & ADB_DIRECT) ? (seed & ~ADB_DIRECT) : ADB_hash(addr, seed) % hdr->records;
+  if (slot >= hdr->records)
+    return false;
+
+  offset = hdr->data + slot * adb->rec_size;
+  if (adb->map != NULL) {
+    if (offset + adb->rec_size > adb->size)
+      return false;
+    r = adb->map + offset;
+  } else {
+    if (!adb->read(adb->ctx, offset, buf, adb->rec_size))
+      return false;
+    r = buf;
+  }
+
+  if ((r[0] | (r[1] << 8) | ((uint32_t) r[2] << 16)) != addr)
+    return false;
+
+  if (rec != NULL) {
+    r += 3;
+    ADB_field(rec->type, r, hdr->type_len);
+    r += hdr->type_len;
+    ADB_field(rec->reg,  r, hdr->reg_len);
+    r += hdr->reg_len;
+    ADB_field(rec->cn,   r, hdr->cn_len);
+  }
+
+  return true;
+}
+
+#if defined(RASPBERRY_PI)
+bool ADB_mmap(adb_t *adb, const char *path)
+{
+  struct stat st;
+  void *map;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0)
+    return false;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(adb_header_t)) {
+    close(fd);
+    return false;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  if (!ADB_open_map(adb, (const uint8_t *) map, st.st_size)) {
+    munmap(map, st.st_size);
+    return false;
+  }
+  return true;
+}
+
+void ADB_munmap(adb_t *adb)
+{
+  if (adb->map != NULL) {
+    munmap((void *) adb->map, adb->size);
+    adb->map = NULL;
+  }
+}
+#endif /* RASPBERRY_PI */
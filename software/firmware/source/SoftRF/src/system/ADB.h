@@ -0,0 +1,93 @@
+/*
+ * ADB.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADBHELPER_H
+#define ADBHELPER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Aircraft data base, as made by utils/adb.py from the OGN DDB or FlarmNet:
+ *
+ *   header       adb_header_t, little endian
+ *   seeds        one uint32_t per hash bucket
+ *   records      fixed size: 24-bit address, then type, registration and
+ *                CN, each NUL padded to the width given in the header
+ *
+ * A minimal perfect hash puts every address of the data base in a record
+ * slot of its own: the address picks a bucket, the bucket seed either is
+ * the slot (bit 31 set) or the seed of a second hash that gives the slot.
+ * A lookup reads one seed and one record, and the address stored in the
+ * record tells whether it was there at all.
+ */
+
+#define ADB_MAGIC       "ADB1"
+#define ADB_FIELD_MAX   31
+#define ADB_DIRECT      0x80000000UL
+#define ADB_BUCKET_SEED 0xFFFFFFFFUL
+
+typedef struct adb_header_struct {
+  char     magic[4];
+  uint8_t  type_len;
+  uint8_t  reg_len;
+  uint8_t  cn_len;
+  uint8_t  reserved;
+  uint32_t records;
+  uint32_t buckets;
+  uint32_t seeds;             /* file offset of the bucket seeds */
+  uint32_t data;              /* file offset of the records */
+} adb_header_t;
+
+typedef struct adb_record_struct {
+  char type[ADB_FIELD_MAX + 1];
+  char reg [ADB_FIELD_MAX + 1];
+  char cn  [ADB_FIELD_MAX + 1];
+} adb_record_t;
+
+/* read len bytes at offset of the file, false on a short read */
+typedef bool (*adb_read_t)(void *ctx, uint32_t offset, void *buf, size_t len);
+
+typedef struct adb_struct {
+  adb_header_t  hdr;
+  uint32_t      rec_size;
+  const uint8_t *map;         /* the whole file, when it is in memory */
+  size_t        size;
+  adb_read_t    read;
+  void          *ctx;
+} adb_t;
+
+static inline uint32_t ADB_hash(uint32_t addr, uint32_t seed)
+{
+  uint32_t h = (addr ^ seed) * 0x9E3779B1UL;
+  h ^= h >> 15;
+  h *= 0x85EBCA77UL;
+  h ^= h >> 13;
+  return h;
+}
+
+bool ADB_open(adb_t *, adb_read_t, void *);
+bool ADB_open_map(adb_t *, const uint8_t *, size_t);
+bool ADB_find(adb_t *, uint32_t, adb_record_t *);
+
+#if defined(RASPBERRY_PI)
+bool ADB_mmap(adb_t *, const char *);
+void ADB_munmap(adb_t *);
+#endif /* RASPBERRY_PI */
+
+#endif /* ADBHELPER_H */
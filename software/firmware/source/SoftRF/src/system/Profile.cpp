@@ -0,0 +1,151 @@
+/*
+ * Profile.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoC.h"
+#include "Profile.h"
+#include "../driver/EEPROM.h"
+#include "../protocol/data/NMEA.h"
+
+#if defined(USE_PROFILER)
+
+/*
+ * Time spent in the stages of the main loop, and how long the loop takes.
+ * Every PROFILE_REPORT_MS the counts are turned into a report, shown on the
+ * web status page and sent as $PSRFP sentences to the NMEA outputs that
+ * have debug sentences enabled:
+ *
+ *   $PSRFP,<stage>,<calls>,<min>,<avg>,<max>*CS     (microseconds)
+ *   $PSRFP,LOOP,<loops in each of the PROFILE_BUCKETS periods>*CS
+ */
+
+profile_stage_t  Profile_stage[PROFILE_STAGES];
+profile_report_t Profile_report;
+
+const char * const Profile_name[PROFILE_STAGES] = {
+  "GNSS", "RX", "DECODE", "TRAFFIC", "ALARM", "EXPORT", "DISPLAY"
+};
+
+static const uint32_t Profile_bucket_us[PROFILE_BUCKETS-1] = {
+  100, 300, 1000, 3000, 10000, 30000, 100000
+};
+
+static uint32_t Profile_loops[PROFILE_BUCKETS];
+
+static void Profile_NMEA()
+{
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    if (Profile_report.calls[s] == 0)
+      continue;
+    snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+      PSTR("$PSRFP,%s,%u,%u,%u,%u*"),
+      Profile_name[s], Profile_report.calls[s], Profile_report.min_us[s],
+      Profile_report.avg_us[s], Profile_report.max_us[s]);
+    NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
+    NMEA_Outs(settings->nmea_d, settings->nmea2_d, NMEABuffer, strlen(NMEABuffer), false);
+  }
+
+  const uint32_t *n = Profile_report.loops;
+  snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+    PSTR("$PSRFP,LOOP,%u,%u,%u,%u,%u,%u,%u,%u*"),
+    n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7]);
+  NMEA_add_checksum(NMEABuffer, sizeof(NMEABuffer) - strlen(NMEABuffer));
+  NMEA_Outs(settings->nmea_d, settings->nmea2_d, NMEABuffer, strlen(NMEABuffer), false);
+}
+
+/* call once at the top of every main loop pass */
+void Profile_loop()
+{
+  static uint32_t prev_us = 0;
+  static uint32_t report_ms = 0;
+
+#if defined(ARDUINO_ARCH_NRF52)
+  if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  }
+#endif /* ARDUINO_ARCH_NRF52 */
+
+  uint32_t now_us = micros();
+  if (prev_us != 0) {
+    uint32_t period = now_us - prev_us;
+    int b = 0;
+    while (b < PROFILE_BUCKETS-1 && period > Profile_bucket_us[b])
+      b++;
+    Profile_loops[b]++;
+  }
+  prev_us = now_us;
+
+  if (millis() - report_ms < PROFILE_REPORT_MS)
+    return;
+  report_ms = millis();
+
+  uint32_t ticks_per_us = PROFILE_TICKS_PER_US;
+  for (int s = 0; s < PROFILE_STAGES; s++) {
+    profile_stage_t *p = &Profile_stage[s];
+    uint32_t calls = p->calls;
+    Profile_report.calls[s]  = calls;
+    Profile_report.min_us[s] = calls ? p->min / ticks_per_us : 0;
+    Profile_report.avg_us[s] = calls ? (uint32_t) (p->sum / calls) / ticks_per_us : 0;
+    Profile_report.max_us[s] = p->max / ticks_per_us;
+    p->calls = 0;
+    p->max   = 0;
+    p->sum   = 0;
+  }
+  memcpy(Profile_report.loops, Profile_loops, sizeof(Profile_loops));
+  memset(Profile_loops, 0, sizeof(Profile_loops));
+
+  if (settings->nmea_d || settings->nmea2_d)
+    Profile_NMEA();
+}
+
+/* the last report as rows of an HTML table, returns the length */
+size_t Profile_html(char *buf, size_t size)
+{
+  size_t len = 0;
+  buf[0] = '\0';
+
+  snprintf_P(buf, size,
+    PSTR("<tr><th align=left>Stage (&micro;s)</th><th align=right>Calls</th>\
+<th align=right>Min</th><th align=right>Avg</th><th align=right>Max</th></tr>"));
+  len = strlen(buf);
+
+  for (int s = 0; s < PROFILE_STAGES && len < size; s++) {
+    if (Profile_report.calls[s] == 0)
+      continue;
+    snprintf_P(buf + len, size - len,
+      PSTR("<tr><th align=left>%s</th><td align=right>%u</td><td align=right>%u</td>\
+<td align=right>%u</td><td align=right>%u</td></tr>"),
+      Profile_name[s], Profile_report.calls[s], Profile_report.min_us[s],
+      Profile_report.avg_us[s], Profile_report.max_us[s]);
+    len += strlen(buf + len);
+  }
+
+  if (len < size) {
+    const uint32_t *n = Profile_report.loops;
+    snprintf_P(buf + len, size - len,
+      PSTR("<tr><th align=left>Loops</th><td align=right colspan=4>\
+%u &lt;0.1 ms, %u &lt;0.3, %u &lt;1, %u &lt;3, %u &lt;10, %u &lt;30, %u &lt;100, %u more</td></tr>"),
+      n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7]);
+    len += strlen(buf + len);
+  }
+
+  return len;
+}
+
+#endif /* USE_PROFILER */
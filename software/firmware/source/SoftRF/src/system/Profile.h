@@ -0,0 +1,112 @@
+/*
+ * Profile.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILEHELPER_H
+#define PROFILEHELPER_H
+
+#include "../../SoftRF.h"
+
+/* stages of the main loop that are timed */
+enum
+{
+  PROFILE_GNSS,
+  PROFILE_RX,
+  PROFILE_DECODE,
+  PROFILE_TRAFFIC,
+  PROFILE_ALARM,
+  PROFILE_EXPORT,
+  PROFILE_DISPLAY,
+  PROFILE_STAGES
+};
+
+/* loop period histogram, upper bounds of the buckets in microseconds */
+#define PROFILE_BUCKETS       8     /* 100, 300 us, 1, 3, 10, 30, 100 ms, more */
+#define PROFILE_REPORT_MS     10000
+
+/* Profile_html() at worst: header, a row per stage and the loops row, 10 digit values */
+#define PROFILE_HTML_SIZE     (144 + PROFILE_STAGES * 160 + 218)
+
+#if defined(USE_PROFILER)
+
+#if defined(ESP32)
+#define Profile_ticks()       ESP.getCycleCount()
+#define PROFILE_TICKS_PER_US  ESP.getCpuFreqMHz()
+#elif defined(ARDUINO_ARCH_NRF52)
+#define Profile_ticks()       (DWT->CYCCNT)
+#define PROFILE_TICKS_PER_US  (SystemCoreClock / 1000000)
+#elif defined(RASPBERRY_PI)
+#include <time.h>
+static inline uint32_t Profile_ticks()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t) ts.tv_sec * 1000000000UL + (uint32_t) ts.tv_nsec;
+}
+#define PROFILE_TICKS_PER_US  1000
+#else
+#error "USE_PROFILER needs a cycle counter for this platform"
+#endif
+
+typedef struct profile_stage_struct {
+  uint32_t calls;
+  uint32_t min;         /* ticks */
+  uint32_t max;
+  uint64_t sum;
+} profile_stage_t;
+
+/* one report period: stage times in microseconds */
+typedef struct profile_report_struct {
+  uint32_t calls[PROFILE_STAGES];
+  uint32_t min_us[PROFILE_STAGES];
+  uint32_t avg_us[PROFILE_STAGES];
+  uint32_t max_us[PROFILE_STAGES];
+  uint32_t loops[PROFILE_BUCKETS];
+} profile_report_t;
+
+extern profile_stage_t Profile_stage[PROFILE_STAGES];
+extern profile_report_t Profile_report;
+extern const char * const Profile_name[PROFILE_STAGES];
+
+static inline void Profile_add(int stage, uint32_t ticks)
+{
+  profile_stage_t *p = &Profile_stage[stage];
+  if (p->calls++ == 0 || ticks < p->min)
+    p->min = ticks;
+  if (ticks > p->max)
+    p->max = ticks;
+  p->sum += ticks;
+}
+
+/* time the statement(s) given as a stage of the loop */
+#define PROFILE(stage, ...)   do {                                      \
+                                uint32_t profile_t0 = Profile_ticks();  \
+                                __VA_ARGS__;                            \
+                                Profile_add(stage, Profile_ticks() - profile_t0); \
+                              } while (0)
+
+void Profile_loop(void);
+size_t Profile_html(char *, size_t);
+
+#else
+
+#define PROFILE(stage, ...)   do { __VA_ARGS__; } while (0)
+#define Profile_loop()        {}
+
+#endif /* USE_PROFILER */
+
+#endif /* PROFILEHELPER_H */
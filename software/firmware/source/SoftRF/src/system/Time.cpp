@@ -236,6 +236,8 @@ void Time_loop()
           newtime = pps_btime_ms + ADJ_FOR_FLARM_RECEPTION;   /* seems to receive FLARM better */
         } else {   /* PPS not available */
           time_corr_neg = gnss_chip ? gnss_chip->rmc_ms : 100;
+          if (GNSS_pvt_mode)      /* the epoch is known to the centisecond */
+            time_corr_neg = UBX_PVT_MS + gnss.time.centisecond() * 10;
           newtime = last_Commit_Time - time_corr_neg;
         }
     
@@ -118,7 +118,8 @@ static void EPD_Draw_Radar()
     display->fillScreen(GxEPD_WHITE);
 
     {
-      for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+      for (int n=0; n < Traffic_Count(); n++) {
+        int i = traffic_slots[n];
         if (Container[i].addr && (now() - Container[i].timestamp) <= EPD_EXPIRATION_TIME) {
 
           int16_t rel_x;
@@ -61,7 +61,8 @@ static void EPD_Draw_Text()
   char info_line [TEXT_VIEW_LINE_LENGTH];
   char id_text   [TEXT_VIEW_LINE_LENGTH];
 
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+  for (int n=0; n < Traffic_Count(); n++) {
+    int i = traffic_slots[n];
     if (Container[i].addr && (now() - Container[i].timestamp) <= EPD_EXPIRATION_TIME) {
 
       traffic_by_dist[j].fop = &Container[i];
@@ -46,6 +46,8 @@ void Web_fini()     {}
 #include "../protocol/data/NMEA.h"
 #include "../protocol/data/GDL90.h"
 #include "../protocol/data/D1090.h"
+#include "../protocol/data/GNS5892.h"
+#include "../system/Profile.h"
 
 #if defined(ENABLE_AHRS)
 #include "../driver/AHRS.h"
@@ -1287,7 +1289,42 @@ void handleRoot() {
   char str_alt[16];
   char str_Vcc[8];
 
-  char *Root_temp = (char *) malloc(2900);
+  NMEA_Out_Stats_t out1, out2;
+  NMEA_Out_Stats(0, &out1);
+  NMEA_Out_Stats(1, &out2);
+
+  char adsb_row[256] = "";
+#if defined(ESP32)
+  if (settings->rx1090 == ADSB_RX_GNS5892) {
+    gns5892_stats_t adsb;
+    gns5892_stats(&adsb);
+    snprintf_P(adsb_row, sizeof(adsb_row),
+      PSTR("<tr><th align=left>ADS-B frames/s</th>\
+    <td align=right><table><tr>\
+     <th align=left>Used&nbsp;&nbsp;</th><td align=right>%u</td>\
+     <th align=left>&nbsp;&nbsp;Rejected&nbsp;&nbsp;</th><td align=right>%u</td>\
+     <th align=left>&nbsp;&nbsp;Dropped&nbsp;&nbsp;</th><td align=right>%u</td>\
+   </tr></table></td></tr>"),
+      adsb.accepted, adsb.rejected + adsb.bad_crc, adsb.dropped);
+  }
+#endif /* ESP32 */
+
+#if defined(USE_PROFILER)
+  /* the heading, the table rows and the closing tag */
+  char profile_rows[96 + PROFILE_HTML_SIZE + 16] = "";
+
+  strcpy_P(profile_rows, PSTR(" <hr>\
+ <h3 align=center>Time spent, last 10 seconds</h3>\
+ <table width=100%>"));
+  size_t plen = strlen(profile_rows);
+  plen += Profile_html(profile_rows + plen, sizeof(profile_rows) - plen - 10);
+  strcpy_P(profile_rows + plen, PSTR(" </table>"));
+#else
+  char profile_rows[1] = "";
+#endif /* USE_PROFILER */
+
+  size_t root_size = 3700 + strlen(profile_rows);
+  char *Root_temp = (char *) malloc(root_size);
   if (Root_temp == NULL) {
     Serial.println(F(">>> not enough RAM"));
     return;
@@ -1298,7 +1335,7 @@ void handleRoot() {
   dtostrf(ThisAircraft.altitude,  7, 1, str_alt);
   dtostrf(vdd, 4, 2, str_Vcc);
 
-  snprintf_P ( Root_temp, 3000,
+  snprintf_P ( Root_temp, root_size,
     PSTR("<html>\
   <head>\
     <meta name='viewport' content='width=device-width, initial-scale=1'>\
@@ -1337,7 +1374,14 @@ void handleRoot() {
      <th align=left>Tx&nbsp;&nbsp;</th><td align=right>%u</td>\
      <th align=left>&nbsp;&nbsp;&nbsp;&nbsp;Rx&nbsp;&nbsp;</th><td align=right>%u</td>\
    </tr></table></td></tr>\
+   <tr><th align=left>NMEA bytes</th>\
+    <td align=right><table><tr>\
+     <th align=left>Sent&nbsp;&nbsp;</th><td align=right>%u</td>\
+     <th align=left>&nbsp;&nbsp;&nbsp;&nbsp;Dropped&nbsp;&nbsp;</th><td align=right>%u</td>\
+   </tr></table></td></tr>\
+   %s\
  </table>\
+ %s\
  <hr>\
  <h3 align=center>Most recent GNSS fix</h3>\
  <table width=100%%>\
@@ -1389,6 +1433,8 @@ void handleRoot() {
     hr, min % 60, sec % 60, ESP.getFreeHeap(),
     low_voltage ? "red" : "green", str_Vcc,
     tx_packets_counter, rx_packets_counter,
+    out1.sent + out2.sent, out1.dropped + out2.dropped, adsb_row,
+    profile_rows,
     timestamp, sats, str_lat, str_lon, str_alt,
     num_wav_files
   );
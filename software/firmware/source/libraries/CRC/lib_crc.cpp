@@ -5,7 +5,7 @@
 #endif
 
 #if defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
-    defined(ARDUINO_ARCH_STM32)
+    defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_AVR)
 #include <avr/pgmspace.h>
 #endif
 
@@ -74,6 +74,7 @@
 #define                 P_DNP       0xA6BC
 #define                 P_KERMIT    0x8408
 #define                 P_SICK      0x8005
+#define                 P_MODES     0xFFF409L
 
 
 
@@ -96,7 +97,6 @@
 
 static int              crc_tab16_init          = FALSE;
 static int              crc_tab32_init          = FALSE;
-static int              crc_tabccitt_init       = FALSE;
 static int              crc_tabdnp_init         = FALSE;
 static int              crc_tabkermit_init      = FALSE;
 
@@ -107,45 +107,94 @@ static unsigned short   crc_tabdnp[256];
 static unsigned short   crc_tabkermit[256];
 #endif
 
-#if !defined(ESP8266) && !defined(__ASR6501__) && \
-    !defined(ENERGIA_ARCH_CC13XX) && !defined(ENERGIA_ARCH_CC13X2) && \
-    !defined(ARDUINO_ARCH_STM32)
-static unsigned short   crc_tabccitt[256];
+    /*******************************************************************\
+    *                                                                   *
+    *   static const unsigned short crc_tabccitt[4][256]                *
+    *                                                                   *
+    *   The CRC-CCITT tables are generated by the compiler and  live    *
+    *   in flash, so there is no RAM copy and no first-call set-up.     *
+    *   crc_tabccitt[0] is the usual byte table; crc_tabccitt[k] is     *
+    *   the same byte followed by k zero bytes.  The extra tables       *
+    *   let crc_ccitt_block() consume four bytes per step.              *
+    *                                                                   *
+    \*******************************************************************/
+
+static constexpr unsigned short crcccitt_shift( unsigned short crc, int bits ) {
+
+    return bits == 0 ? crc :
+           crcccitt_shift( (unsigned short) ( (crc & 0x8000) ? (crc << 1) ^ P_CCITT
+                                                             : (crc << 1) ), bits - 1 );
+}
+
+#define CCITT_1(k, i)   crcccitt_shift( (unsigned short) ((i) << 8), 8 * ((k) + 1) )
+#define CCITT_4(k, i)   CCITT_1(k, i),       CCITT_1(k, i + 1),   \
+                        CCITT_1(k, i + 2),   CCITT_1(k, i + 3)
+#define CCITT_16(k, i)  CCITT_4(k, i),       CCITT_4(k, i + 4),   \
+                        CCITT_4(k, i + 8),   CCITT_4(k, i + 12)
+#define CCITT_64(k, i)  CCITT_16(k, i),      CCITT_16(k, i + 16), \
+                        CCITT_16(k, i + 32), CCITT_16(k, i + 48)
+#define CCITT_256(k)    CCITT_64(k, 0),      CCITT_64(k, 64),     \
+                        CCITT_64(k, 128),    CCITT_64(k, 192)
+
+static const unsigned short crc_tabccitt[4][256]
+#if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_AVR)
+ PROGMEM
+#endif
+= {
+    { CCITT_256(0) }, { CCITT_256(1) }, { CCITT_256(2) }, { CCITT_256(3) }
+};
+
+#if defined(ESP8266) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_AVR)
+#define CCITT_TAB(k, i) pgm_read_word(&crc_tabccitt[k][i])
 #else
-static const unsigned short crc_tabccitt[256] PROGMEM = {
-    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
-    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
-    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
-    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
-    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
-    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
-    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
-    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
-    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
-    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
-    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
-    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
-    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
-    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
-    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
-    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
-    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
-    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
-    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
-    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
-    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
-    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
-    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
-    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
-    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
-    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
-    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
-    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
-    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
-    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
-    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
-    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+#define CCITT_TAB(k, i) crc_tabccitt[k][i]
+#endif
+
+    /*******************************************************************\
+    *                                                                   *
+    *   static const unsigned long crc_tabmodes[4][256]                 *
+    *                                                                   *
+    *   The same for the 24 bit Mode S parity of 1090 MHz squitters.    *
+    *                                                                   *
+    \*******************************************************************/
+
+static constexpr unsigned long crcmodes_shift( unsigned long crc, int bits ) {
+
+    return bits == 0 ? crc :
+           crcmodes_shift( (crc & 0x800000L) ? ((crc << 1) ^ P_MODES) & 0xFFFFFFL
+                                             :  (crc << 1)            & 0xFFFFFFL, bits - 1 );
+}
+
+#define MODES_1(k, i)   crcmodes_shift( (unsigned long) (i) << 16, 8 * ((k) + 1) )
+#define MODES_4(k, i)   MODES_1(k, i),       MODES_1(k, i + 1),   \
+                        MODES_1(k, i + 2),   MODES_1(k, i + 3)
+#define MODES_16(k, i)  MODES_4(k, i),       MODES_4(k, i + 4),   \
+                        MODES_4(k, i + 8),   MODES_4(k, i + 12)
+#define MODES_64(k, i)  MODES_16(k, i),      MODES_16(k, i + 16), \
+                        MODES_16(k, i + 32), MODES_16(k, i + 48)
+#define MODES_256(k)    MODES_64(k, 0),      MODES_64(k, 64),     \
+                        MODES_64(k, 128),    MODES_64(k, 192)
+
+static const unsigned long crc_tabmodes[4][256]
+#if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_AVR)
+ PROGMEM
+#endif
+= {
+    { MODES_256(0) }, { MODES_256(1) }, { MODES_256(2) }, { MODES_256(3) }
 };
+
+#if defined(ESP8266) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_AVR)
+#define MODES_TAB(k, i) pgm_read_dword(&crc_tabmodes[k][i])
+#else
+#define MODES_TAB(k, i) crc_tabmodes[k][i]
 #endif
 
 
@@ -160,7 +209,6 @@ static const unsigned short crc_tabccitt[256] PROGMEM = {
 
 static void             init_crc16_tab( void );
 static void             init_crc32_tab( void );
-static void             init_crcccitt_tab( void );
 static void             init_crcdnp_tab( void );
 static void             init_crckermit_tab( void );
 
@@ -182,16 +230,8 @@ unsigned short update_crc_ccitt( unsigned short crc, char c ) {
 
     short_c  = 0x00ff & (unsigned short) c;
 
-    if ( ! crc_tabccitt_init ) init_crcccitt_tab();
-
     tmp = (crc >> 8) ^ short_c;
-#if defined(ESP8266) || defined(__ASR6501__) || \
-    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
-    defined(ARDUINO_ARCH_STM32)
-    crc = (crc << 8) ^ pgm_read_word(&crc_tabccitt[tmp]);
-#else
-    crc = (crc << 8) ^ crc_tabccitt[tmp];
-#endif
+    crc = (crc << 8) ^ CCITT_TAB(0, tmp);
 
     return crc;
 
@@ -199,6 +239,73 @@ unsigned short update_crc_ccitt( unsigned short crc, char c ) {
 
 
 
+    /*******************************************************************\
+    *                                                                   *
+    *   unsigned short crc_ccitt_block( unsigned short crc,             *
+    *                       const unsigned char *buf, unsigned len );   *
+    *                                                                   *
+    *   The function crc_ccitt_block continues a CRC-CCITT over  len    *
+    *   bytes of buf.  It gives the same result as update_crc_ccitt     *
+    *   called for every byte, but works four bytes per step.           *
+    *                                                                   *
+    \*******************************************************************/
+
+unsigned short crc_ccitt_block( unsigned short crc, const unsigned char *buf, unsigned int len ) {
+
+    while ( len >= 4 ) {
+
+        crc ^= (unsigned short) ((buf[0] << 8) | buf[1]);
+        crc  = CCITT_TAB(3, crc >> 8)   ^ CCITT_TAB(2, crc & 0xFF) ^
+               CCITT_TAB(1, buf[2])     ^ CCITT_TAB(0, buf[3]);
+
+        buf += 4;
+        len -= 4;
+    }
+
+    while ( len-- ) crc = (crc << 8) ^ CCITT_TAB(0, (crc >> 8) ^ *buf++);
+
+    return crc;
+
+}  /* crc_ccitt_block */
+
+
+
+    /*******************************************************************\
+    *                                                                   *
+    *   unsigned long crc_modes_block( unsigned long crc,               *
+    *                       const unsigned char *buf, unsigned len );   *
+    *                                                                   *
+    *   The function crc_modes_block continues the 24 bit Mode S        *
+    *   parity  over  len bytes of buf, four bytes per step.  Start     *
+    *   with 0; for DF17/18 the result over the first 11 bytes of a     *
+    *   squitter must equal its last three (PI) bytes.                  *
+    *                                                                   *
+    \*******************************************************************/
+
+unsigned long crc_modes_block( unsigned long crc, const unsigned char *buf, unsigned int len ) {
+
+    while ( len >= 4 ) {
+
+        unsigned long w = ( (crc << 8) ^ ( ((unsigned long) buf[0] << 24) |
+                                           ((unsigned long) buf[1] << 16) |
+                                           ((unsigned long) buf[2] <<  8) |
+                                                            buf[3] ) ) & 0xFFFFFFFFL;
+
+        crc = MODES_TAB(3, w >> 24)          ^ MODES_TAB(2, (w >> 16) & 0xFF) ^
+              MODES_TAB(1, (w >> 8) & 0xFF)  ^ MODES_TAB(0, w & 0xFF);
+
+        buf += 4;
+        len -= 4;
+    }
+
+    while ( len-- ) crc = ((crc << 8) & 0xFFFFFFL) ^ MODES_TAB(0, ((crc >> 16) ^ *buf++) & 0xFF);
+
+    return crc;
+
+}  /* crc_modes_block */
+
+
+
     /*******************************************************************\
     *                                                                   *
     *   unsigned short update_crc_sick(                                 *
@@ -478,60 +585,14 @@ static void init_crc32_tab( void ) {
 #endif
 
 
-    /*******************************************************************\
-    *                                                                   *
-    *   static void init_crcccitt_tab( void );                          *
-    *                                                                   *
-    *   The function init_crcccitt_tab() is used to fill the  array     *
-    *   for calculation of the CRC-CCITT with values.                   *
-    *                                                                   *
-    \*******************************************************************/
-
-static void init_crcccitt_tab( void ) {
-
-#if !defined(ESP8266) && !defined(__ASR6501__) && \
-    !defined(ENERGIA_ARCH_CC13XX) && !defined(ENERGIA_ARCH_CC13X2) && \
-    !defined(ARDUINO_ARCH_STM32)
-    int i, j;
-    unsigned short crc, c;
-
-    for (i=0; i<256; i++) {
-
-        crc = 0;
-        c   = ((unsigned short) i) << 8;
-
-        for (j=0; j<8; j++) {
-
-            if ( (crc ^ c) & 0x8000 ) crc = ( crc << 1 ) ^ P_CCITT;
-            else                      crc =   crc << 1;
-
-            c = c << 1;
-        }
-
-        crc_tabccitt[i] = crc;
-    }
-#endif
-
-    crc_tabccitt_init = TRUE;
-
-}  /* init_crcccitt_tab */
-
 unsigned short update_crc_gdl90( unsigned short crc, char c ) {
 
     unsigned short tmp, short_c;
 
     short_c  = 0x00ff & (unsigned short) c;
 
-    if ( ! crc_tabccitt_init ) init_crcccitt_tab();
-
     tmp = (crc >> 8) ;
-#if defined(ESP8266) || defined(__ASR6501__) || \
-    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
-    defined(ARDUINO_ARCH_STM32)
-    crc = pgm_read_word(&crc_tabccitt[tmp]) ^ (crc << 8) ^  short_c;
-#else
-    crc = crc_tabccitt[tmp] ^ (crc << 8) ^  short_c;
-#endif
+    crc = CCITT_TAB(0, tmp) ^ (crc << 8) ^  short_c;
 
     return crc;
 
@@ -65,5 +65,7 @@ unsigned short          update_crc_dnp(    unsigned short crc, char c
 unsigned short          update_crc_kermit( unsigned short crc, char c                 );
 unsigned short          update_crc_sick(   unsigned short crc, char c, char prev_byte );
 unsigned short          update_crc_gdl90(  unsigned short crc, char c                 );
+unsigned short          crc_ccitt_block(   unsigned short crc, const unsigned char *buf, unsigned int len );
+unsigned long           crc_modes_block(   unsigned long  crc, const unsigned char *buf, unsigned int len );
 
 void                    update_crc8(       unsigned char *crc, unsigned char m        );
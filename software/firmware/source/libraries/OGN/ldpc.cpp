@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ldpc.h"
 
@@ -694,15 +695,15 @@ static void LDPC_Encode(const uint32_t *Data, uint32_t *Parity, uint8_t DataWord
   uint8_t ParIdx=0; Parity[ParIdx]=0; uint32_t Mask=1;
   const uint32_t *Gen=ParityGen;
   for(uint8_t Row=0; Row<Checks; Row++)
-  { uint8_t Count=0;
+  { uint32_t Sum=0;                                  // XOR the word products first: only the parity of the sum counts
     for(uint8_t Idx=0; Idx<DataWords; Idx++)
 #if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__) || \
     defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2)
-    { Count+=Count1s(Data[Idx] & (uint32_t) pgm_read_dword(Gen+Idx)); }
+    { Sum^=Data[Idx] & (uint32_t) pgm_read_dword(Gen+Idx); }
 #else
-    { Count+=Count1s(Data[Idx]&Gen[Idx]); }
+    { Sum^=Data[Idx]&Gen[Idx]; }
 #endif
-    if(Count&1) Parity[ParIdx]|=Mask; Mask<<=1;
+    if(Count1s(Sum)&1) Parity[ParIdx]|=Mask; Mask<<=1;
     if(Mask==0) { ParIdx++; Parity[ParIdx]=0; Mask=1; }
     Gen+=DataWords; }
   // printf(" => %08X %08X\n", Parity[0], Parity[1] );
@@ -732,20 +733,35 @@ uint8_t LDPC_Check(const uint32_t *Data, const uint32_t *Parity) // Data and Par
 
 uint8_t LDPC_Check(const uint32_t *Data) { return LDPC_Check(Data, Data+5); }
 
+// re-encode the 160 data bits word-wise and compare with the received parity
+// - return number of parity bits that disagree, 0 for a valid codeword
 uint8_t LDPC_Check(const uint8_t *Data) // 20 data bytes followed by 6 parity bytes
-{ uint8_t Errors=0;
-  for(uint8_t Row=0; Row<48; Row++)
-  { uint8_t Count=0;
-    const uint8_t *Check = (uint8_t *)LDPC_ParityCheck_n208k160[Row];
-    for(uint8_t Idx=0; Idx<26; Idx++)
-#if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__) || \
-    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2)
-    { uint8_t And = Data[Idx]&pgm_read_byte(Check+Idx); Count+=Count1s(And); }
-#else
-    { uint8_t And = Data[Idx]&Check[Idx]; Count+=Count1s(And); }
-#endif
-    if(Count&1) Errors++; }
-  return Errors; }
+{ uint32_t Word[7]; Word[6]=0;
+  memcpy(Word, Data, 26);                            // the frame may sit at any byte offset
+  uint32_t Parity[2];
+  LDPC_Encode(Word, Parity, 5, 48, (uint32_t *)LDPC_ParityGen_n208k160);
+  return Count1s(Parity[0]^Word[5]) + Count1s((Parity[1]^Word[6])&0xFFFF); }
+
+// try to correct a frame which failed LDPC_Check() with a few rounds of the min-sum decoder,
+// Err marks bits known to be unreliable (can be NULL for hard decisions only)
+// - return number of bits corrected or -1 when the checks still fail or more than MaxBits would change,
+//   then Data is left untouched
+int8_t LDPC_Repair(uint8_t *Data, uint8_t *Err, uint8_t Iterations, uint8_t MaxBits)
+{ static LDPC_Decoder Decoder;                      // 1.2KB of soft bits: keep it off the stack
+  static uint8_t NoErr[LDPC_Decoder::CodeBytes];
+  Decoder.Input(Data, Err ? Err:NoErr);
+  int8_t Fails=1;
+  for(uint8_t Iter=0; Iter<Iterations; Iter++)
+  { Fails=Decoder.ProcessChecks(); if(Fails==0) break; }
+  if(Fails) return -1;
+  uint8_t Out[LDPC_Decoder::CodeBytes];
+  Decoder.Output(Out);
+  int8_t Corrected=0;
+  for(uint8_t Idx=0; Idx<LDPC_Decoder::CodeBytes; Idx++)
+  { uint8_t Diff = Data[Idx]^Out[Idx]; Corrected+=Count1s(Diff); }
+  if(Corrected>MaxBits) return -1;
+  memcpy(Data, Out, LDPC_Decoder::CodeBytes);
+  return Corrected; }
 #ifdef WITH_PPM
 uint8_t LDPC_Check_n354k160(const uint32_t *Data, const uint32_t *Parity) // Data and Parity are 32-bit words
 { uint8_t Errors=0;
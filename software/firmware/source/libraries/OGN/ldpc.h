@@ -70,6 +70,8 @@ void LDPC_Encode_n354k160(      uint32_t *Data);
 uint8_t LDPC_Check(const uint32_t *Data, const uint32_t *Parity); // Data and Parity are 32-bit words
 uint8_t LDPC_Check(const uint32_t *Data);
 uint8_t LDPC_Check(const uint8_t  *Data);                         // 20 data bytes followed by 6 parity bytes
+const uint8_t LDPC_RepairMaxBits = 3; // more corrected bits than this are more likely a wrong codeword than a repair
+int8_t  LDPC_Repair(uint8_t *Data, uint8_t *Err=0, uint8_t Iterations=8, uint8_t MaxBits=LDPC_RepairMaxBits); // soft-decode a frame which failed LDPC_Check()
 #ifdef WITH_PPM
 uint8_t LDPC_Check_n354k160(const uint32_t *Data, const uint32_t *Parity); // Data and Parity are 32-bit words
 uint8_t LDPC_Check_n354k160(const uint32_t *Data);
@@ -0,0 +1,440 @@
+#include "IngestServer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+
+#define LISTEN_TAG	(-1)
+#define RESUME_TAG	(-2)
+
+IngestServer::IngestServer() :
+	sockfd(-1), epfd(-1), notify_fd(-1), resume_fd(-1),
+	q_head(0), q_tail(0), stalled(false),
+	n_frames(0), n_oversized(0), n_truncated(0), n_refused(0), n_stalls(0)
+{
+	for (int i = 0; i < INGEST_MAX_CLIENTS; i++)
+	{
+		conns[i].fd = -1;
+		conns[i].pending = NULL;
+	}
+}
+
+bool IngestServer::setup(int port)
+{
+	struct sockaddr_in serverAddress;
+	struct epoll_event ev;
+	int one = 1;
+
+	sockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (sockfd < 0)
+		return false;
+	setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&serverAddress, 0, sizeof(serverAddress));
+	serverAddress.sin_family = AF_INET;
+	serverAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+	serverAddress.sin_port = htons(port);
+	if (bind(sockfd, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) < 0 ||
+	    listen(sockfd, 5) < 0)
+		return false;
+
+	epfd      = epoll_create1(EPOLL_CLOEXEC);
+	notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	resume_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epfd < 0 || notify_fd < 0 || resume_fd < 0)
+		return false;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = (uint32_t) LISTEN_TAG;
+	epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev);
+	ev.data.u32 = (uint32_t) RESUME_TAG;
+	epoll_ctl(epfd, EPOLL_CTL_ADD, resume_fd, &ev);
+
+	return true;
+}
+
+bool IngestServer::start()
+{
+	return pthread_create(&thread, NULL, &Task, this) == 0;
+}
+
+void * IngestServer::Task(void *arg)
+{
+	pthread_detach(pthread_self());
+	((IngestServer *) arg)->loop();
+	return 0;
+}
+
+void IngestServer::loop()
+{
+	struct epoll_event events[INGEST_MAX_CLIENTS + 2];
+
+	while (1)
+	{
+		int n = epoll_wait(epfd, events, INGEST_MAX_CLIENTS + 2, -1);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			int32_t tag = (int32_t) events[i].data.u32;
+
+			if (tag == LISTEN_TAG)
+			{
+				accept_client();
+			}
+			else if (tag == RESUME_TAG)
+			{
+				uint64_t cnt;
+				if (read(resume_fd, &cnt, sizeof(cnt)) < 0) { /* EAGAIN */ }
+
+				/* flush parked frames first, oldest connection first */
+				bool blocked = false;
+				for (int j = 0; j < INGEST_MAX_CLIENTS && !blocked; j++)
+				{
+					Conn &c = conns[j];
+					if (c.fd < 0)
+						continue;
+					if (c.pending)
+					{
+						if (!push(c.pending))
+						{
+							blocked = true;
+							break;
+						}
+						c.pending = NULL;
+					}
+					if (!frame(c))
+						blocked = true;
+					else if (c.eof)
+						close_client(c);
+				}
+				if (!blocked)
+				{
+					stalled = false;
+					pause_clients(false);
+				}
+			}
+			else if (tag >= 0 && tag < INGEST_MAX_CLIENTS)
+			{
+				Conn &c = conns[tag];
+				if (c.fd < 0 || c.pending)
+					continue;
+				if (!read_client(c))
+					close_client(c);
+				else if (c.pending)
+					pause_clients(true);
+			}
+		}
+	}
+}
+
+void IngestServer::accept_client()
+{
+	int fd;
+
+	while ((fd = accept4(sockfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		int slot = -1;
+		for (int i = 0; i < INGEST_MAX_CLIENTS; i++)
+		{
+			if (conns[i].fd < 0)
+			{
+				slot = i;
+				break;
+			}
+		}
+		if (slot < 0)
+		{
+			close(fd);
+			n_refused++;
+			continue;
+		}
+
+		Conn &c = conns[slot];
+		c.fd = fd;
+		c.watched = false;
+		c.rx.clear();
+		c.scan = c.start = 0;
+		c.depth = 0;
+		c.in_str = c.esc = c.discard = c.eof = false;
+		c.pending = NULL;
+
+		if (!stalled)
+			watch(slot, true);
+	}
+}
+
+void IngestServer::close_client(Conn &c)
+{
+	/* a final line without the trailing newline is still a frame */
+	if (!c.eof && !c.discard && c.depth == 0 && c.start < c.rx.size())
+	{
+		c.rx.push_back('\n');
+		if (!frame(c))
+		{
+			/* hold the connection until the queue drains */
+			c.eof = true;
+			watch(&c - conns, false);
+			return;
+		}
+	}
+	if (c.depth > 0)
+		n_truncated++;
+
+	watch(&c - conns, false);
+	close(c.fd);
+	c.fd = -1;
+	delete c.pending;
+	c.pending = NULL;
+	c.rx.clear();
+	string().swap(c.rx);
+}
+
+/* returns false on EOF or error */
+bool IngestServer::read_client(Conn &c)
+{
+	char buf[INGEST_RECV_SIZE];
+
+	while (1)
+	{
+		ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+		if (n == 0)
+			return false;
+		if (n < 0)
+			return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+
+		c.rx.append(buf, n);
+		if (!frame(c))
+			return true;	/* queue full - leave the rest in the socket */
+	}
+}
+
+/*
+ * Cut complete frames out of c.rx and queue them.
+ * Returns false when a frame had to be parked because the queue is full.
+ */
+bool IngestServer::frame(Conn &c)
+{
+	size_t len = c.rx.size();
+	size_t framed = 0;		// end of the last complete frame
+	bool parked = false;
+
+	for (size_t i = c.scan; i < len; i++)
+	{
+		char ch = c.rx[i];
+		bool done = false;
+
+		if (c.depth > 0)
+		{
+			if (c.in_str)
+			{
+				if (c.esc)
+					c.esc = false;
+				else if (ch == '\\')
+					c.esc = true;
+				else if (ch == '"')
+					c.in_str = false;
+			}
+			else if (ch == '"')
+				c.in_str = true;
+			else if (ch == '{')
+				c.depth++;
+			else if (ch == '}' && --c.depth == 0)
+				done = true;
+		}
+		else if (ch == '{')
+		{
+			/* an object starts a new frame unless it follows text on the same line */
+			if (c.rx.find_first_not_of(" \t\r\n", c.start) >= i)
+				c.start = i;
+			c.depth = 1;
+		}
+		else if (ch == '\n')
+		{
+			done = true;
+		}
+
+		if (!done)
+			continue;
+
+		size_t end = i + 1;
+		string *msg = NULL;
+
+		if (c.discard)
+		{
+			n_oversized++;
+			c.discard = false;
+		}
+		else
+		{
+			size_t b = c.rx.find_first_not_of(" \t\r\n", c.start);
+			if (b < end)
+			{
+				size_t e = c.rx.find_last_not_of(" \t\r\n", i);
+				msg = new string(c.rx, b, e + 1 - b);
+			}
+		}
+
+		framed = end;
+		c.start = end;
+
+		if (msg && !push(msg))
+		{
+			c.pending = msg;
+			parked = true;
+			break;
+		}
+	}
+
+	/* drop the framed bytes once per pass, not once per frame */
+	if (framed > 0)
+	{
+		c.rx.erase(0, framed);
+		c.start -= framed;
+	}
+	len = c.rx.size();
+	if (parked)
+	{
+		c.scan = 0;
+		return false;
+	}
+	c.scan = len;
+
+	if (len - c.start > INGEST_MAX_FRAME)
+	{
+		/* keep parsing to find the frame end, but drop its bytes */
+		c.discard = true;
+		c.rx.clear();
+		c.scan = c.start = 0;
+	}
+	else if (c.discard)
+	{
+		c.rx.clear();
+		c.scan = c.start = 0;
+	}
+
+	return true;
+}
+
+bool IngestServer::push(string *msg)
+{
+	uint32_t tail = q_tail.load(memory_order_relaxed);
+
+	if (tail - q_head.load(memory_order_acquire) >= INGEST_QUEUE_SIZE)
+	{
+		if (!stalled.exchange(true))
+			n_stalls++;
+
+		/* the consumer may have drained the queue before it saw the flag */
+		if (tail - q_head.load() >= INGEST_QUEUE_SIZE)
+			return false;
+		stalled = false;
+	}
+
+	queue[tail & (INGEST_QUEUE_SIZE - 1)] = msg;
+	q_tail.store(tail + 1, memory_order_release);
+	n_frames++;
+
+	uint64_t one = 1;
+	if (write(notify_fd, &one, sizeof(one)) < 0) { /* counter saturated */ }
+
+	return true;
+}
+
+void IngestServer::watch(int slot, bool on)
+{
+	Conn &c = conns[slot];
+
+	if (c.watched == on)
+		return;
+
+	if (on)
+	{
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.u32 = slot;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, c.fd, &ev);
+	}
+	else
+	{
+		epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, NULL);
+	}
+	c.watched = on;
+}
+
+/* paused clients are taken out of the epoll set, so a hang-up cannot spin us */
+void IngestServer::pause_clients(bool pause)
+{
+	for (int i = 0; i < INGEST_MAX_CLIENTS; i++)
+	{
+		if (conns[i].fd >= 0 && !conns[i].eof)
+			watch(i, !pause);
+	}
+}
+
+bool IngestServer::getMessage(string &msg)
+{
+	uint32_t head = q_head.load(memory_order_relaxed);
+
+	if (head == q_tail.load(memory_order_acquire))
+		return false;
+
+	string *m = queue[head & (INGEST_QUEUE_SIZE - 1)];
+	msg.swap(*m);
+	delete m;
+	q_head.store(head + 1);
+
+	if (stalled.load())
+	{
+		uint64_t one = 1;
+		if (write(resume_fd, &one, sizeof(one)) < 0) { /* already pending */ }
+	}
+
+	return true;
+}
+
+void IngestServer::clearEvent()
+{
+	uint64_t cnt;
+	if (read(notify_fd, &cnt, sizeof(cnt)) < 0) { /* nothing pending */ }
+}
+
+void IngestServer::getStats(IngestStats *stats)
+{
+	stats->frames    = n_frames;
+	stats->oversized = n_oversized;
+	stats->truncated = n_truncated;
+	stats->refused   = n_refused;
+	stats->stalls    = n_stalls;
+}
+
+void IngestServer::detach()
+{
+	for (int i = 0; i < INGEST_MAX_CLIENTS; i++)
+	{
+		if (conns[i].fd >= 0)
+		{
+			close(conns[i].fd);
+			conns[i].fd = -1;
+		}
+	}
+	if (sockfd >= 0)
+	{
+		close(sockfd);
+		sockfd = -1;
+	}
+}
@@ -0,0 +1,93 @@
+#ifndef INGEST_SERVER_H
+#define INGEST_SERVER_H
+
+#include <string>
+#include <atomic>
+#include <stdint.h>
+#include <pthread.h>
+
+using namespace std;
+
+/*
+ * Multi-client TCP ingest server.
+ *
+ * One thread runs an epoll loop over the listening socket and all
+ * clients. Every connection is split into frames: a balanced JSON
+ * object ({...}, possibly spanning several lines) or a single text
+ * line. Complete frames are handed to one consumer thread through a
+ * bounded lock-free queue. When the queue is full the server stops
+ * reading from the clients, so TCP flow control throttles the
+ * senders instead of frames being lost.
+ */
+
+#define INGEST_MAX_CLIENTS	16
+#define INGEST_QUEUE_SIZE	64		// power of two
+#define INGEST_MAX_FRAME	(512 * 1024)
+#define INGEST_RECV_SIZE	16384
+
+struct IngestStats
+{
+	uint32_t frames;		// queued for the consumer
+	uint32_t oversized;		// longer than INGEST_MAX_FRAME, discarded
+	uint32_t truncated;		// incomplete frame at disconnect
+	uint32_t refused;		// connections over INGEST_MAX_CLIENTS
+	uint32_t stalls;		// times the queue was full
+};
+
+class IngestServer
+{
+	public:
+	IngestServer();
+
+	bool setup(int port);
+	bool start();
+	void detach();
+
+	// consumer side, never blocks
+	bool getMessage(string &msg);
+	int  eventFd() { return notify_fd; }
+	void clearEvent();
+	void getStats(IngestStats *stats);
+
+	private:
+	struct Conn
+	{
+		int    fd;
+		bool   watched;		// registered with epoll
+		string rx;			// received, not yet framed
+		size_t scan;		// parser position in rx
+		size_t start;		// start of the current frame in rx
+		int    depth;		// JSON object nesting
+		bool   in_str;
+		bool   esc;
+		bool   discard;		// current frame is oversized
+		bool   eof;			// peer closed, last frame still parked
+		string *pending;	// complete frame waiting for queue space
+	};
+
+	int sockfd;
+	int epfd;
+	int notify_fd;			// signalled on every queued frame
+	int resume_fd;			// signalled when the queue drains
+	pthread_t thread;
+	Conn conns[INGEST_MAX_CLIENTS];
+
+	string *queue[INGEST_QUEUE_SIZE];
+	atomic<uint32_t> q_head;	// written by the consumer
+	atomic<uint32_t> q_tail;	// written by the server thread
+	atomic<bool> stalled;
+
+	atomic<uint32_t> n_frames, n_oversized, n_truncated, n_refused, n_stalls;
+
+	static void * Task(void * argv);
+	void loop();
+	void accept_client();
+	void close_client(Conn &c);
+	bool read_client(Conn &c);
+	bool frame(Conn &c);
+	bool push(string *msg);
+	void watch(int slot, bool on);
+	void pause_clients(bool pause);
+};
+
+#endif
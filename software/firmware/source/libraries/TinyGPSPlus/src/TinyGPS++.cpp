@@ -97,6 +97,49 @@ bool TinyGPSPlus::encode(char c)
   return false;
 }
 
+static void setRawDegrees(RawDegrees &deg, int32_t e7)
+{
+  uint32_t v = e7 < 0 ? -(uint32_t)e7 : (uint32_t)e7;
+  deg.deg = v / 10000000UL;
+  deg.billionths = (v % 10000000UL) * 100;
+  deg.negative = e7 < 0;
+}
+
+void TinyGPSPlus::commit(const TinyGPSFix &fix)
+{
+  if (fix.dateValid)
+  {
+    date.newDate = fix.date;
+    date.commit();
+  }
+  if (fix.timeValid)
+  {
+    time.newTime = fix.time;
+    time.commit();
+  }
+  if (fix.hasFix)
+  {
+    ++sentencesWithFixCount;
+    setRawDegrees(location.rawNewLatData, fix.lat);
+    setRawDegrees(location.rawNewLngData, fix.lng);
+    location.newFixQuality = fix.quality;
+    location.newFixMode = A;
+    location.commit();
+    altitude.newval = fix.altitude;
+    altitude.commit();
+    separation.newval = fix.separation;
+    separation.commit();
+    speed.newval = fix.speed;
+    speed.commit();
+    course.newval = fix.course;
+    course.commit();
+  }
+  satellites.newval = fix.satellites;
+  satellites.commit();
+  hdop.newval = fix.hdop;
+  hdop.commit();
+}
+
 //
 // internal utilities
 //
@@ -208,6 +208,23 @@ struct TinyGPSHDOP : TinyGPSDecimal
    double hdop() { return value() / 100.0; }
 };
 
+// A fix decoded from a binary protocol (e.g. UBX-NAV-PVT),
+// in the units TinyGPS++ keeps
+struct TinyGPSFix
+{
+   int32_t lat, lng;       // 1e-7 degrees
+   uint32_t date;          // DDMMYY
+   uint32_t time;          // HHMMSSCC
+   int32_t altitude;       // cm above MSL
+   int32_t separation;     // cm, geoid above the ellipsoid
+   int32_t speed;          // 1/100 knot
+   int32_t course;         // 1/100 degree
+   int32_t hdop;           // 1/100
+   uint32_t satellites;
+   FixQuality quality;
+   bool dateValid, timeValid, hasFix;
+};
+
 class TinyGPSPlus;
 class TinyGPSCustom
 {
@@ -241,6 +258,7 @@ public:
   TinyGPSPlus();
   bool encode(char c); // process one character received from GPS
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
+  void commit(const TinyGPSFix &fix); // as if from a GGA and an RMC sentence
 
   TinyGPSLocation location;
   TinyGPSDate date;
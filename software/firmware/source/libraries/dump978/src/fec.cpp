@@ -25,6 +25,15 @@
 #include "uat.h"
 #include "fec/rs.h"
 
+#if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__)
+#include <pgmspace.h>
+#endif
+
+#if defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32)
+#include <avr/pgmspace.h>
+#endif
+
 static void *rs_uplink;
 static void *rs_adsb_short;
 static void *rs_adsb_long;
@@ -32,6 +41,79 @@ static void *rs_adsb_long;
 #define UPLINK_POLY 0x187
 #define ADSB_POLY 0x187
 
+#define ADSB_SHORT_ROOTS 12
+#define ADSB_LONG_ROOTS 14
+#define UPLINK_ROOTS 20
+
+#if !defined(ESP8266) && !defined(ENERGIA_ARCH_CC13XX) && !defined(ENERGIA_ARCH_CC13X2) && \
+    !defined(__ASR6501__) && !defined(ARDUINO_ARCH_STM32)
+#define SYNDROME_ROOTS UPLINK_ROOTS
+#else
+#define SYNDROME_ROOTS ADSB_LONG_ROOTS
+#endif
+
+// All three codes share the field (poly 0x187) and the roots alpha^(120+i),
+// so one set of tables serves them all: syndrome_tab[i][x] is x * alpha^(120+i).
+// They are built by the compiler and live in flash.
+
+static constexpr uint8_t gf_times_alpha(uint8_t x, int n)
+{
+    return n == 0 ? x :
+           gf_times_alpha((uint8_t) ((x & 0x80) ? (x << 1) ^ ADSB_POLY : (x << 1)), n - 1);
+}
+
+#define SYN_1(k, x)     gf_times_alpha((x), 120 + (k))
+#define SYN_4(k, x)     SYN_1(k, x),       SYN_1(k, x + 1),   SYN_1(k, x + 2),    SYN_1(k, x + 3)
+#define SYN_16(k, x)    SYN_4(k, x),       SYN_4(k, x + 4),   SYN_4(k, x + 8),    SYN_4(k, x + 12)
+#define SYN_64(k, x)    SYN_16(k, x),      SYN_16(k, x + 16), SYN_16(k, x + 32),  SYN_16(k, x + 48)
+#define SYN_256(k)    { SYN_64(k, 0),      SYN_64(k, 64),     SYN_64(k, 128),     SYN_64(k, 192) }
+
+static const uint8_t syndrome_tab[SYNDROME_ROOTS][256]
+#if defined(ESP8266) || defined(ESP32) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32)
+PROGMEM
+#endif
+= {
+    SYN_256(0),  SYN_256(1),  SYN_256(2),  SYN_256(3),  SYN_256(4),  SYN_256(5),  SYN_256(6),
+    SYN_256(7),  SYN_256(8),  SYN_256(9),  SYN_256(10), SYN_256(11), SYN_256(12), SYN_256(13),
+#if SYNDROME_ROOTS > ADSB_LONG_ROOTS
+    SYN_256(14), SYN_256(15), SYN_256(16), SYN_256(17), SYN_256(18), SYN_256(19),
+#endif
+};
+
+#if defined(ESP8266) || defined(__ASR6501__) || \
+    defined(ENERGIA_ARCH_CC13XX) || defined(ENERGIA_ARCH_CC13X2) || \
+    defined(ARDUINO_ARCH_STM32)
+#define SYNDROME_TAB(i, x)  pgm_read_byte(&syndrome_tab[i][x])
+#else
+#define SYNDROME_TAB(i, x)  syndrome_tab[i][x]
+#endif
+
+// True if all 'nroots' syndromes of the len-byte block are zero, i.e. it is
+// a valid codeword and decode_rs_char() would find nothing to correct.
+// Same Horner evaluation as decode_rs_char(), but a constant multiply is one
+// table lookup instead of a log/antilog round trip.
+static bool syndrome_is_zero(const uint8_t *data, int len, int nroots)
+{
+    uint8_t s[SYNDROME_ROOTS];
+    uint8_t any = 0;
+    int i, j;
+
+    for (i = 0; i < nroots; ++i)
+        s[i] = data[0];
+
+    for (j = 1; j < len; ++j) {
+        uint8_t d = data[j];
+        for (i = 0; i < nroots; ++i)
+            s[i] = SYNDROME_TAB(i, s[i]) ^ d;
+    }
+
+    for (i = 0; i < nroots; ++i)
+        any |= s[i];
+    return any == 0;
+}
+
 void init_fec(void)
 {
     rs_adsb_short = init_rs_char(8, /* gfpoly */ ADSB_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 12, /* pad */ 225);
@@ -42,55 +124,75 @@ void init_fec(void)
 #endif
 }
 
+static int correct_adsb_as(uint8_t *to, bool is_long, int *rs_errors)
+{
+    int n_corrected;
+
+    if (is_long) {
+        n_corrected = syndrome_is_zero(to, LONG_FRAME_BYTES, ADSB_LONG_ROOTS) ? 0 :
+                      decode_rs_char(rs_adsb_long, to, NULL, 0);
+        if (n_corrected < 0 || n_corrected > 7 || (to[0]>>3) == 0)
+            return -1;
+    } else {
+        n_corrected = syndrome_is_zero(to, SHORT_FRAME_BYTES, ADSB_SHORT_ROOTS) ? 0 :
+                      decode_rs_char(rs_adsb_short, to, NULL, 0);
+        if (n_corrected < 0 || n_corrected > 6 || (to[0]>>3) != 0)
+            return -1;
+    }
+
+    *rs_errors = n_corrected;
+    return is_long ? 2 : 1;
+}
+
 int correct_adsb_frame(uint8_t *to, int *rs_errors)
 {
-    // Try decoding as a Long UAT.
+    // The payload type code is 0 in Basic UAT frames only, so unless the
+    // header itself was hit, it tells which code to try first.
     // We rely on decode_rs_char not modifying the data if there were
     // uncorrectable errors.
-    int n_corrected = decode_rs_char(rs_adsb_long, to, NULL, 0);
-    if (n_corrected >= 0 && n_corrected <= 7 && (to[0]>>3) != 0) {
-        // Valid long frame.
-        *rs_errors = n_corrected;
-        return 2;
-    }
+    bool is_long = (to[0]>>3) != 0;
+    int frame_type = correct_adsb_as(to, is_long, rs_errors);
 
-    // Retry as Basic UAT
-    n_corrected = decode_rs_char(rs_adsb_short, to, NULL, 0);
-    if (n_corrected >= 0 && n_corrected <= 6 && (to[0]>>3) == 0) {
-        // Valid short frame
-        *rs_errors = n_corrected;
-        return 1;
-    }
+    if (frame_type < 0)
+        frame_type = correct_adsb_as(to, !is_long, rs_errors);
 
-    // Failed.
-    *rs_errors = 9999;
-    return -1;
+    if (frame_type < 0) {
+        // Failed.
+        *rs_errors = 9999;
+    }
+    return frame_type;
 }
 
 #if !defined(ESP8266) && !defined(ENERGIA_ARCH_CC13XX) && !defined(ENERGIA_ARCH_CC13X2) && \
     !defined(__ASR6501__) && !defined(ARDUINO_ARCH_STM32)
 int correct_uplink_frame(uint8_t *from, uint8_t *to, int *rs_errors)
 {
-    int block;
+    uint8_t blocks[UPLINK_FRAME_BLOCKS][UPLINK_BLOCK_BYTES];
+    int i, block;
     int total_corrected = 0;
 
-    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
-        int i, n_corrected;
-        uint8_t *blockdata = &to[block * UPLINK_BLOCK_DATA_BYTES];
+    // Deinterleave in one sequential pass: every run of UPLINK_FRAME_BLOCKS
+    // input bytes holds the next byte of each block.
+    for (i = 0; i < UPLINK_BLOCK_BYTES; ++i, from += UPLINK_FRAME_BLOCKS) {
+        for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block)
+            blocks[block][i] = from[block];
+    }
 
-        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
-            blockdata[i] = from[i * UPLINK_FRAME_BLOCKS + block];
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+        uint8_t *blockdata = blocks[block];
 
-        // error-correct in place
-        n_corrected = decode_rs_char(rs_uplink, blockdata, NULL, 0);
-        if (n_corrected < 0 || n_corrected > 10) {
-            // Failed
-            *rs_errors = 9999;
-            return -1;
+        if (!syndrome_is_zero(blockdata, UPLINK_BLOCK_BYTES, UPLINK_ROOTS)) {
+            // error-correct in place
+            int n_corrected = decode_rs_char(rs_uplink, blockdata, NULL, 0);
+            if (n_corrected < 0 || n_corrected > 10) {
+                // Failed
+                *rs_errors = 9999;
+                return -1;
+            }
+            total_corrected += n_corrected;
         }
 
-        total_corrected += n_corrected;
-        // next block (if there is one) will overwrite the ECC bytes.
+        memcpy(&to[block * UPLINK_BLOCK_DATA_BYTES], blockdata, UPLINK_BLOCK_DATA_BYTES);
     }
 
     *rs_errors = total_corrected;
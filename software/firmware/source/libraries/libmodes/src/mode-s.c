@@ -1,9 +1,20 @@
 #include "mode-s.h"
 
+// The preamble search tests 8 sample offsets at a time when the compiler
+// targets SSE2 or NEON. Build with -DMODE_S_NO_SIMD to get the plain loop.
+#if !defined(MODE_S_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define MODE_S_SSE2
+#elif !defined(MODE_S_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define MODE_S_NEON
+#endif
+
 #define MODE_S_PREAMBLE_US 8       // microseconds
 #define MODE_S_LONG_MSG_BITS 112
 #define MODE_S_SHORT_MSG_BITS 56
 #define MODE_S_FULL_LEN (MODE_S_PREAMBLE_US+MODE_S_LONG_MSG_BITS)
+#define MODE_S_BLOCK_LEN 4096      // magnitude samples per mode_s_detect_iq() pass
 
 #define MODE_S_ICAO_CACHE_TTL 60   // Time to live of cached addresses.
 
@@ -556,14 +567,100 @@ void apply_phase_correction(uint16_t *mag) {
   }
 }
 
-// Detect a Mode S messages inside the magnitude buffer pointed by 'mag' and of
-// size 'maglen' bytes. Every detected Mode S message is convert it into a
-// stream of bits and passed to the function to display it.
-void mode_s_detect(mode_s_t *self, uint16_t *mag, uint32_t maglen, mode_s_callback_t cb) {
+// First check of relations between the 10 samples representing a valid
+// preamble, see the picture in detect_range().
+static inline int preamble_shape(const uint16_t *m) {
+  return m[0] > m[1] &&
+         m[1] < m[2] &&
+         m[2] > m[3] &&
+         m[3] < m[0] &&
+         m[4] < m[0] &&
+         m[5] < m[0] &&
+         m[6] < m[0] &&
+         m[7] > m[8] &&
+         m[8] < m[9] &&
+         m[9] > m[6];
+}
+
+// Return the first offset in [j, end) that passes preamble_shape(), or 'end'
+// if there is none. With SIMD every compare covers 8 consecutive offsets, as
+// sample k of offset j+n is just mag[j+n+k]. This reads up to mag[end+15].
+static uint32_t next_preamble(const uint16_t *mag, uint32_t j, uint32_t end) {
+#if defined(MODE_S_SSE2)
+  // SSE2 only has signed 16 bit compares, so flip the sign bits first.
+  const __m128i bias = _mm_set1_epi16((short) 0x8000);
+
+  for (; j + 8 <= end; j += 8) {
+    __m128i m0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j)), bias);
+    __m128i m1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+1)), bias);
+    __m128i m2 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+2)), bias);
+    __m128i m3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+3)), bias);
+    __m128i m4 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+4)), bias);
+    __m128i m5 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+5)), bias);
+    __m128i m6 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+6)), bias);
+    __m128i m7 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+7)), bias);
+    __m128i m8 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+8)), bias);
+    __m128i m9 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (mag+j+9)), bias);
+    __m128i t;
+    int mask;
+
+    t = _mm_and_si128(_mm_cmpgt_epi16(m0, m1), _mm_cmplt_epi16(m1, m2));
+    t = _mm_and_si128(t, _mm_cmpgt_epi16(m2, m3));
+    t = _mm_and_si128(t, _mm_cmplt_epi16(m3, m0));
+    t = _mm_and_si128(t, _mm_cmplt_epi16(m4, m0));
+    t = _mm_and_si128(t, _mm_cmplt_epi16(m5, m0));
+    t = _mm_and_si128(t, _mm_cmplt_epi16(m6, m0));
+    t = _mm_and_si128(t, _mm_cmpgt_epi16(m7, m8));
+    t = _mm_and_si128(t, _mm_cmplt_epi16(m8, m9));
+    t = _mm_and_si128(t, _mm_cmpgt_epi16(m9, m6));
+
+    mask = _mm_movemask_epi8(t);   // two bits per offset
+    if (mask) return j + (__builtin_ctz(mask) >> 1);
+  }
+#elif defined(MODE_S_NEON)
+  for (; j + 8 <= end; j += 8) {
+    uint16x8_t m0 = vld1q_u16(mag+j);
+    uint16x8_t m1 = vld1q_u16(mag+j+1);
+    uint16x8_t m2 = vld1q_u16(mag+j+2);
+    uint16x8_t m3 = vld1q_u16(mag+j+3);
+    uint16x8_t m4 = vld1q_u16(mag+j+4);
+    uint16x8_t m5 = vld1q_u16(mag+j+5);
+    uint16x8_t m6 = vld1q_u16(mag+j+6);
+    uint16x8_t m7 = vld1q_u16(mag+j+7);
+    uint16x8_t m8 = vld1q_u16(mag+j+8);
+    uint16x8_t m9 = vld1q_u16(mag+j+9);
+    uint16x8_t t;
+    uint64_t mask;
+
+    t = vandq_u16(vcgtq_u16(m0, m1), vcltq_u16(m1, m2));
+    t = vandq_u16(t, vcgtq_u16(m2, m3));
+    t = vandq_u16(t, vcltq_u16(m3, m0));
+    t = vandq_u16(t, vcltq_u16(m4, m0));
+    t = vandq_u16(t, vcltq_u16(m5, m0));
+    t = vandq_u16(t, vcltq_u16(m6, m0));
+    t = vandq_u16(t, vcgtq_u16(m7, m8));
+    t = vandq_u16(t, vcltq_u16(m8, m9));
+    t = vandq_u16(t, vcgtq_u16(m9, m6));
+
+    // Narrow to one byte per offset.
+    mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(t, 4)), 0);
+    if (mask) return j + (__builtin_ctzll(mask) >> 3);
+  }
+#endif
+  for (; j < end; j++) {
+    if (preamble_shape(mag+j)) return j;
+  }
+  return end;
+}
+
+// Look for Mode S messages starting at offsets j to end-1 of 'mag'. A message
+// is read from up to MODE_S_FULL_LEN*2 samples past its offset. Returns the
+// offset to resume from, which is past 'end' if the last message overlapped
+// it.
+static uint32_t detect_range(mode_s_t *self, uint16_t *mag, uint32_t j, uint32_t end, mode_s_callback_t cb) {
   unsigned char bits[MODE_S_LONG_MSG_BITS];
   unsigned char msg[MODE_S_LONG_MSG_BITS/2];
   uint16_t aux[MODE_S_LONG_MSG_BITS*2];
-  uint32_t j;
   int use_correction = 0;
 
   // The Mode S preamble is made of impulses of 0.5 microseconds at the
@@ -588,7 +685,7 @@ void mode_s_detect(mode_s_t *self, uint16_t *mag, uint32_t maglen, mode_s_callba
   // 7   ------------------
   // 8   --
   // 9   -------------------
-  for (j = 0; j < maglen - MODE_S_FULL_LEN*2; j++) {
+  for (; j < end; j++) {
     int low, high, delta, i, errors;
     int good_message = 0;
 
@@ -597,19 +694,8 @@ void mode_s_detect(mode_s_t *self, uint16_t *mag, uint32_t maglen, mode_s_callba
     // First check of relations between the first 10 samples representing a
     // valid preamble. We don't even investigate further if this simple
     // test is not passed.
-    if (!(mag[j] > mag[j+1] &&
-        mag[j+1] < mag[j+2] &&
-        mag[j+2] > mag[j+3] &&
-        mag[j+3] < mag[j] &&
-        mag[j+4] < mag[j] &&
-        mag[j+5] < mag[j] &&
-        mag[j+6] < mag[j] &&
-        mag[j+7] > mag[j+8] &&
-        mag[j+8] < mag[j+9] &&
-        mag[j+9] > mag[j+6]))
-    {
-      continue;
-    }
+    j = next_preamble(mag, j, end);
+    if (j == end) break;
 
     // The samples between the two spikes must be < than the average of the
     // high spikes level. We don't test bits too near to the high levels as
@@ -737,4 +823,35 @@ good_preamble:
       use_correction = 0;
     }
   }
+  return j;
+}
+
+// Detect a Mode S messages inside the magnitude buffer pointed by 'mag' and of
+// size 'maglen' bytes. Every detected Mode S message is convert it into a
+// stream of bits and passed to the function to display it.
+void mode_s_detect(mode_s_t *self, uint16_t *mag, uint32_t maglen, mode_s_callback_t cb) {
+  detect_range(self, mag, 0, maglen - MODE_S_FULL_LEN*2, cb);
+}
+
+// Same as mode_s_compute_magnitude_vector() followed by mode_s_detect(), but
+// done MODE_S_BLOCK_LEN samples at a time, so the detector runs over
+// magnitudes that were just computed and are still in the cache. 'mag' must
+// have room for size/2 samples, and holds the whole vector on return.
+void mode_s_detect_iq(mode_s_t *self, unsigned char *data, uint16_t *mag, uint32_t size, mode_s_callback_t cb) {
+  uint32_t maglen = size/2;
+  uint32_t done = 0; // Magnitudes computed so far.
+  uint32_t j = 0;
+
+  if (maglen <= MODE_S_FULL_LEN*2) return;
+
+  while (j < maglen - MODE_S_FULL_LEN*2) {
+    uint32_t need = j + MODE_S_BLOCK_LEN + MODE_S_FULL_LEN*2;
+
+    if (need > maglen) need = maglen;
+    if (need > done) {
+      mode_s_compute_magnitude_vector(data+done*2, mag+done, (need-done)*2);
+      done = need;
+    }
+    j = detect_range(self, mag, j, need - MODE_S_FULL_LEN*2, cb);
+  }
 }
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <time.h>
+#include "mode-s.h"
+
+#define MODE_S_DATA_LEN (16*16384) // 256k
+#define MODE_S_PREAMBLE_US 8       // microseconds
+#define MODE_S_LONG_MSG_BITS 112
+#define MODE_S_FULL_LEN (MODE_S_PREAMBLE_US+MODE_S_LONG_MSG_BITS)
+#define MODE_S_OVERLAP ((MODE_S_FULL_LEN-1)*4)
+
+#define MODE_S_NOTUSED(V) ((void) V)
+
+unsigned char *data;  // Whole IQ file, padded with no signal.
+uint32_t data_len;    // Bytes read from the file.
+uint16_t *mag;
+uint32_t messages;    // Messages passed to the callback.
+uint32_t digest;      // FNV-1a over all of them, in order.
+
+void count(mode_s_t *self, struct mode_s_msg *mm) {
+  MODE_S_NOTUSED(self);
+  int j;
+
+  for (j = 0; j < mm->msgbits/8; j++) {
+    digest ^= mm->msg[j];
+    digest *= 16777619;
+  }
+  messages++;
+}
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Run the file through the decoder in the same 256k blocks as tests/test.c,
+// either computing the magnitude vector first (fused = 0) or with
+// mode_s_detect_iq(). Returns the elapsed time in seconds.
+double run(int fused) {
+  mode_s_t state;
+  uint32_t off;
+  double t0;
+
+  mode_s_init(&state);
+  messages = 0;
+  digest = 2166136261u;
+
+  t0 = now();
+  for (off = 0; off < data_len; off += MODE_S_DATA_LEN) {
+    unsigned char *p = data + off;
+    uint32_t len = MODE_S_DATA_LEN + MODE_S_OVERLAP;
+
+    if (fused) {
+      mode_s_detect_iq(&state, p, mag, len, count);
+    } else {
+      mode_s_compute_magnitude_vector(p, mag, len);
+      mode_s_detect(&state, mag, len/2, count);
+    }
+  }
+  return now() - t0;
+}
+
+int main(int argc, char **argv) {
+  int passes = 5;
+  int i, fused;
+  FILE *f;
+
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <IQ file> [passes]\n", argv[0]);
+    exit(1);
+  }
+  if (argc > 2) passes = atoi(argv[2]);
+
+  if ((f = fopen(argv[1], "rb")) == NULL) {
+    perror("Opening data file");
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  data_len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  if ((data = malloc(data_len + MODE_S_DATA_LEN + MODE_S_OVERLAP)) == NULL ||
+    (mag = malloc(sizeof(uint16_t) * (MODE_S_DATA_LEN + MODE_S_OVERLAP) / 2)) == NULL) {
+    fprintf(stderr, "Out of memory allocating data buffer.\n");
+    exit(1);
+  }
+  if (fread(data, 1, data_len, f) != data_len) {
+    perror("Reading data file");
+    exit(1);
+  }
+  fclose(f);
+  memset(data + data_len, 127, MODE_S_DATA_LEN + MODE_S_OVERLAP);
+
+  for (fused = 0; fused <= 1; fused++) {
+    double best = 0;
+
+    for (i = 0; i < passes; i++) {
+      double t = run(fused);
+      if (i == 0 || t < best) best = t;
+    }
+    printf("%-9s %6.1f Msamples/s %8.0f messages/s  %u messages, digest %08x\n",
+           fused ? "fused:" : "separate:",
+           data_len / 2 / best / 1e6, messages / best, messages, digest);
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+
+'''
+    Creates the aircrafts data base for ADB_find() (SoftRF src/system/ADB.h)
+    from the OGN DDB ogn.csv, as ogn.py reads it, or from the JSON lines
+    that flarm-db.pl prints:
+
+      $ ./adb.py ogn.csv ogn.adb
+      $ ./flarm-db.pl | ./adb.py -f json - fln.adb
+
+    Records are fixed size and placed by a minimal perfect hash on the
+    24-bit address, so a lookup takes one bucket seed and one record.
+'''
+
+import argparse
+import csv
+import json
+import struct
+import sys
+
+MAGIC     = b'ADB1'
+FIELD_MAX = 31
+DIRECT    = 0x80000000
+BUCKET    = 4                  # average keys per bucket
+HEADER    = '<4sBBBxIIII'
+
+def adb_hash(addr, seed):
+    h = ((addr ^ seed) * 0x9E3779B1) & 0xffffffff
+    h ^= h >> 15
+    h = (h * 0x85EBCA77) & 0xffffffff
+    h ^= h >> 13
+    return h
+
+def read_ogn(f):
+    air = {}
+    reader = csv.reader(f, delimiter = ',', quotechar = "'")
+    next(reader, None)                               # skip first row
+    for row in reader:
+        if len(row) >= 5 and row[1]:
+            air[int(row[1], 16)] = (row[2], row[3], row[4])
+    return air
+
+def read_json(f):
+    air = {}
+    for line in f:
+        line = line.strip()
+        if not line:
+            continue
+        r = json.loads(line)
+        if '_id' in r:
+            air[int(r['_id'], 16)] = (r.get('type', ''), r.get('registration', ''),
+                                      r.get('tail', ''))
+    return air
+
+def perfect_hash(addrs):
+    n = len(addrs)
+    nb = max(1, (n + BUCKET - 1) // BUCKET)
+    buckets = [[] for i in range(nb)]
+    for a in addrs:
+        buckets[adb_hash(a, 0xffffffff) % nb].append(a)
+
+    seeds = [0] * nb
+    slot_of = {}
+    used = bytearray(n)
+    order = sorted(range(nb), key = lambda b: -len(buckets[b]))
+
+    # the larger buckets first, each with the first seed that fits it
+    for b in order:
+        keys = buckets[b]
+        if len(keys) < 2:
+            break
+        seed = 0
+        while True:
+            slots = [adb_hash(a, seed) % n for a in keys]
+            if len(set(slots)) == len(keys) and not any(used[s] for s in slots):
+                break
+            seed += 1
+            if seed >= DIRECT:
+                sys.exit('no seed for bucket %d' % b)
+        seeds[b] = seed
+        for a, s in zip(keys, slots):
+            used[s] = 1
+            slot_of[a] = s
+
+    # the single ones go straight into the slots left over
+    free = (s for s in range(n) if not used[s])
+    for b in order:
+        if len(buckets[b]) == 1:
+            s = next(free)
+            seeds[b] = DIRECT | s
+            slot_of[buckets[b][0]] = s
+
+    return seeds, slot_of
+
+def field(s, width):
+    b = s.strip().encode('latin-1', 'replace')[:width]
+    return b + b'\0' * (width - len(b))
+
+def adb_make(air, out):
+    addrs = sorted(a & 0xffffff for a in air)
+    widths = [min(FIELD_MAX, max([len(v[i].strip().encode('latin-1', 'replace'))
+                                  for v in air.values()] + [1])) for i in range(3)]
+    seeds, slot_of = perfect_hash(addrs)
+
+    n = len(addrs)
+    rec_size = 3 + sum(widths)
+    records = bytearray(n * rec_size)
+    for a, v in air.items():
+        a &= 0xffffff
+        p = slot_of[a] * rec_size
+        records[p:p + rec_size] = struct.pack('<I', a)[:3] + \
+            b''.join(field(v[i], widths[i]) for i in range(3))
+
+    pos_seeds = struct.calcsize(HEADER)
+    pos_data = pos_seeds + 4 * len(seeds)
+    out.write(struct.pack(HEADER, MAGIC, widths[0], widths[1], widths[2],
+                          n, len(seeds), pos_seeds, pos_data))
+    out.write(struct.pack('<%dI' % len(seeds), *seeds))
+    out.write(records)
+    return n, widths
+
+if __name__ == "__main__":
+    ap = argparse.ArgumentParser(description = 'make an aircrafts data base file')
+    ap.add_argument('-f', '--format', choices = ['ogn', 'json'], default = 'ogn')
+    ap.add_argument('input', help = 'ogn.csv, or JSON lines of flarm-db.pl, "-" for stdin')
+    ap.add_argument('output')
+    args = ap.parse_args()
+
+    f = sys.stdin if args.input == '-' else open(args.input, encoding = 'latin-1')
+    air = read_ogn(f) if args.format == 'ogn' else read_json(f)
+    if not air:
+        sys.exit('no aircrafts in ' + args.input)
+
+    with open(args.output, 'wb') as out:
+        n, widths = adb_make(air, out)
+    print('%d aircrafts, type/reg/cn %d/%d/%d bytes' % (n, widths[0], widths[1], widths[2]))